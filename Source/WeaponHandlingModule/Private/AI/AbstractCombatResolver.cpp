@@ -0,0 +1,76 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/AbstractCombatResolver.h"
+
+#include "AIController.h"
+#include "HAL/PlatformTime.h"
+#include "Perception/AIPerceptionComponent.h"
+#include "Perception/AISense_Sight.h"
+
+static TAutoConsoleVariable<bool> CVarAbstractCombat(
+	TEXT("weapon.AI.AbstractCombat"),
+	true,
+	TEXT("Resolve AI shots no player can see or hear statistically instead of tracing them."));
+
+static TAutoConsoleVariable<float> CVarAbstractCoverHitScale(
+	TEXT("weapon.AI.AbstractCoverHitScale"),
+	0.2f,
+	TEXT("Hit chance multiplier for statistically resolved shots against targets in cover."));
+
+
+FAbstractCombatResolver::FAbstractCombatResolver() : Random(FPlatformTime::Cycles()) {}
+
+
+bool FAbstractCombatResolver::IsEnabled() {
+	return CVarAbstractCombat.GetValueOnGameThread();
+}
+
+
+/**
+ * Uses the last sight stimulus the shooter received for the target.
+ *
+ * @note Reuses the line of sight tests perception already amortizes
+ */
+bool FAbstractCombatResolver::IsTargetInCover(const AAIController* Shooter, const AActor* Target) {
+	const UAIPerceptionComponent* PerceptionComponent = Shooter->GetPerceptionComponent();
+	if (!PerceptionComponent || !Target) {
+		return false;
+	}
+
+	const FAISenseID SightSenseID = UAISense::GetSenseID<UAISense_Sight>();
+	if (!PerceptionComponent->GetSenseConfig(SightSenseID)) {
+		return false;
+	}
+
+	const FActorPerceptionInfo* PerceptionInfo = PerceptionComponent->GetActorInfo(*Target);
+	if (!PerceptionInfo || !PerceptionInfo->LastSensedStimuli.IsValidIndex(SightSenseID)) {
+		return true;
+	}
+
+	const FAIStimulus& SightStimulus = PerceptionInfo->LastSensedStimuli[SightSenseID];
+	return !SightStimulus.WasSuccessfullySensed() || SightStimulus.IsExpired();
+}
+
+
+/**
+ * Falls off quadratically with distance so close range fights stay lethal.
+ */
+float FAbstractCombatResolver::GetHitChance(float Accuracy, float Distance, float WeaponRange, bool bTargetInCover) const {
+	if (WeaponRange <= 0.0f || Distance >= WeaponRange) {
+		return 0.0f;
+	}
+
+	const float RangeFactor = 1.0f - FMath::Square(Distance / WeaponRange);
+	const float CoverFactor = bTargetInCover ? CVarAbstractCoverHitScale.GetValueOnGameThread() : 1.0f;
+	return FMath::Clamp(Accuracy * RangeFactor * CoverFactor, 0.0f, 1.0f);
+}
+
+
+bool FAbstractCombatResolver::RollHit(float HitChance) {
+	return Random.GetFraction() < HitChance;
+}
+
+
+void FAbstractCombatResolver::Reset() {
+	Random.Initialize(FPlatformTime::Cycles());
+}
@@ -0,0 +1,196 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/GunfireStimulusAggregator.h"
+
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "Perception/AIPerceptionComponent.h"
+#include "Perception/AIPerceptionSystem.h"
+#include "Perception/AISenseConfig_Hearing.h"
+#include "Perception/AISense_Hearing.h"
+
+static TAutoConsoleVariable<float> CVarGunfireStimulusInterval(
+	TEXT("weapon.AI.GunfireStimulusInterval"),
+	0.25f,
+	TEXT("Seconds over which shots from one shooter are merged into a single hearing stimulus."));
+
+static TAutoConsoleVariable<float> CVarGunfireListenerCellSize(
+	TEXT("weapon.AI.GunfireListenerCellSize"),
+	2000.0f,
+	TEXT("Cell size of the grid used to find AI listeners in hearing range of gunfire (cm)."));
+
+const FName FGunfireStimulusAggregator::GunfireStimulusTag(TEXT("Gunfire"));
+
+
+/**
+ * Reads the shot count carried as the strength of an aggregated gunfire stimulus.
+ */
+int32 FGunfireStimulusAggregator::GetShotCount(const FAIStimulus& Stimulus) {
+	if (Stimulus.Tag != GunfireStimulusTag) {
+		return 0;
+	}
+	return FMath::RoundToInt32(Stimulus.Strength);
+}
+
+
+/**
+ * Merges a shot into its shooter's pending stimulus.
+ *
+ * @note The latest location wins so moving shooters are heard where they last fired
+ */
+void FGunfireStimulusAggregator::ReportShot(AActor* Shooter, const FVector& Location, float Loudness, float MaxRange) {
+	if (!Shooter) {
+		return;
+	}
+
+	const int32* ExistingIndex = PendingGunfireIndices.Find(Shooter);
+	FPendingGunfire& Gunfire = ExistingIndex ? PendingGunfire[*ExistingIndex] : PendingGunfire.AddDefaulted_GetRef();
+	if (!ExistingIndex) {
+		Gunfire.Shooter = Shooter;
+		PendingGunfireIndices.Add(Shooter, PendingGunfire.Num() - 1);
+	}
+
+	Gunfire.Location = Location;
+	Gunfire.PeakLoudness = FMath::Max(Gunfire.PeakLoudness, Loudness);
+	Gunfire.MaxRange = FMath::Max(Gunfire.MaxRange, MaxRange);
+	++Gunfire.ShotCount;
+}
+
+
+/**
+ * Delivers all gunfire accumulated during the last perception interval.
+ *
+ * @note The listener grid is only rebuilt when there is gunfire to deliver
+ */
+void FGunfireStimulusAggregator::Tick(UWorld* World) {
+	const double CurrentTime = World->GetTimeSeconds();
+	if (CurrentTime < NextFlushTime) {
+		return;
+	}
+	NextFlushTime = CurrentTime + CVarGunfireStimulusInterval.GetValueOnGameThread();
+
+	if (PendingGunfire.Num() == 0) {
+		return;
+	}
+
+	RebuildListenerGrid(World);
+
+	FWeaponFrameArenaMark ArenaMark;
+	TArray<int32, FWeaponFrameAllocator> CandidateScratch;
+	CandidateScratch.Reserve(Listeners.Num());
+	for (const FPendingGunfire& Gunfire : PendingGunfire) {
+		DeliverGunfire(Gunfire, CandidateScratch);
+	}
+
+	PendingGunfire.Reset();
+	PendingGunfireIndices.Reset();
+}
+
+
+void FGunfireStimulusAggregator::Reset() {
+	PendingGunfire.Reset();
+	PendingGunfireIndices.Reset();
+	Listeners.Reset();
+	ListenerGrid.Reset();
+	NextFlushTime = 0.0;
+}
+
+
+/**
+ * Snapshots every perception listener with a hearing sense into the grid.
+ */
+void FGunfireStimulusAggregator::RebuildListenerGrid(UWorld* World) {
+	Listeners.Reset();
+	MaxListenerHearingRange = 0.0f;
+
+	const float CellSize = CVarGunfireListenerCellSize.GetValueOnGameThread();
+	if (!FMath::IsNearlyEqual(ListenerGrid.GetCellSize(), CellSize)) {
+		ListenerGrid.SetCellSize(CellSize);
+	} else {
+		ListenerGrid.Reset();
+	}
+
+	UAIPerceptionSystem* PerceptionSystem = UAIPerceptionSystem::GetCurrent(World);
+	if (!PerceptionSystem) {
+		return;
+	}
+
+	const FAISenseID HearingSenseID = UAISense::GetSenseID<UAISense_Hearing>();
+	for (TPair<FPerceptionListenerID, FPerceptionListener>& ListenerPair : PerceptionSystem->GetListenersMap()) {
+		const FPerceptionListener& PerceptionListener = ListenerPair.Value;
+		UAIPerceptionComponent* PerceptionComponent = PerceptionListener.Listener.Get();
+		if (!PerceptionComponent || !PerceptionListener.HasSense(HearingSenseID)) {
+			continue;
+		}
+
+		const UAISenseConfig_Hearing* HearingConfig = Cast<UAISenseConfig_Hearing>(PerceptionComponent->GetSenseConfig(HearingSenseID));
+		if (!HearingConfig) {
+			continue;
+		}
+
+		FGunfireListener& Listener = Listeners.AddDefaulted_GetRef();
+		Listener.PerceptionComponent = PerceptionComponent;
+		Listener.Location = PerceptionListener.CachedLocation;
+		Listener.HearingRange = HearingConfig->HearingRange;
+		Listener.TeamIdentifier = PerceptionListener.TeamIdentifier;
+		Listener.AffiliationFlags = HearingConfig->DetectionByAffiliation.GetAsFlags();
+
+		MaxListenerHearingRange = FMath::Max(MaxListenerHearingRange, Listener.HearingRange);
+		ListenerGrid.Add(Listeners.Num() - 1, Listener.Location);
+	}
+}
+
+
+/**
+ * Registers an aggregated hearing stimulus directly on listeners within range.
+ *
+ * @note Bypasses the perception system's per-event listener sweep - only grid
+ *       candidates inside loudness-scaled hearing range are touched
+ * @remark Applies the hearing sense's affiliation filter itself, as RegisterStimulus() does not
+ */
+void FGunfireStimulusAggregator::DeliverGunfire(const FPendingGunfire& Gunfire, TArray<int32, FWeaponFrameAllocator>& CandidateScratch) const {
+	AActor* Shooter = Gunfire.Shooter.Get();
+	if (!Shooter) {
+		return;
+	}
+
+	const float LoudestAudibleRange = MaxListenerHearingRange * Gunfire.PeakLoudness;
+	const float QueryRadius = Gunfire.MaxRange > 0.0f ? FMath::Min(Gunfire.MaxRange, LoudestAudibleRange) : LoudestAudibleRange;
+	if (QueryRadius <= 0.0f) {
+		return;
+	}
+
+	CandidateScratch.Reset();
+	ListenerGrid.QuerySphere(Gunfire.Location, QueryRadius, CandidateScratch);
+
+	const UAISense_Hearing* HearingSense = GetDefault<UAISense_Hearing>();
+	const FGenericTeamId ShooterTeam = FGenericTeamId::GetTeamIdentifier(Shooter);
+
+	for (const int32 ListenerIndex : CandidateScratch) {
+		const FGunfireListener& Listener = Listeners[ListenerIndex];
+		UAIPerceptionComponent* PerceptionComponent = Listener.PerceptionComponent.Get();
+		if (!PerceptionComponent) {
+			continue;
+		}
+
+		// Shooters do not hear their own gunfire
+		const AController* ListenerController = Cast<AController>(PerceptionComponent->GetOwner());
+		if (PerceptionComponent->GetOwner() == Shooter || (ListenerController && ListenerController->GetPawn() == Shooter)) {
+			continue;
+		}
+
+		if (!FAISenseAffiliationFilter::ShouldSenseTeam(Listener.TeamIdentifier, ShooterTeam, Listener.AffiliationFlags)) {
+			continue;
+		}
+
+		float AudibleRange = Listener.HearingRange * Gunfire.PeakLoudness;
+		if (Gunfire.MaxRange > 0.0f) {
+			AudibleRange = FMath::Min(AudibleRange, Gunfire.MaxRange);
+		}
+		if (FVector::DistSquared(Listener.Location, Gunfire.Location) > FMath::Square(AudibleRange)) {
+			continue;
+		}
+
+		PerceptionComponent->RegisterStimulus(Shooter, FAIStimulus(*HearingSense, Gunfire.ShotCount, Gunfire.Location, Listener.Location, FAIStimulus::SensingSucceeded, GunfireStimulusTag));
+	}
+}
@@ -0,0 +1,128 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AI/SentryTurretManager.h"
+
+#include "Component/SentryTurretComponent.h"
+#include "Engine/World.h"
+#include "Projectile/HitboxHistory.h"
+#include "Trace/WeaponCsvStats.h"
+
+static TAutoConsoleVariable<float> CVarSentryCellSize(
+	TEXT("weapon.AI.SentryCellSize"),
+	2000.0f,
+	TEXT("Cell size of the grid used to find sentries a character is in range of (cm)."));
+
+static TAutoConsoleVariable<int32> CVarSentryLineOfFireChecksPerFrame(
+	TEXT("weapon.AI.SentryLineOfFireChecksPerFrame"),
+	8,
+	TEXT("Line of fire traces shared by all awake sentries each frame."));
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Sentries"), STAT_Sentries, STATGROUP_WeaponAI);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Awake sentries"), STAT_SentriesAwake, STATGROUP_WeaponAI);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Sentry line of fire checks"), STAT_SentryLineOfFireChecks, STATGROUP_WeaponAI);
+
+
+void FSentryTurretManager::Register(USentryTurretComponent* Sentry) {
+	Sentries.AddUnique(Sentry);
+	bSentryGridDirty = true;
+}
+
+
+void FSentryTurretManager::Unregister(USentryTurretComponent* Sentry) {
+	Sentries.RemoveSingleSwap(Sentry);
+	AwakeSentries.RemoveSingleSwap(Sentry);
+	bSentryGridDirty = true;
+}
+
+
+/**
+ * Looks up the cell of every character and wakes the sentries in range of it.
+ *
+ * @note Sleeping sentries cost nothing here - only cells holding a character are visited
+ */
+void FSentryTurretManager::Tick(UWorld* World, TConstArrayView<FHitboxCapsule> Characters) {
+	SET_DWORD_STAT(STAT_Sentries, Sentries.Num());
+	if (Sentries.Num() == 0) {
+		return;
+	}
+
+	if (bSentryGridDirty) {
+		RebuildSentryGrid();
+	}
+
+	// Sentries put themselves to sleep, they leave the awake list before they can be woken again
+	AwakeSentries.RemoveAllSwap([](const TWeakObjectPtr<USentryTurretComponent>& Sentry) {
+		return !Sentry.IsValid() || !Sentry->IsAwake();
+	});
+
+	const double Time = World->GetTimeSeconds();
+	for (const FHitboxCapsule& Character : Characters) {
+		if (!Character.IsValid()) {
+			continue;
+		}
+
+		const TArray<int32>* CellSentries = SentryGrid.FindCell(SentryGrid.GetCell(Character.Center));
+		if (!CellSentries) {
+			continue;
+		}
+
+		AActor* CharacterActor = Character.Actor.Get();
+		for (const int32 SentryIndex : *CellSentries) {
+			USentryTurretComponent* Sentry = Sentries[SentryIndex].Get();
+			if (!Sentry || !CharacterActor) {
+				continue;
+			}
+
+			const float WakeRadius = Sentry->GetWakeRadius();
+			if (FVector::DistSquared(Sentry->GetOwner()->GetActorLocation(), Character.Center) > FMath::Square(WakeRadius) || !Sentry->CanTarget(CharacterActor)) {
+				continue;
+			}
+
+			if (Sentry->NotifyCandidateInRange(CharacterActor, Character.Center, Time)) {
+				AwakeSentries.Add(Sentry);
+			}
+		}
+	}
+
+	const int32 NumChecks = FMath::Min(FMath::Max(CVarSentryLineOfFireChecksPerFrame.GetValueOnGameThread(), 0), AwakeSentries.Num());
+	for (int32 Check = 0; Check < NumChecks; ++Check) {
+		NextLineOfFireIndex %= AwakeSentries.Num();
+		AwakeSentries[NextLineOfFireIndex++]->UpdateLineOfFire();
+	}
+
+	SET_DWORD_STAT(STAT_SentriesAwake, AwakeSentries.Num());
+	INC_DWORD_STAT_BY(STAT_SentryLineOfFireChecks, NumChecks);
+	CSV_WEAPON_SET(SentriesAwake, AwakeSentries.Num());
+}
+
+
+void FSentryTurretManager::Reset() {
+	Sentries.Reset();
+	AwakeSentries.Reset();
+	SentryGrid.Reset();
+	bSentryGridDirty = false;
+	NextLineOfFireIndex = 0;
+}
+
+
+/**
+ * Adds each sentry to every cell its wake sphere touches.
+ *
+ * @note Sentries destroyed without EndPlay are dropped here
+ */
+void FSentryTurretManager::RebuildSentryGrid() {
+	Sentries.RemoveAllSwap([](const TWeakObjectPtr<USentryTurretComponent>& Sentry) {
+		return !Sentry.IsValid();
+	});
+
+	SentryGrid.SetCellSize(CVarSentryCellSize.GetValueOnGameThread());
+	SentryGrid.Reset();
+
+	for (int32 SentryIndex = 0; SentryIndex < Sentries.Num(); ++SentryIndex) {
+		const USentryTurretComponent* Sentry = Sentries[SentryIndex].Get();
+		const FVector Location = Sentry->GetOwner()->GetActorLocation();
+		SentryGrid.AddBounds(SentryIndex, FBox::BuildAABB(Location, FVector(Sentry->GetWakeRadius())));
+	}
+
+	bSentryGridDirty = false;
+}
@@ -0,0 +1,192 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Audio/GunfireOcclusionCache.h"
+
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Spatial/WeaponSpatialGrid.h"
+
+static TAutoConsoleVariable<int32> CVarGunfireOcclusionTraceBudget(
+	TEXT("weapon.Audio.OcclusionTraceBudget"),
+	8,
+	TEXT("Maximum number of async gunfire occlusion traces issued per frame."));
+
+static TAutoConsoleVariable<float> CVarGunfireOcclusionCellSize(
+	TEXT("weapon.Audio.OcclusionCellSize"),
+	400.0f,
+	TEXT("Size of the cells shooters are grouped into for occlusion caching (cm)."));
+
+static TAutoConsoleVariable<float> CVarGunfireOccludedVolume(
+	TEXT("weapon.Audio.OccludedVolume"),
+	0.35f,
+	TEXT("Volume multiplier applied to gunfire heard through static geometry."));
+
+static TAutoConsoleVariable<float> CVarGunfireOcclusionRefreshInterval(
+	TEXT("weapon.Audio.OcclusionRefreshInterval"),
+	0.25f,
+	TEXT("Minimum seconds between two traces of the same shooter cell and listener."));
+
+namespace GunfireOcclusion {
+	// Pairs not queried for this long are dropped from the cache (seconds)
+	constexpr double EvictAfterSeconds = 5.0;
+
+	// Speed volume multipliers blend towards newly traced values
+	constexpr float VolumeInterpSpeed = 8.0f;
+}
+
+
+/**
+ * Returns the cached volume multiplier for a shot.
+ *
+ * @note First use of a pair schedules a priority trace and reports unoccluded meanwhile
+ */
+float FGunfireOcclusionCache::GetVolumeMultiplier(const UWorld* World, const FVector& ShooterLocation) {
+	uint32 ListenerId;
+	FVector ListenerLocation;
+	if (!GetPrimaryListener(World, ListenerId, ListenerLocation)) {
+		return 1.0f;
+	}
+
+	const float CellSize = FMath::Max(CVarGunfireOcclusionCellSize.GetValueOnGameThread(), 1.0f);
+	const FOcclusionKey Key(FWeaponSpatialGrid::GetCell(ShooterLocation, CellSize), ListenerId);
+
+	FOcclusionEntry* Entry = Entries.Find(Key);
+	if (!Entry) {
+		Entry = &Entries.Add(Key);
+		NewKeys.Add(Key);
+		RefreshOrder.Add(Key);
+	}
+
+	Entry->ShooterLocation = ShooterLocation;
+	Entry->LastQueryTime = World->GetTimeSeconds();
+	return Entry->VolumeMultiplier;
+}
+
+
+/**
+ * Advances the cache by one frame.
+ *
+ * Order of work:
+ * 1. Consume async traces issued last frame
+ * 2. Blend volumes towards traced values
+ * 3. Trace new pairs, then refresh old pairs round-robin until the budget is spent
+ *
+ * @note Stale pairs are evicted as the round-robin passes over them
+ */
+void FGunfireOcclusionCache::Tick(UWorld* World, float DeltaTime) {
+	const float OccludedVolume = CVarGunfireOccludedVolume.GetValueOnGameThread();
+
+	for (int32 PendingIndex = PendingKeys.Num() - 1; PendingIndex >= 0; --PendingIndex) {
+		FOcclusionEntry* Entry = Entries.Find(PendingKeys[PendingIndex]);
+		if (!Entry) {
+			PendingKeys.RemoveAtSwap(PendingIndex);
+			continue;
+		}
+
+		FTraceDatum TraceDatum;
+		if (World->QueryTraceData(Entry->TraceHandle, TraceDatum)) {
+			// Any static hit between shooter and listener muffles the shot
+			Entry->TargetVolumeMultiplier = TraceDatum.OutHits.Num() > 0 ? OccludedVolume : 1.0f;
+		} else if (World->IsTraceHandleValid(Entry->TraceHandle, false)) {
+			// Still in flight
+			continue;
+		}
+
+		Entry->TraceHandle.Invalidate();
+		PendingKeys.RemoveAtSwap(PendingIndex);
+	}
+
+	for (TPair<FOcclusionKey, FOcclusionEntry>& Pair : Entries) {
+		Pair.Value.VolumeMultiplier = FMath::FInterpTo(Pair.Value.VolumeMultiplier, Pair.Value.TargetVolumeMultiplier, DeltaTime, GunfireOcclusion::VolumeInterpSpeed);
+	}
+
+	uint32 ListenerId;
+	FVector ListenerLocation;
+	if (!GetPrimaryListener(World, ListenerId, ListenerLocation)) {
+		return;
+	}
+
+	int32 TraceBudget = CVarGunfireOcclusionTraceBudget.GetValueOnGameThread();
+	const double CurrentTime = World->GetTimeSeconds();
+	const double RefreshInterval = CVarGunfireOcclusionRefreshInterval.GetValueOnGameThread();
+
+	// Newly heard shooter cells jump the queue so occlusion settles quickly
+	while (TraceBudget > 0 && NewKeys.Num() > 0) {
+		const FOcclusionKey Key = NewKeys.Pop();
+		FOcclusionEntry* Entry = Entries.Find(Key);
+		if (Entry && Key.Value == ListenerId && !Entry->TraceHandle.IsValid()) {
+			RequestTrace(World, Key, *Entry, ListenerLocation);
+			--TraceBudget;
+		}
+	}
+
+	int32 NumVisited = 0;
+	const int32 NumToVisit = RefreshOrder.Num();
+	while (TraceBudget > 0 && NumVisited < NumToVisit && RefreshOrder.Num() > 0) {
+		++NumVisited;
+		if (RefreshCursor >= RefreshOrder.Num()) {
+			RefreshCursor = 0;
+		}
+
+		const FOcclusionKey Key = RefreshOrder[RefreshCursor];
+		FOcclusionEntry& Entry = Entries.FindChecked(Key);
+
+		// Nobody has fired from here recently - forget the pair
+		if (CurrentTime - Entry.LastQueryTime > GunfireOcclusion::EvictAfterSeconds && !Entry.TraceHandle.IsValid()) {
+			Entries.Remove(Key);
+			RefreshOrder.RemoveAtSwap(RefreshCursor);
+			continue;
+		}
+		++RefreshCursor;
+
+		if (Key.Value != ListenerId || Entry.TraceHandle.IsValid() || CurrentTime - Entry.LastTraceTime < RefreshInterval) {
+			continue;
+		}
+
+		RequestTrace(World, Key, Entry, ListenerLocation);
+		--TraceBudget;
+	}
+}
+
+
+void FGunfireOcclusionCache::Reset() {
+	Entries.Reset();
+	NewKeys.Reset();
+	PendingKeys.Reset();
+	RefreshOrder.Reset();
+	RefreshCursor = 0;
+}
+
+
+bool FGunfireOcclusionCache::GetPrimaryListener(const UWorld* World, uint32& OutListenerId, FVector& OutListenerLocation) {
+	// Dedicated servers never play audio
+	if (!World || World->GetNetMode() == NM_DedicatedServer) {
+		return false;
+	}
+
+	const APlayerController* PlayerController = GEngine->GetFirstLocalPlayerController(World);
+	if (!PlayerController) {
+		return false;
+	}
+
+	FVector ListenerFront;
+	FVector ListenerRight;
+	PlayerController->GetAudioListenerPosition(OutListenerLocation, ListenerFront, ListenerRight);
+	OutListenerId = PlayerController->GetUniqueID();
+	return true;
+}
+
+
+/**
+ * Traces static geometry between the cached shooter location and the listener.
+ *
+ * @note Only WorldStatic objects occlude so pawns and props never muffle gunfire
+ */
+void FGunfireOcclusionCache::RequestTrace(UWorld* World, const FOcclusionKey& Key, FOcclusionEntry& Entry, const FVector& ListenerLocation) {
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(GunfireOcclusion), false);
+
+	Entry.TraceHandle = World->AsyncLineTraceByObjectType(EAsyncTraceType::Single, Entry.ShooterLocation, ListenerLocation, FCollisionObjectQueryParams(ECC_WorldStatic), QueryParams);
+	Entry.LastTraceTime = World->GetTimeSeconds();
+	PendingKeys.Add(Key);
+}
@@ -0,0 +1,155 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Component/SentryTurretComponent.h"
+
+#include "Logging.h"
+#include "Engine/World.h"
+#include "Subsystem/WeaponSubsystem.h"
+#include "Trace/WeaponCsvStats.h"
+#include "Weapon/RangedWeapon.h"
+
+
+USentryTurretComponent::USentryTurretComponent() {
+	// Only ticks while awake, see FSentryTurretManager
+	PrimaryComponentTick.bCanEverTick = true;
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+}
+
+
+void USentryTurretComponent::BeginPlay() {
+	Super::BeginPlay();
+
+	Weapon = Cast<ARangedWeapon>(GetOwner());
+	if (!Weapon) {
+		UE_LOG(LogWeaponHandlingModule, Warning, TEXT("SentryTurretComponent: %s is not a ranged weapon"), *GetNameSafe(GetOwner()));
+		return;
+	}
+
+	if (!Weapon->HasAuthority()) {
+		return;
+	}
+
+	// Aiming is done here, the weapon itself has nothing to tick
+	Weapon->SetActorTickEnabled(false);
+	Weapon->SetReplicateMovement(true);
+
+	if (UWeaponSubsystem* WeaponSubsystem = GetWorld()->GetSubsystem<UWeaponSubsystem>()) {
+		WeaponSubsystem->GetSentryTurretManager().Register(this);
+	}
+}
+
+
+void USentryTurretComponent::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	if (UWeaponSubsystem* WeaponSubsystem = GetWorld()->GetSubsystem<UWeaponSubsystem>()) {
+		WeaponSubsystem->GetSentryTurretManager().Unregister(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+
+bool USentryTurretComponent::CanTarget_Implementation(AActor* InCandidate) const {
+	return InCandidate && InCandidate != Weapon;
+}
+
+
+/**
+ * Wakes the sentry and keeps the closest candidate of the frame.
+ *
+ * @note Candidates from an earlier frame are replaced regardless of distance
+ */
+bool USentryTurretComponent::NotifyCandidateInRange(AActor* InCandidate, const FVector& Location, double Time) {
+	LastCandidateTime = Time;
+
+	const FVector SentryLocation = GetOwner()->GetActorLocation();
+	if (CandidateFrame != GFrameCounter || !Candidate.IsValid() || FVector::DistSquared(SentryLocation, Location) < FVector::DistSquared(SentryLocation, CandidateLocation)) {
+		Candidate = InCandidate;
+		CandidateLocation = Location;
+		CandidateFrame = GFrameCounter;
+	}
+
+	if (bAwake) {
+		return false;
+	}
+
+	bAwake = true;
+	SetComponentTickEnabled(true);
+	return true;
+}
+
+
+/**
+ * Checks whether the barrel can see this frame's candidate.
+ *
+ * @note The candidate counts as visible if the first blocking hit is the candidate itself
+ */
+void USentryTurretComponent::UpdateLineOfFire() {
+	AActor* CurrentCandidate = Candidate.Get();
+	if (!Weapon || !CurrentCandidate || CandidateFrame != GFrameCounter) {
+		Target = nullptr;
+		return;
+	}
+
+	FCollisionQueryParams CollisionParams(SCENE_QUERY_STAT(SentryLineOfFire), false, Weapon);
+	CollisionParams.AddIgnoredActors(Weapon->GetActorsToIgnore());
+
+	FHitResult LineOfFireHitResult;
+	CSV_WEAPON_COUNT(Traces, 1);
+	const bool bBlocked = GetWorld()->LineTraceSingleByChannel(LineOfFireHitResult, Weapon->GetMuzzleTransform(0).GetLocation(), CandidateLocation, ECollisionChannel::ECC_Visibility, CollisionParams);
+
+	Target = !bBlocked || LineOfFireHitResult.GetActor() == CurrentCandidate ? CurrentCandidate : nullptr;
+}
+
+
+float USentryTurretComponent::GetWakeRadius() const {
+	if (WakeRadius > 0.0f || !Weapon) {
+		return WakeRadius;
+	}
+	return Weapon->GetWeaponData().WeaponRange;
+}
+
+
+void USentryTurretComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) {
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	if (!Weapon || GetWorld()->GetTimeSeconds() - LastCandidateTime > SleepDelay) {
+		Sleep();
+		return;
+	}
+
+	if (Target.IsValid()) {
+		EngageTarget(DeltaTime);
+	}
+}
+
+
+void USentryTurretComponent::Sleep() {
+	bAwake = false;
+	Target = nullptr;
+	Candidate = nullptr;
+	SetComponentTickEnabled(false);
+}
+
+
+/**
+ * Turns at TurnRate and fires while the barrel is within AimTolerance of the target.
+ *
+ * @note The trigger is held every frame on target, the weapon's fire rate paces the shots
+ */
+void USentryTurretComponent::EngageTarget(float DeltaTime) {
+	const FVector TargetLocation = Target->GetActorLocation();
+	const FRotator DesiredRotation = (TargetLocation - Weapon->GetActorLocation()).Rotation();
+	Weapon->SetActorRotation(FMath::RInterpConstantTo(Weapon->GetActorRotation(), DesiredRotation, DeltaTime, TurnRate));
+
+	const FTransform MuzzleTransform = Weapon->GetMuzzleTransform(0);
+	const FVector ToTarget = (TargetLocation - MuzzleTransform.GetLocation()).GetSafeNormal();
+	if (FVector::DotProduct(MuzzleTransform.GetRotation().Vector(), ToTarget) < FMath::Cos(FMath::DegreesToRadians(AimTolerance))) {
+		return;
+	}
+
+	// Sentries have no trigger to release, single fire is paced by the fire rate alone
+	Weapon->ResetShouldFireSingleShot();
+
+	FHitResult WeaponFireHitResult;
+	Weapon->LaunchAttack(WeaponFireHitResult, nullptr);
+}
@@ -0,0 +1,56 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Component/ShotEventRelayComponent.h"
+
+#include "Engine/LocalPlayer.h"
+#include "GameFramework/PlayerController.h"
+#include "UI/HitFeedbackSubsystem.h"
+#include "Weapon/RangedWeapon.h"
+
+
+UShotEventRelayComponent::UShotEventRelayComponent() {
+	PrimaryComponentTick.bCanEverTick = false;
+	SetIsReplicatedByDefault(true);
+}
+
+
+/**
+ * Finds or creates the relay on a player controller.
+ *
+ * @note Created relays replicate to the owning client as a subobject, so events
+ *       sent before that first replication are dropped like any unreliable RPC
+ */
+UShotEventRelayComponent* UShotEventRelayComponent::FindOrAdd(APlayerController* PlayerController) {
+	if (UShotEventRelayComponent* Relay = PlayerController->FindComponentByClass<UShotEventRelayComponent>()) {
+		return Relay;
+	}
+
+	if (!PlayerController->HasAuthority()) {
+		return nullptr;
+	}
+
+	UShotEventRelayComponent* Relay = NewObject<UShotEventRelayComponent>(PlayerController);
+	Relay->RegisterComponent();
+	return Relay;
+}
+
+
+void UShotEventRelayComponent::ClientReceiveShotCosmetics_Implementation(ARangedWeapon* Weapon, const FShotCosmeticBatch& Batch) {
+	if (Weapon) {
+		Weapon->ReceiveShotCosmetics(Batch);
+	}
+}
+
+
+void UShotEventRelayComponent::ClientReceiveDistantGunfire_Implementation(const TArray<FDistantGunfire>& DistantGunfire) {
+	OnDistantGunfireReceived.Broadcast(DistantGunfire);
+}
+
+
+void UShotEventRelayComponent::ClientReceiveHitFeedback_Implementation(const TArray<FHitFeedback>& Hits) {
+	const APlayerController* PlayerController = Cast<APlayerController>(GetOwner());
+	const ULocalPlayer* LocalPlayer = PlayerController ? PlayerController->GetLocalPlayer() : nullptr;
+	if (UHitFeedbackSubsystem* HitFeedbackSubsystem = LocalPlayer ? LocalPlayer->GetSubsystem<UHitFeedbackSubsystem>() : nullptr) {
+		HitFeedbackSubsystem->AddHits(Hits);
+	}
+}
@@ -8,6 +8,10 @@
 #include "Kismet/KismetSystemLibrary.h"
 #include "Weapon/RangedWeapon.h"
 
+namespace WeaponEquip {
+	// Slack on the server's range check, covers the mesh extent and movement during the request (cm)
+	constexpr float RangeTolerance = 100.0f;
+}
 
 /**
  * Creates a weapon handling system with safe defaults.
@@ -19,6 +23,9 @@
 UWeaponHandlingComponent::UWeaponHandlingComponent(): WeaponMappingContext(nullptr) {
 	PrimaryComponentTick.bCanEverTick = true;
 
+	// Needed for the server RPCs that forward client input
+	SetIsReplicatedByDefault(true);
+
 	// Cache owner as character for frequent use
 	OwningCharacter = Cast<ACharacter>(GetOwner());
 }
@@ -63,6 +70,11 @@ void UWeaponHandlingComponent::BeginPlay() {
  */
 void UWeaponHandlingComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction ) {
 	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// Stands in for the Triggered input of a remote client, the weapon enforces its own cadence
+	if (bRemoteTriggerHeld && ActiveWeapon) {
+		WeaponAttack();
+	}
 }
 
 
@@ -133,6 +145,11 @@ void UWeaponHandlingComponent::InitializeWeaponHandlingComponent() {
 void UWeaponHandlingComponent::SetupInputBindings( UEnhancedInputComponent* InputComponent ) {
 	// Bind primary fire to Triggered event (continuous while pressed)
 	InputComponent->BindAction(FireWeaponAction, ETriggerEvent::Triggered, this, &UWeaponHandlingComponent::WeaponAttack);
+
+	// Remote clients only tell the server when the trigger changes state
+	InputComponent->BindAction(FireWeaponAction, ETriggerEvent::Started, this, &UWeaponHandlingComponent::StartWeaponAttack);
+	InputComponent->BindAction(FireWeaponAction, ETriggerEvent::Completed, this, &UWeaponHandlingComponent::StopWeaponAttack);
+	InputComponent->BindAction(FireWeaponAction, ETriggerEvent::Canceled, this, &UWeaponHandlingComponent::StopWeaponAttack);
 	InputComponent->BindAction(EquipWeaponAction, ETriggerEvent::Started, this, &UWeaponHandlingComponent::EquipWeapon);
 	InputComponent->BindAction(UnequipWeaponAction, ETriggerEvent::Started, this, &UWeaponHandlingComponent::UnequipWeapon);
 }
@@ -146,6 +163,7 @@ void UWeaponHandlingComponent::SetupInputBindings( UEnhancedInputComponent* Inpu
  *        - Play visual effects
  *        - Apply damage
  * @remark Handles ownership and instigator setup
+ * @remark Only cosmetic on remote clients - the server fires while StartWeaponAttack() holds the trigger
  * @warning Requires:
  *          - Valid ActiveWeapon
  *          - Owner must be a Character
@@ -154,6 +172,7 @@ void UWeaponHandlingComponent::WeaponAttack() {
 	// Delegate actual firing logic to the weapon itself
 	if (!ActiveWeapon) {
 		UE_LOG(LogWeaponHandlingModule, Warning, TEXT("WeaponHandlingComponent: No active weapon found"));
+		return;
 	}
 
 	if (!OwningCharacter) {
@@ -164,8 +183,6 @@ void UWeaponHandlingComponent::WeaponAttack() {
 	if (FireWeaponMontage) {
 		OwningCharacter->GetMesh()->GetAnimInstance()->Montage_Play(FireWeaponMontage);
 	}
-	
-	GEngine->AddOnScreenDebugMessage(11, 5.f, FColor::Red, TEXT("WeaponAttack called"));
 
 	FHitResult WeaponFireHitResult;
 	const ACharacter* InstigatorCharacter = OwningCharacter;
@@ -241,6 +258,7 @@ void UWeaponHandlingComponent::DropWeapon() {
  *         - Weapon swapping
  *         - Inventory management
  * @warning Sphere overlap parameters hardcoded to 100 units
+ * @note A remote client sends the weapon it picked, so the server never runs its own search
  */
 void UWeaponHandlingComponent::EquipWeapon() {
 	// Set up ignore list for overlap check
@@ -256,45 +274,131 @@ void UWeaponHandlingComponent::EquipWeapon() {
 	UKismetSystemLibrary::SphereOverlapActors( GetWorld(),GetOwner()->GetActorLocation(),WeaponDetectionRange,TArray<TEnumAsByte<EObjectTypeQuery>>(), ABaseWeapon::StaticClass(), ActorsToIgnore,ActorsInRange );
 	UKismetSystemLibrary::DrawDebugSphere( GetWorld(), GetOwner()->GetActorLocation(), WeaponDetectionRange, 12, FLinearColor::Red, 0.5f, 0.5f );
 
-	if (ActorsInRange.Num() <= 0 && !ActiveWeapon) {
-		UE_LOG(LogWeaponHandlingModule, Warning, TEXT("WeaponHandlingComponent: No weapons found in range"));
-		return;
-	}
-	// Filter to just weapon actors
-	TArray<ABaseWeapon*> WeaponsInRange;
+	// Take the first weapon actor in range
+	ABaseWeapon* NearbyWeapon = nullptr;
 	for (AActor* Actor : ActorsInRange) {
 		if (ABaseWeapon* Weapon = Cast<ABaseWeapon>(Actor)) {
-			WeaponsInRange.Emplace(Weapon);
+			NearbyWeapon = Weapon;
+			break;
 		}
 	}
-	
-	// Handle first equip case 
-	if (!ActiveWeapon && WeaponsInRange.Num() > 0) {
-		ActiveWeapon = WeaponsInRange[0];
-		WeaponsInRange.Empty();
-		
-		if (ActiveWeapon) {
-			InitializeWeapon(ActiveWeapon);
-			return;
-		}
+
+	if (!NearbyWeapon && !ActiveWeapon) {
+		UE_LOG(LogWeaponHandlingModule, Warning, TEXT("WeaponHandlingComponent: No weapons found in range"));
+		return;
+	}
+
+	if (!GetOwner()->HasAuthority()) {
+		ServerEquipWeaponInstance(NearbyWeapon);
 	}
 
-	// Handle weapon swap case
-	if (ActiveWeapon && WeaponsInRange.Num() > 0) {
+	if (NearbyWeapon) {
+		// Handles both the first equip and the swap
+		EquipWeaponInstance(NearbyWeapon);
+	} else {
+		// No weapons found, drop current weapon
 		DropWeapon();
-		ActiveWeapon = WeaponsInRange[0];
-		WeaponsInRange.Empty();
-		
-		InitializeWeapon(ActiveWeapon);
+	}
+}
+
+void UWeaponHandlingComponent::EquipWeaponInstance(ABaseWeapon* Weapon) {
+	if (!Weapon || Weapon == ActiveWeapon) {
 		return;
 	}
 
-	if (ActiveWeapon && WeaponsInRange.Num() <= 0) {
-		// No weapons found, drop current weapon
+	if (ActiveWeapon) {
 		DropWeapon();
 	}
+
+	InitializeWeapon(Weapon);
 }
 
+
 void UWeaponHandlingComponent::UnequipWeapon() {
+	if (!ActiveWeapon) {
+		return;
+	}
+
+	if (!GetOwner()->HasAuthority()) {
+		ServerUnequipWeapon();
+	}
+
 	DropWeapon();
+}
+
+
+/**
+ * Forwards a trigger press to the server.
+ *
+ * @note The server owns the authoritative shots, the ones WeaponAttack() fires here are cosmetic
+ */
+void UWeaponHandlingComponent::StartWeaponAttack() {
+	if (!GetOwner()->HasAuthority()) {
+		ServerStartWeaponAttack();
+	}
+}
+
+
+/**
+ * @note Re-arms single fire here too, for the shots of the local or listen server player
+ */
+void UWeaponHandlingComponent::StopWeaponAttack() {
+	if (!GetOwner()->HasAuthority()) {
+		ServerStopWeaponAttack();
+	}
+
+	if (ARangedWeapon* RangedWeapon = Cast<ARangedWeapon>(ActiveWeapon)) {
+		RangedWeapon->ResetShouldFireSingleShot();
+	}
+}
+
+
+/**
+ * @note Fires right away so a press and release arriving together still shoot once
+ */
+void UWeaponHandlingComponent::ServerStartWeaponAttack_Implementation() {
+	bRemoteTriggerHeld = true;
+
+	if (ActiveWeapon) {
+		WeaponAttack();
+	}
+}
+
+
+void UWeaponHandlingComponent::ServerStopWeaponAttack_Implementation() {
+	bRemoteTriggerHeld = false;
+
+	if (ARangedWeapon* RangedWeapon = Cast<ARangedWeapon>(ActiveWeapon)) {
+		RangedWeapon->ResetShouldFireSingleShot();
+	}
+}
+
+
+/**
+ * @note Rejects weapons held by another character or out of reach, the client then keeps its own pick
+ */
+void UWeaponHandlingComponent::ServerEquipWeaponInstance_Implementation(ABaseWeapon* Weapon) {
+	if (!Weapon) {
+		if (ActiveWeapon) {
+			DropWeapon();
+		}
+		return;
+	}
+
+	if (Weapon == ActiveWeapon) {
+		return;
+	}
+
+	const float MaxRange = WeaponDetectionRange + WeaponEquip::RangeTolerance;
+	if (Weapon->GetOwningCharacter() || FVector::DistSquared(Weapon->GetWeaponMesh()->GetComponentLocation(), GetOwner()->GetActorLocation()) > FMath::Square(MaxRange)) {
+		UE_LOG(LogWeaponHandlingModule, Warning, TEXT("WeaponHandlingComponent: Rejected equip of %s, held or out of range"), *Weapon->GetName());
+		return;
+	}
+
+	EquipWeaponInstance(Weapon);
+}
+
+
+void UWeaponHandlingComponent::ServerUnequipWeapon_Implementation() {
+	UnequipWeapon();
 }
\ No newline at end of file
@@ -0,0 +1,123 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Memory/WeaponFrameArena.h"
+
+#include "Logging.h"
+
+DECLARE_MEMORY_STAT(TEXT("Frame arena capacity"), STAT_WeaponFrameArenaCapacity, STATGROUP_WeaponMemory);
+DECLARE_MEMORY_STAT(TEXT("Frame arena peak (frame)"), STAT_WeaponFrameArenaFramePeak, STATGROUP_WeaponMemory);
+DECLARE_MEMORY_STAT(TEXT("Frame arena high-water mark"), STAT_WeaponFrameArenaHighWaterMark, STATGROUP_WeaponMemory);
+DECLARE_MEMORY_STAT(TEXT("Frame arena heap overflow (frame)"), STAT_WeaponFrameArenaOverflowBytes, STATGROUP_WeaponMemory);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Frame arena heap overflows (frame)"), STAT_WeaponFrameArenaOverflowCount, STATGROUP_WeaponMemory);
+
+static TAutoConsoleVariable<int32> CVarWeaponFrameArenaSize(
+	TEXT("weapon.Memory.FrameArenaSize"),
+	64 * 1024,
+	TEXT("Bytes reserved for transient per-frame weapon data. Applied at the next end of frame."));
+
+
+FWeaponFrameArena& FWeaponFrameArena::Get() {
+	check(IsInGameThread());
+	static FWeaponFrameArena Arena;
+	return Arena;
+}
+
+
+FWeaponFrameArena::~FWeaponFrameArena() {
+	FreeOverflow(0);
+	FMemory::Free(BlockBegin);
+}
+
+
+/**
+ * Bumps the top of the block, or falls back to the heap when the block is full.
+ */
+void* FWeaponFrameArena::Allocate(SIZE_T Size, uint32 Alignment) {
+	if (!BlockBegin) {
+		ResizeBlock();
+	}
+
+	uint8* Result = Align(BlockTop, Alignment);
+	if (Result + Size <= BlockEnd) {
+		BlockTop = Result + Size;
+		FramePeakBytes = FMath::Max(FramePeakBytes, static_cast<SIZE_T>(BlockTop - BlockBegin));
+		return Result;
+	}
+
+	FrameOverflowBytes += Size;
+	return OverflowAllocations.Add_GetRef(FMemory::Malloc(Size, Alignment));
+}
+
+
+/**
+ * Rewinds the block and frees heap fallbacks.
+ *
+ * @note The block is resized here when weapon.Memory.FrameArenaSize changed, since nothing is alive
+ */
+void FWeaponFrameArena::Reset() {
+	if (!ensureMsgf(NumMarks == 0, TEXT("Weapon frame arena reset with %d live marks"), NumMarks)) {
+		return;
+	}
+
+	HighWaterMark = FMath::Max(HighWaterMark, FramePeakBytes + FrameOverflowBytes);
+
+	SET_MEMORY_STAT(STAT_WeaponFrameArenaFramePeak, FramePeakBytes);
+	SET_MEMORY_STAT(STAT_WeaponFrameArenaHighWaterMark, HighWaterMark);
+	SET_MEMORY_STAT(STAT_WeaponFrameArenaOverflowBytes, FrameOverflowBytes);
+	SET_DWORD_STAT(STAT_WeaponFrameArenaOverflowCount, OverflowAllocations.Num());
+
+	if (OverflowAllocations.Num() > 0) {
+		UE_LOG(LogWeaponHandlingModule, Verbose, TEXT("WeaponFrameArena: %d allocations (%llu bytes) overflowed to the heap"), OverflowAllocations.Num(), static_cast<uint64>(FrameOverflowBytes));
+		FreeOverflow(0);
+	}
+
+	BlockTop = BlockBegin;
+	FramePeakBytes = 0;
+	FrameOverflowBytes = 0;
+
+	if (BlockBegin && BlockEnd - BlockBegin != CVarWeaponFrameArenaSize.GetValueOnGameThread()) {
+		ResizeBlock();
+	}
+}
+
+
+void FWeaponFrameArena::ResizeBlock() {
+	const SIZE_T Capacity = FMath::Max(CVarWeaponFrameArenaSize.GetValueOnGameThread(), 0);
+
+	FMemory::Free(BlockBegin);
+	BlockBegin = static_cast<uint8*>(FMemory::Malloc(FMath::Max<SIZE_T>(Capacity, 1)));
+	BlockTop = BlockBegin;
+	BlockEnd = BlockBegin + Capacity;
+
+	SET_MEMORY_STAT(STAT_WeaponFrameArenaCapacity, Capacity);
+}
+
+
+void FWeaponFrameArena::FreeOverflow(int32 FirstOverflowIndex) {
+	for (int32 OverflowIndex = FirstOverflowIndex; OverflowIndex < OverflowAllocations.Num(); ++OverflowIndex) {
+		FMemory::Free(OverflowAllocations[OverflowIndex]);
+	}
+	OverflowAllocations.SetNum(FirstOverflowIndex, EAllowShrinking::No);
+}
+
+
+FWeaponFrameArenaMark::FWeaponFrameArenaMark() {
+	FWeaponFrameArena& Arena = FWeaponFrameArena::Get();
+	SavedTop = Arena.BlockTop;
+	SavedNumOverflow = Arena.OverflowAllocations.Num();
+	++Arena.NumMarks;
+}
+
+
+FWeaponFrameArenaMark::~FWeaponFrameArenaMark() {
+	FWeaponFrameArena& Arena = FWeaponFrameArena::Get();
+	Arena.FreeOverflow(SavedNumOverflow);
+	--Arena.NumMarks;
+
+	// The block may have been allocated after this mark was taken
+	if (SavedTop) {
+		Arena.BlockTop = SavedTop;
+	} else {
+		Arena.BlockTop = Arena.BlockBegin;
+	}
+}
@@ -0,0 +1,60 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Memory/WeaponObjectCreationTracker.h"
+
+#include "HAL/PlatformTime.h"
+#include "Memory/WeaponFrameArena.h"
+#include "Trace/WeaponCsvStats.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("UObjects created/s"), STAT_WeaponObjectsCreatedPerSecond, STATGROUP_WeaponMemory);
+
+
+FWeaponObjectCreationTracker& FWeaponObjectCreationTracker::Get() {
+	static FWeaponObjectCreationTracker Tracker;
+	return Tracker;
+}
+
+
+void FWeaponObjectCreationTracker::Register() {
+	if (!bRegistered) {
+		GUObjectArray.AddUObjectCreateListener(this);
+		bRegistered = true;
+	}
+}
+
+
+void FWeaponObjectCreationTracker::Unregister() {
+	if (bRegistered) {
+		GUObjectArray.RemoveUObjectCreateListener(this);
+		bRegistered = false;
+	}
+}
+
+
+void FWeaponObjectCreationTracker::Tick() {
+	const double CurrentTime = FPlatformTime::Seconds();
+	if (CurrentTime - WindowStartTime < 1.0) {
+		return;
+	}
+
+	SET_DWORD_STAT(STAT_WeaponObjectsCreatedPerSecond, FMath::RoundToInt(NumCreated / (CurrentTime - WindowStartTime)));
+
+	NumCreated = 0;
+	WindowStartTime = CurrentTime;
+}
+
+
+/**
+ * @note Called for every object of the process, from any thread - keep it trivial
+ */
+void FWeaponObjectCreationTracker::NotifyUObjectCreated(const UObjectBase* Object, int32 Index) {
+	if (ScopeDepth > 0 && IsInGameThread()) {
+		++NumCreated;
+		CSV_WEAPON_COUNT(ObjectsCreated, 1);
+	}
+}
+
+
+void FWeaponObjectCreationTracker::OnUObjectArrayShutdown() {
+	Unregister();
+}
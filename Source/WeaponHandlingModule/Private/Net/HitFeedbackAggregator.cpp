@@ -0,0 +1,87 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Net/HitFeedbackAggregator.h"
+
+#include "Component/ShotEventRelayComponent.h"
+#include "Engine/LocalPlayer.h"
+#include "GameFramework/PlayerController.h"
+#include "UI/HitFeedbackSubsystem.h"
+
+
+/**
+ * Merges the hit into the instigator's entry for the target.
+ *
+ * @note Linear searches - a player hits a handful of targets per frame at most
+ */
+void FHitFeedbackAggregator::ReportHit(AController* Instigator, AActor* Target, const FVector& Location, float Damage) {
+	APlayerController* PlayerController = Cast<APlayerController>(Instigator);
+	if (!PlayerController || !Target) {
+		return;
+	}
+
+	FPendingHitFeedback* Pending = nullptr;
+	for (int32 PendingIndex = 0; PendingIndex < NumPending; ++PendingIndex) {
+		if (PendingHitFeedback[PendingIndex].Instigator == PlayerController) {
+			Pending = &PendingHitFeedback[PendingIndex];
+			break;
+		}
+	}
+
+	if (!Pending) {
+		if (NumPending == PendingHitFeedback.Num()) {
+			PendingHitFeedback.AddDefaulted();
+		}
+		Pending = &PendingHitFeedback[NumPending++];
+		Pending->Instigator = PlayerController;
+	}
+
+	int32 HitIndex = Pending->Hits.IndexOfByPredicate([Target](const FHitFeedback& Hit) { return Hit.Target == Target; });
+	if (HitIndex == INDEX_NONE) {
+		HitIndex = Pending->Hits.AddDefaulted();
+		Pending->LocationSums.Add(FVector::ZeroVector);
+		Pending->Hits[HitIndex].Target = Target;
+	}
+
+	FHitFeedback& Hit = Pending->Hits[HitIndex];
+	Hit.Damage += Damage;
+
+	// The count saturates, so the average stops taking locations with it and stays an average
+	if (Hit.NumHits < MAX_uint8) {
+		++Hit.NumHits;
+		Pending->LocationSums[HitIndex] += Location;
+	}
+}
+
+
+void FHitFeedbackAggregator::Flush() {
+	for (int32 PendingIndex = 0; PendingIndex < NumPending; ++PendingIndex) {
+		FPendingHitFeedback& Pending = PendingHitFeedback[PendingIndex];
+
+		for (int32 HitIndex = 0; HitIndex < Pending.Hits.Num(); ++HitIndex) {
+			Pending.Hits[HitIndex].Location = Pending.LocationSums[HitIndex] / Pending.Hits[HitIndex].NumHits;
+		}
+
+		if (APlayerController* PlayerController = Pending.Instigator.Get()) {
+			if (PlayerController->IsLocalController()) {
+				const ULocalPlayer* LocalPlayer = PlayerController->GetLocalPlayer();
+				if (UHitFeedbackSubsystem* HitFeedbackSubsystem = LocalPlayer ? LocalPlayer->GetSubsystem<UHitFeedbackSubsystem>() : nullptr) {
+					HitFeedbackSubsystem->AddHits(Pending.Hits);
+				}
+			} else if (UShotEventRelayComponent* Relay = UShotEventRelayComponent::FindOrAdd(PlayerController)) {
+				Relay->ClientReceiveHitFeedback(Pending.Hits);
+			}
+		}
+
+		Pending.Instigator.Reset();
+		Pending.Hits.Reset();
+		Pending.LocationSums.Reset();
+	}
+
+	NumPending = 0;
+}
+
+
+void FHitFeedbackAggregator::Reset() {
+	PendingHitFeedback.Reset();
+	NumPending = 0;
+}
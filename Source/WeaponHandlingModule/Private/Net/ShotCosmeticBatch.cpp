@@ -0,0 +1,58 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Net/ShotCosmeticBatch.h"
+
+#include "Engine/NetSerialization.h"
+
+
+bool FShotCosmeticBatch::Add(const FVector& ShotOrigin, const FVector& ShotEnd, bool bHit, uint8 Seed) {
+	if (IsFull()) {
+		return false;
+	}
+
+	if (IsEmpty()) {
+		Origin = ShotOrigin;
+	}
+
+	FShotCosmetic& Shot = Shots.AddDefaulted_GetRef();
+	Shot.EndOffset = ShotEnd - Origin;
+	Shot.Seed = Seed;
+	Shot.bHit = bHit;
+	return true;
+}
+
+
+/**
+ * Packs the batch as count, origin, sequence, then seed, hit bit and end offset per shot.
+ *
+ * @note Offsets use packed vectors, so nearby end points cost far fewer bits than full vectors
+ */
+bool FShotCosmeticBatch::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess) {
+	bOutSuccess = true;
+
+	uint8 NumShots = static_cast<uint8>(FMath::Min(Shots.Num(), MaxShots));
+	Ar << NumShots;
+
+	if (Ar.IsLoading()) {
+		Shots.SetNum(NumShots);
+	}
+
+	bOutSuccess &= SerializePackedVector<1, 24>(Origin, Ar);
+
+	uint32 Sequence = FirstShotSequence;
+	Ar.SerializeIntPacked(Sequence);
+	FirstShotSequence = static_cast<uint16>(Sequence);
+
+	for (int32 ShotIndex = 0; ShotIndex < NumShots; ++ShotIndex) {
+		FShotCosmetic& Shot = Shots[ShotIndex];
+		Ar << Shot.Seed;
+
+		uint8 bHit = Shot.bHit ? 1 : 0;
+		Ar.SerializeBits(&bHit, 1);
+		Shot.bHit = bHit != 0;
+
+		bOutSuccess &= SerializePackedVector<1, 24>(Shot.EndOffset, Ar);
+	}
+
+	return true;
+}
@@ -0,0 +1,205 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Net/ShotInterestManager.h"
+
+#include "Component/ShotEventRelayComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/PlayerController.h"
+#include "Net/ShotCosmeticBatch.h"
+#include "Weapon/RangedWeapon.h"
+
+static TAutoConsoleVariable<float> CVarShotViewerCellSize(
+	TEXT("weapon.Net.ShotViewerCellSize"),
+	10000.0f,
+	TEXT("Cell size of the grid used to find connections in range of shot events (cm)."));
+
+static TAutoConsoleVariable<float> CVarDistantGunfireInterval(
+	TEXT("weapon.Net.DistantGunfireInterval"),
+	1.0f,
+	TEXT("Seconds between distant gunfire summaries sent to each connection."));
+
+static TAutoConsoleVariable<float> CVarDistantGunfireCellSize(
+	TEXT("weapon.Net.DistantGunfireCellSize"),
+	10000.0f,
+	TEXT("Size of the areas distant gunfire is merged into (cm)."));
+
+static TAutoConsoleVariable<float> CVarDistantGunfireMinRange(
+	TEXT("weapon.Net.DistantGunfireMinRange"),
+	10000.0f,
+	TEXT("Areas closer than this to a viewer are left out of its distant gunfire summary (cm)."));
+
+
+/**
+ * Tests grid candidates against the muzzle and every tracer of the batch.
+ *
+ * @note The grid query covers the bounds of all shots, so one query serves the whole batch
+ */
+int32 FShotInterestManager::Deliver(UWorld* World, ARangedWeapon* Weapon, const FShotCosmeticBatch& Batch, float AudibleRange, float VisibleRange) {
+	FDistantGunfireArea& Area = DistantGunfire.FindOrAdd(FWeaponSpatialGrid::GetCell(Batch.Origin, CVarDistantGunfireCellSize.GetValueOnGameThread()));
+	Area.Location = Batch.Origin;
+	Area.NumShots += Batch.Shots.Num();
+
+	RebuildViewerGrid(World);
+
+	FBox ShotBounds(Batch.Origin, Batch.Origin);
+	for (const FShotCosmetic& Shot : Batch.Shots) {
+		ShotBounds += Batch.Origin + Shot.EndOffset;
+	}
+
+	const float QueryRadius = ShotBounds.GetExtent().Size() + FMath::Max(AudibleRange, VisibleRange);
+	CandidateScratch.Reset();
+	ViewerGrid.QuerySphere(ShotBounds.GetCenter(), QueryRadius, CandidateScratch);
+
+	const ACharacter* Shooter = Weapon->GetOwningCharacter();
+	const AController* ShooterController = Shooter ? Shooter->GetController() : nullptr;
+	const float AudibleRangeSquared = FMath::Square(AudibleRange);
+	const float VisibleRangeSquared = FMath::Square(VisibleRange);
+
+	int32 NumRecipients = 0;
+	for (const int32 ViewerIndex : CandidateScratch) {
+		const FShotViewer& Viewer = Viewers[ViewerIndex];
+		UShotEventRelayComponent* Relay = Viewer.Relay.Get();
+		if (!Relay || Viewer.PlayerController == ShooterController) {
+			continue;
+		}
+
+		bool bInterested = FVector::DistSquared(Viewer.Location, Batch.Origin) <= AudibleRangeSquared;
+		for (int32 ShotIndex = 0; !bInterested && ShotIndex < Batch.Shots.Num(); ++ShotIndex) {
+			const FVector ShotEnd = Batch.Origin + Batch.Shots[ShotIndex].EndOffset;
+			bInterested = FMath::PointDistToSegmentSquared(Viewer.Location, Batch.Origin, ShotEnd) <= VisibleRangeSquared;
+		}
+
+		if (bInterested) {
+			Relay->ClientReceiveShotCosmetics(Weapon, Batch);
+			++NumRecipients;
+		}
+	}
+
+	return NumRecipients;
+}
+
+
+bool FShotInterestManager::IsObserved(UWorld* World, const FVector& ShotOrigin, const FVector& ShotEnd, float AudibleRange, float VisibleRange) {
+	RebuildViewerGrid(World);
+
+	const FVector QueryCenter = (ShotOrigin + ShotEnd) * 0.5f;
+	const float QueryRadius = FVector::Dist(ShotOrigin, ShotEnd) * 0.5f + FMath::Max(AudibleRange, VisibleRange);
+	CandidateScratch.Reset();
+	ViewerGrid.QuerySphere(QueryCenter, QueryRadius, CandidateScratch);
+
+	for (const int32 ViewerIndex : CandidateScratch) {
+		const FVector& ViewerLocation = Viewers[ViewerIndex].Location;
+		if (FVector::DistSquared(ViewerLocation, ShotOrigin) <= FMath::Square(AudibleRange)
+			|| FMath::PointDistToSegmentSquared(ViewerLocation, ShotOrigin, ShotEnd) <= FMath::Square(VisibleRange)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+/**
+ * Sends each viewer the areas with gunfire that are far enough from it.
+ *
+ * @note Viewers with nothing to hear get no RPC at all
+ */
+void FShotInterestManager::Tick(UWorld* World) {
+	const double CurrentTime = World->GetTimeSeconds();
+	if (CurrentTime < NextSummaryTime) {
+		return;
+	}
+	NextSummaryTime = CurrentTime + CVarDistantGunfireInterval.GetValueOnGameThread();
+
+	if (DistantGunfire.Num() == 0) {
+		return;
+	}
+
+	RebuildViewerGrid(World);
+
+	const float MinRangeSquared = FMath::Square(CVarDistantGunfireMinRange.GetValueOnGameThread());
+	TArray<FDistantGunfire> ViewerSummary;
+
+	for (const FShotViewer& Viewer : Viewers) {
+		UShotEventRelayComponent* Relay = Viewer.Relay.Get();
+		if (!Relay) {
+			continue;
+		}
+
+		ViewerSummary.Reset();
+		for (const TPair<FIntVector, FDistantGunfireArea>& AreaPair : DistantGunfire) {
+			const FDistantGunfireArea& Area = AreaPair.Value;
+			if (FVector::DistSquared(Viewer.Location, Area.Location) <= MinRangeSquared) {
+				continue;
+			}
+
+			FDistantGunfire& Entry = ViewerSummary.AddDefaulted_GetRef();
+			Entry.Location = Area.Location;
+			Entry.NumShots = static_cast<uint8>(FMath::Min(Area.NumShots, static_cast<int32>(MAX_uint8)));
+		}
+
+		if (ViewerSummary.Num() > 0) {
+			Relay->ClientReceiveDistantGunfire(ViewerSummary);
+		}
+	}
+
+	DistantGunfire.Reset();
+}
+
+
+void FShotInterestManager::Reset() {
+	Viewers.Reset();
+	ViewerGrid.Reset();
+	ViewerGridFrame = MAX_uint64;
+	DistantGunfire.Reset();
+	NextSummaryTime = 0.0;
+}
+
+
+/**
+ * Snapshots the view point of every player controller into the grid.
+ *
+ * @note Also makes sure every remote controller has a relay to send through
+ */
+void FShotInterestManager::RebuildViewerGrid(UWorld* World) {
+	if (ViewerGridFrame == GFrameCounter) {
+		return;
+	}
+	ViewerGridFrame = GFrameCounter;
+
+	Viewers.Reset();
+
+	const float CellSize = CVarShotViewerCellSize.GetValueOnGameThread();
+	if (!FMath::IsNearlyEqual(ViewerGrid.GetCellSize(), CellSize)) {
+		ViewerGrid.SetCellSize(CellSize);
+	} else {
+		ViewerGrid.Reset();
+	}
+
+	for (FConstPlayerControllerIterator ControllerIt = World->GetPlayerControllerIterator(); ControllerIt; ++ControllerIt) {
+		APlayerController* PlayerController = ControllerIt->Get();
+		if (!PlayerController) {
+			continue;
+		}
+
+		UShotEventRelayComponent* Relay = nullptr;
+		if (!PlayerController->IsLocalController()) {
+			Relay = UShotEventRelayComponent::FindOrAdd(PlayerController);
+			if (!Relay) {
+				continue;
+			}
+		}
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+		FShotViewer& Viewer = Viewers.AddDefaulted_GetRef();
+		Viewer.PlayerController = PlayerController;
+		Viewer.Relay = Relay;
+		Viewer.Location = ViewLocation;
+
+		ViewerGrid.Add(Viewers.Num() - 1, ViewLocation);
+	}
+}
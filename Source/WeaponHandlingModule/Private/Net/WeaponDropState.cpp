@@ -0,0 +1,59 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Net/WeaponDropState.h"
+
+namespace WeaponDropState {
+	// Locations are sent in tenths of a centimeter
+	constexpr int32 LocationScale = 10;
+}
+
+
+void FWeaponDropState::QuantizeRestPose() {
+	for (int32 Axis = 0; Axis < 3; ++Axis) {
+		RestLocation[Axis] = FMath::RoundToDouble(RestLocation[Axis] * WeaponDropState::LocationScale) / WeaponDropState::LocationScale;
+	}
+	RestRotation = FRotator(
+		FRotator::DecompressAxisFromShort(FRotator::CompressAxisToShort(RestRotation.Pitch)),
+		FRotator::DecompressAxisFromShort(FRotator::CompressAxisToShort(RestRotation.Yaw)),
+		FRotator::DecompressAxisFromShort(FRotator::CompressAxisToShort(RestRotation.Roll)));
+}
+
+
+/**
+ * Packs the drop ID and phase bit, then either the start or the rest state.
+ */
+bool FWeaponDropState::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess) {
+	bOutSuccess = true;
+
+	Ar << DropId;
+
+	uint8 bRest = bAtRest ? 1 : 0;
+	Ar.SerializeBits(&bRest, 1);
+	bAtRest = bRest != 0;
+
+	if (bAtRest) {
+		bOutSuccess &= SerializePackedVector<WeaponDropState::LocationScale, 30>(RestLocation, Ar);
+		RestRotation.SerializeCompressedShort(Ar);
+	} else {
+		bOutSuccess &= SerializePackedVector<WeaponDropState::LocationScale, 30>(StartLocation, Ar);
+		StartRotation.SerializeCompressedShort(Ar);
+		bOutSuccess &= SerializePackedVector<1, 24>(StartVelocity, Ar);
+	}
+
+	return true;
+}
+
+
+/**
+ * The rest pose is compared as quantized, the start state as the server set it.
+ */
+bool FWeaponDropState::operator==(const FWeaponDropState& Other) const {
+	if (DropId != Other.DropId || bAtRest != Other.bAtRest) {
+		return false;
+	}
+
+	if (bAtRest) {
+		return RestLocation == Other.RestLocation && RestRotation == Other.RestRotation;
+	}
+	return StartLocation == Other.StartLocation && StartRotation == Other.StartRotation && StartVelocity == Other.StartVelocity;
+}
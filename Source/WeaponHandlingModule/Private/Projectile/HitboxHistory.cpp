@@ -0,0 +1,138 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Projectile/HitboxHistory.h"
+
+#include "EngineUtils.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/Character.h"
+
+namespace HitboxHistory {
+	// Frames kept in the ring, roughly one second of history at 60 Hz
+	constexpr int32 MaxFrames = 64;
+}
+
+
+FHitboxHistory::FHitboxHistory() {
+	Frames.SetNum(HitboxHistory::MaxFrames);
+}
+
+
+/**
+ * Appends a snapshot of every character capsule to the ring.
+ *
+ * @note Frame storage is reused in place, so steady-state recording does not allocate
+ */
+void FHitboxHistory::Record(UWorld* World) {
+	// Hand slots of destroyed characters back for reuse
+	for (TMap<TWeakObjectPtr<AActor>, int32>::TIterator SlotIt = ActorSlots.CreateIterator(); SlotIt; ++SlotIt) {
+		if (!SlotIt->Key.IsValid()) {
+			FreeSlots.Add(SlotIt->Value);
+			SlotIt.RemoveCurrent();
+		}
+	}
+
+	NewestFrameIndex = (NewestFrameIndex + 1) % Frames.Num();
+	NumFrames = FMath::Min(NumFrames + 1, Frames.Num());
+
+	FHitboxFrame& Frame = Frames[NewestFrameIndex];
+	Frame.Time = World->GetTimeSeconds();
+	Frame.Capsules.Reset();
+	Frame.Capsules.SetNum(NumSlots);
+
+	for (TActorIterator<ACharacter> CharacterIt(World); CharacterIt; ++CharacterIt) {
+		ACharacter* Character = *CharacterIt;
+		UCapsuleComponent* CapsuleComponent = Character->GetCapsuleComponent();
+		if (!CapsuleComponent || Character->IsActorBeingDestroyed()) {
+			continue;
+		}
+
+		int32* Slot = ActorSlots.Find(Character);
+		if (!Slot) {
+			const int32 NewSlot = FreeSlots.Num() > 0 ? FreeSlots.Pop() : NumSlots++;
+			Slot = &ActorSlots.Add(Character, NewSlot);
+			Frame.Capsules.SetNum(NumSlots);
+		}
+
+		FHitboxCapsule& Capsule = Frame.Capsules[*Slot];
+		Capsule.Actor = Character;
+		Capsule.Component = CapsuleComponent;
+		Capsule.Center = CapsuleComponent->GetComponentLocation();
+		Capsule.UpAxis = CapsuleComponent->GetUpVector();
+		Capsule.Radius = CapsuleComponent->GetScaledCapsuleRadius();
+		Capsule.HalfHeight = CapsuleComponent->GetScaledCapsuleHalfHeight();
+	}
+}
+
+
+/**
+ * Interpolates capsules between the two frames surrounding Time.
+ *
+ * @note Slots that changed owner between the frames are not blended
+ */
+void FHitboxHistory::GetCapsulesAtTime(double Time, TArray<FHitboxCapsule, FWeaponFrameAllocator>& OutCapsules) const {
+	OutCapsules.Reset();
+	if (NumFrames == 0) {
+		return;
+	}
+
+	// Walk back from the newest frame to the first one recorded at or before Time
+	int32 OlderAge = 0;
+	while (OlderAge < NumFrames - 1 && GetFrame(OlderAge).Time > Time) {
+		++OlderAge;
+	}
+
+	const FHitboxFrame& OlderFrame = GetFrame(OlderAge);
+	const FHitboxFrame& NewerFrame = GetFrame(FMath::Max(OlderAge - 1, 0));
+	const double FrameSpan = NewerFrame.Time - OlderFrame.Time;
+	const float Alpha = FrameSpan > 0.0 ? FMath::Clamp(static_cast<float>((Time - OlderFrame.Time) / FrameSpan), 0.0f, 1.0f) : 0.0f;
+
+	const int32 NumCapsuleSlots = FMath::Max(OlderFrame.Capsules.Num(), NewerFrame.Capsules.Num());
+	OutCapsules.Reserve(NumCapsuleSlots);
+
+	for (int32 Slot = 0; Slot < NumCapsuleSlots; ++Slot) {
+		const FHitboxCapsule* OlderCapsule = OlderFrame.Capsules.IsValidIndex(Slot) && OlderFrame.Capsules[Slot].IsValid() ? &OlderFrame.Capsules[Slot] : nullptr;
+		const FHitboxCapsule* NewerCapsule = NewerFrame.Capsules.IsValidIndex(Slot) && NewerFrame.Capsules[Slot].IsValid() ? &NewerFrame.Capsules[Slot] : nullptr;
+
+		if (OlderCapsule && NewerCapsule && OlderCapsule->Actor == NewerCapsule->Actor) {
+			FHitboxCapsule& Capsule = OutCapsules.Add_GetRef(*OlderCapsule);
+			Capsule.Center = FMath::Lerp(OlderCapsule->Center, NewerCapsule->Center, Alpha);
+			Capsule.UpAxis = FMath::Lerp(OlderCapsule->UpAxis, NewerCapsule->UpAxis, Alpha).GetSafeNormal();
+		} else {
+			// Fall back to whichever frame is closer in time and actually has the capsule
+			const FHitboxCapsule* NearestCapsule = (Alpha < 0.5f && OlderCapsule) || !NewerCapsule ? OlderCapsule : NewerCapsule;
+			if (NearestCapsule) {
+				OutCapsules.Add(*NearestCapsule);
+			}
+		}
+	}
+}
+
+
+TConstArrayView<FHitboxCapsule> FHitboxHistory::GetNewestCapsules() const {
+	if (NumFrames == 0) {
+		return TConstArrayView<FHitboxCapsule>();
+	}
+	return GetFrame(0).Capsules;
+}
+
+
+double FHitboxHistory::GetHistoryDuration() const {
+	return NumFrames > 1 ? GetFrame(0).Time - GetFrame(NumFrames - 1).Time : 0.0;
+}
+
+
+void FHitboxHistory::Reset() {
+	for (FHitboxFrame& Frame : Frames) {
+		Frame.Capsules.Reset();
+	}
+	NewestFrameIndex = INDEX_NONE;
+	NumFrames = 0;
+	ActorSlots.Reset();
+	FreeSlots.Reset();
+	NumSlots = 0;
+}
+
+
+const FHitboxHistory::FHitboxFrame& FHitboxHistory::GetFrame(int32 Age) const {
+	return Frames[(NewestFrameIndex - Age + Frames.Num()) % Frames.Num()];
+}
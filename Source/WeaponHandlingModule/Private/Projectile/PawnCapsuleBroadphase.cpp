@@ -0,0 +1,251 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Projectile/PawnCapsuleBroadphase.h"
+
+#include "EngineUtils.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/Character.h"
+
+static TAutoConsoleVariable<float> CVarPawnCapsuleCellSize(
+	TEXT("weapon.Projectile.PawnCapsuleCellSize"),
+	500.0f,
+	TEXT("Edge length of a cell in the projectile character capsule grid (cm)."));
+
+namespace PawnCapsuleBroadphase {
+	/**
+	 * Tests a projectile segment against a capsule analytically.
+	 *
+	 * @param OutDistance Distance along the segment to the closest approach
+	 * @return True if the segment passes within the capsule radius
+	 */
+	bool IntersectSegmentCapsule(const FVector& Start, const FVector& End, const FHitboxCapsule& Capsule, float& OutDistance, FVector& OutImpactPoint, FVector& OutImpactNormal) {
+		const float CapsuleSegmentHalfLength = FMath::Max(Capsule.HalfHeight - Capsule.Radius, 0.0f);
+		const FVector CapsuleBottom = Capsule.Center - Capsule.UpAxis * CapsuleSegmentHalfLength;
+		const FVector CapsuleTop = Capsule.Center + Capsule.UpAxis * CapsuleSegmentHalfLength;
+
+		FVector ClosestOnProjectile;
+		FVector ClosestOnCapsule;
+		FMath::SegmentDistToSegmentSafe(Start, End, CapsuleBottom, CapsuleTop, ClosestOnProjectile, ClosestOnCapsule);
+
+		if (FVector::DistSquared(ClosestOnProjectile, ClosestOnCapsule) > FMath::Square(Capsule.Radius)) {
+			return false;
+		}
+
+		// Segment passing straight through the capsule axis has no separating direction
+		OutImpactNormal = (ClosestOnProjectile - ClosestOnCapsule).GetSafeNormal();
+		if (OutImpactNormal.IsZero()) {
+			OutImpactNormal = (Start - End).GetSafeNormal();
+		}
+		OutImpactPoint = ClosestOnCapsule + OutImpactNormal * Capsule.Radius;
+		OutDistance = FVector::Dist(Start, ClosestOnProjectile);
+		return true;
+	}
+
+	FORCEINLINE VectorRegister4Float Clamp01(const VectorRegister4Float& Value) {
+		return VectorMin(VectorMax(Value, VectorZeroFloat()), VectorOneFloat());
+	}
+
+	/**
+	 * Segment-vs-capsule overlap for four capsules at once.
+	 *
+	 * Clamped closest points between the projectile segment and each capsule's
+	 * inner segment, following the usual segment-segment derivation.
+	 *
+	 * @return Bit per lane set where the segment passes within the capsule radius
+	 */
+	int32 OverlapSegmentCapsules4(const FVector3f& Start, const FVector3f& Delta, const float* Bottom[3], const float* Axis[3], const float* RadiusSquared) {
+		const VectorRegister4Float Epsilon = VectorSetFloat1(UE_KINDA_SMALL_NUMBER);
+
+		const VectorRegister4Float DeltaX = VectorSetFloat1(Delta.X);
+		const VectorRegister4Float DeltaY = VectorSetFloat1(Delta.Y);
+		const VectorRegister4Float DeltaZ = VectorSetFloat1(Delta.Z);
+		const VectorRegister4Float A = VectorSetFloat1(FMath::Max(Delta.SizeSquared(), UE_KINDA_SMALL_NUMBER));
+
+		const VectorRegister4Float AxisX = VectorLoadAligned(Axis[0]);
+		const VectorRegister4Float AxisY = VectorLoadAligned(Axis[1]);
+		const VectorRegister4Float AxisZ = VectorLoadAligned(Axis[2]);
+
+		// Offset from each capsule bottom to the segment start
+		const VectorRegister4Float OffsetX = VectorSubtract(VectorSetFloat1(Start.X), VectorLoadAligned(Bottom[0]));
+		const VectorRegister4Float OffsetY = VectorSubtract(VectorSetFloat1(Start.Y), VectorLoadAligned(Bottom[1]));
+		const VectorRegister4Float OffsetZ = VectorSubtract(VectorSetFloat1(Start.Z), VectorLoadAligned(Bottom[2]));
+
+		const VectorRegister4Float B = VectorMultiplyAdd(DeltaX, AxisX, VectorMultiplyAdd(DeltaY, AxisY, VectorMultiply(DeltaZ, AxisZ)));
+		const VectorRegister4Float C = VectorMultiplyAdd(DeltaX, OffsetX, VectorMultiplyAdd(DeltaY, OffsetY, VectorMultiply(DeltaZ, OffsetZ)));
+		const VectorRegister4Float E = VectorMax(VectorMultiplyAdd(AxisX, AxisX, VectorMultiplyAdd(AxisY, AxisY, VectorMultiply(AxisZ, AxisZ))), Epsilon);
+		const VectorRegister4Float F = VectorMultiplyAdd(AxisX, OffsetX, VectorMultiplyAdd(AxisY, OffsetY, VectorMultiply(AxisZ, OffsetZ)));
+
+		// Parameter along the projectile, 0 where the segments are parallel
+		const VectorRegister4Float Denominator = VectorSubtract(VectorMultiply(A, E), VectorMultiply(B, B));
+		const VectorRegister4Float bParallel = VectorCompareLT(Denominator, Epsilon);
+		const VectorRegister4Float SafeDenominator = VectorSelect(bParallel, VectorOneFloat(), Denominator);
+		VectorRegister4Float S = VectorSelect(bParallel, VectorZeroFloat(), Clamp01(VectorDivide(VectorSubtract(VectorMultiply(B, F), VectorMultiply(C, E)), SafeDenominator)));
+
+		// Parameter along the capsule, then the projectile parameter closest to it
+		const VectorRegister4Float T = Clamp01(VectorDivide(VectorMultiplyAdd(B, S, F), E));
+		S = Clamp01(VectorDivide(VectorSubtract(VectorMultiply(B, T), C), A));
+
+		const VectorRegister4Float SeparationX = VectorSubtract(VectorMultiplyAdd(DeltaX, S, OffsetX), VectorMultiply(AxisX, T));
+		const VectorRegister4Float SeparationY = VectorSubtract(VectorMultiplyAdd(DeltaY, S, OffsetY), VectorMultiply(AxisY, T));
+		const VectorRegister4Float SeparationZ = VectorSubtract(VectorMultiplyAdd(DeltaZ, S, OffsetZ), VectorMultiply(AxisZ, T));
+		const VectorRegister4Float DistanceSquared = VectorMultiplyAdd(SeparationX, SeparationX, VectorMultiplyAdd(SeparationY, SeparationY, VectorMultiply(SeparationZ, SeparationZ)));
+
+		return VectorMaskBits(VectorCompareLE(DistanceSquared, VectorLoadAligned(RadiusSquared)));
+	}
+}
+
+
+void FPawnCapsuleBroadphase::Rebuild(UWorld* World) {
+	Capsules.Reset();
+
+	for (TActorIterator<ACharacter> CharacterIt(World); CharacterIt; ++CharacterIt) {
+		ACharacter* Character = *CharacterIt;
+		UCapsuleComponent* CapsuleComponent = Character->GetCapsuleComponent();
+		if (!CapsuleComponent || Character->IsActorBeingDestroyed()) {
+			continue;
+		}
+
+		FHitboxCapsule& Capsule = Capsules.AddDefaulted_GetRef();
+		Capsule.Actor = Character;
+		Capsule.Component = CapsuleComponent;
+		Capsule.Center = CapsuleComponent->GetComponentLocation();
+		Capsule.UpAxis = CapsuleComponent->GetUpVector();
+		Capsule.Radius = CapsuleComponent->GetScaledCapsuleRadius();
+		Capsule.HalfHeight = CapsuleComponent->GetScaledCapsuleHalfHeight();
+	}
+
+	BuildAcceleration();
+}
+
+
+void FPawnCapsuleBroadphase::Build(TConstArrayView<FHitboxCapsule> InCapsules) {
+	Capsules.Reset();
+	Capsules.Append(InCapsules.GetData(), InCapsules.Num());
+	BuildAcceleration();
+}
+
+
+/**
+ * Gathers grid candidates around the segment and tests them four at a time.
+ *
+ * @note Only lanes passing the SIMD test pay for the exact impact point and normal
+ * @remark Read-only, safe to call from any thread while nothing rebuilds
+ */
+bool FPawnCapsuleBroadphase::SweepSegment(const FVector& Start, const FVector& End, const AActor* IgnoredActor, FHitResult& OutHit) const {
+	if (Capsules.Num() == 0) {
+		return false;
+	}
+
+	// Runs inside the projectile integration task, so stay off the game thread frame arena
+	TArray<int32, TInlineAllocator<64>> Candidates;
+	Grid.QuerySphere((Start + End) * 0.5, FVector::Dist(Start, End) * 0.5f, Candidates);
+	if (Candidates.Num() == 0) {
+		return false;
+	}
+
+	// Capsules spanning several cells come back once per cell
+	Candidates.Sort();
+	int32 NumUnique = 1;
+	for (int32 CandidateIndex = 1; CandidateIndex < Candidates.Num(); ++CandidateIndex) {
+		if (Candidates[CandidateIndex] != Candidates[NumUnique - 1]) {
+			Candidates[NumUnique++] = Candidates[CandidateIndex];
+		}
+	}
+
+	const FVector3f Start3f(Start);
+	const FVector3f Delta3f(End - Start);
+
+	alignas(16) float LaneBottom[3][4];
+	alignas(16) float LaneAxis[3][4];
+	alignas(16) float LaneRadiusSquared[4];
+	const float* Bottom[3] = { LaneBottom[0], LaneBottom[1], LaneBottom[2] };
+	const float* Axis[3] = { LaneAxis[0], LaneAxis[1], LaneAxis[2] };
+
+	float ClosestDistance = TNumericLimits<float>::Max();
+	bool bHit = false;
+
+	for (int32 BatchStart = 0; BatchStart < NumUnique; BatchStart += 4) {
+		const int32 NumLanes = FMath::Min(NumUnique - BatchStart, 4);
+
+		for (int32 Lane = 0; Lane < 4; ++Lane) {
+			// Pad the last batch with a capsule nothing can hit
+			const int32 CapsuleIndex = Lane < NumLanes ? Candidates[BatchStart + Lane] : INDEX_NONE;
+			LaneBottom[0][Lane] = CapsuleIndex != INDEX_NONE ? BottomX[CapsuleIndex] : 0.0f;
+			LaneBottom[1][Lane] = CapsuleIndex != INDEX_NONE ? BottomY[CapsuleIndex] : 0.0f;
+			LaneBottom[2][Lane] = CapsuleIndex != INDEX_NONE ? BottomZ[CapsuleIndex] : 0.0f;
+			LaneAxis[0][Lane] = CapsuleIndex != INDEX_NONE ? AxisX[CapsuleIndex] : 0.0f;
+			LaneAxis[1][Lane] = CapsuleIndex != INDEX_NONE ? AxisY[CapsuleIndex] : 0.0f;
+			LaneAxis[2][Lane] = CapsuleIndex != INDEX_NONE ? AxisZ[CapsuleIndex] : 0.0f;
+			LaneRadiusSquared[Lane] = CapsuleIndex != INDEX_NONE ? RadiusSquared[CapsuleIndex] : -1.0f;
+		}
+
+		int32 LaneMask = PawnCapsuleBroadphase::OverlapSegmentCapsules4(Start3f, Delta3f, Bottom, Axis, LaneRadiusSquared);
+		while (LaneMask != 0) {
+			const int32 Lane = FMath::CountTrailingZeros(LaneMask);
+			LaneMask &= LaneMask - 1;
+
+			const FHitboxCapsule& Capsule = Capsules[Candidates[BatchStart + Lane]];
+			if (Capsule.Actor == IgnoredActor) {
+				continue;
+			}
+
+			float CapsuleDistance;
+			FVector ImpactPoint;
+			FVector ImpactNormal;
+			if (PawnCapsuleBroadphase::IntersectSegmentCapsule(Start, End, Capsule, CapsuleDistance, ImpactPoint, ImpactNormal) && CapsuleDistance < ClosestDistance) {
+				ClosestDistance = CapsuleDistance;
+				OutHit = FHitResult(Capsule.Actor.Get(), Capsule.Component.Get(), ImpactPoint, ImpactNormal);
+				OutHit.bBlockingHit = true;
+				OutHit.Distance = CapsuleDistance;
+				OutHit.TraceStart = Start;
+				OutHit.TraceEnd = End;
+				bHit = true;
+			}
+		}
+	}
+
+	return bHit;
+}
+
+
+void FPawnCapsuleBroadphase::Reset() {
+	Capsules.Reset();
+	BuildAcceleration();
+}
+
+
+void FPawnCapsuleBroadphase::BuildAcceleration() {
+	const int32 NumCapsules = Capsules.Num();
+	BottomX.SetNumUninitialized(NumCapsules);
+	BottomY.SetNumUninitialized(NumCapsules);
+	BottomZ.SetNumUninitialized(NumCapsules);
+	AxisX.SetNumUninitialized(NumCapsules);
+	AxisY.SetNumUninitialized(NumCapsules);
+	AxisZ.SetNumUninitialized(NumCapsules);
+	RadiusSquared.SetNumUninitialized(NumCapsules);
+
+	const float CellSize = CVarPawnCapsuleCellSize.GetValueOnGameThread();
+	if (!FMath::IsNearlyEqual(Grid.GetCellSize(), CellSize)) {
+		Grid.SetCellSize(CellSize);
+	} else {
+		Grid.Reset();
+	}
+
+	for (int32 CapsuleIndex = 0; CapsuleIndex < NumCapsules; ++CapsuleIndex) {
+		const FHitboxCapsule& Capsule = Capsules[CapsuleIndex];
+		const FVector HalfAxis = Capsule.UpAxis * FMath::Max(Capsule.HalfHeight - Capsule.Radius, 0.0f);
+		const FVector3f Bottom(Capsule.Center - HalfAxis);
+		const FVector3f Axis(HalfAxis * 2.0);
+
+		BottomX[CapsuleIndex] = Bottom.X;
+		BottomY[CapsuleIndex] = Bottom.Y;
+		BottomZ[CapsuleIndex] = Bottom.Z;
+		AxisX[CapsuleIndex] = Axis.X;
+		AxisY[CapsuleIndex] = Axis.Y;
+		AxisZ[CapsuleIndex] = Axis.Z;
+		RadiusSquared[CapsuleIndex] = FMath::Square(Capsule.Radius);
+
+		// Half height bounds the capsule at any orientation
+		Grid.AddBounds(CapsuleIndex, FBox(Capsule.Center - FVector(Capsule.HalfHeight), Capsule.Center + FVector(Capsule.HalfHeight)));
+	}
+}
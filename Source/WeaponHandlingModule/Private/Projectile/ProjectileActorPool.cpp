@@ -0,0 +1,146 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Projectile/ProjectileActorPool.h"
+
+#include "Engine/World.h"
+#include "HAL/PlatformTime.h"
+#include "Projectile/StaticOccupancyGrid.h"
+#include "Projectile/WeaponProjectileActor.h"
+#include "Trace/WeaponCsvStats.h"
+
+static TAutoConsoleVariable<bool> CVarProjectilePoolActors(
+	TEXT("weapon.Projectile.PoolActors"),
+	true,
+	TEXT("Reuse projectile actors instead of spawning and destroying one per shot."));
+
+static TAutoConsoleVariable<int32> CVarProjectileActorPoolMax(
+	TEXT("weapon.Projectile.ActorPoolMax"),
+	64,
+	TEXT("Dormant projectile actors kept per class, releases beyond that are destroyed."));
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Projectile actors spawned/s"), STAT_ProjectileActorsSpawnedPerSecond, STATGROUP_WeaponProjectile);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Projectile actors reused/s"), STAT_ProjectileActorsReusedPerSecond, STATGROUP_WeaponProjectile);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Projectile actors destroyed/s"), STAT_ProjectileActorsDestroyedPerSecond, STATGROUP_WeaponProjectile);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Dormant projectile actors"), STAT_ProjectileActorsDormant, STATGROUP_WeaponProjectile);
+DECLARE_FLOAT_ACCUMULATOR_STAT(TEXT("Last garbage collection (ms)"), STAT_ProjectileActorsLastGarbageCollectMs, STATGROUP_WeaponProjectile);
+
+namespace ProjectileActorPool {
+	// Out of sight until the first launch moves it
+	const FVector DormantLocation(0.0f, 0.0f, -100000.0f);
+}
+
+
+AWeaponProjectileActor* FProjectileActorPool::Acquire(UWorld* World, TSubclassOf<AWeaponProjectileActor> ActorClass) {
+	if (!ActorClass) {
+		return nullptr;
+	}
+
+	if (TArray<TWeakObjectPtr<AWeaponProjectileActor>>* Dormant = DormantActors.Find(ActorClass.Get())) {
+		while (Dormant->Num() > 0) {
+			AWeaponProjectileActor* Actor = Dormant->Pop(EAllowShrinking::No).Get();
+			if (Actor && !Actor->IsActorBeingDestroyed()) {
+				++Traffic.NumReused;
+				return Actor;
+			}
+		}
+	}
+
+	return SpawnDormant(World, ActorClass);
+}
+
+
+void FProjectileActorPool::Release(AWeaponProjectileActor* Actor) {
+	if (!Actor || Actor->IsActorBeingDestroyed()) {
+		return;
+	}
+
+	Actor->Deactivate();
+
+	TArray<TWeakObjectPtr<AWeaponProjectileActor>>& Dormant = DormantActors.FindOrAdd(Actor->GetClass());
+	if (!CVarProjectilePoolActors.GetValueOnGameThread() || Dormant.Num() >= CVarProjectileActorPoolMax.GetValueOnGameThread()) {
+		++Traffic.NumDestroyed;
+		CSV_WEAPON_COUNT(ProjectileActorsDestroyed, 1);
+		Actor->Destroy();
+		return;
+	}
+
+	Dormant.Add(Actor);
+}
+
+
+void FProjectileActorPool::Prewarm(UWorld* World, TSubclassOf<AWeaponProjectileActor> ActorClass, int32 Count) {
+	if (!ActorClass || !CVarProjectilePoolActors.GetValueOnGameThread()) {
+		return;
+	}
+
+	TArray<TWeakObjectPtr<AWeaponProjectileActor>>& Dormant = DormantActors.FindOrAdd(ActorClass.Get());
+	Dormant.RemoveAll([](const TWeakObjectPtr<AWeaponProjectileActor>& Actor) { return !Actor.IsValid(); });
+
+	const int32 TargetCount = FMath::Min(Count, CVarProjectileActorPoolMax.GetValueOnGameThread());
+	while (Dormant.Num() < TargetCount) {
+		AWeaponProjectileActor* Actor = SpawnDormant(World, ActorClass);
+		if (!Actor) {
+			break;
+		}
+		Dormant.Add(Actor);
+	}
+}
+
+
+void FProjectileActorPool::Tick(const UWorld* World) {
+	const double CurrentTime = World->GetRealTimeSeconds();
+	if (CurrentTime - Traffic.WindowStartTime < 1.0) {
+		return;
+	}
+
+	const double WindowDuration = CurrentTime - Traffic.WindowStartTime;
+	SET_DWORD_STAT(STAT_ProjectileActorsSpawnedPerSecond, FMath::RoundToInt(Traffic.NumSpawned / WindowDuration));
+	SET_DWORD_STAT(STAT_ProjectileActorsReusedPerSecond, FMath::RoundToInt(Traffic.NumReused / WindowDuration));
+	SET_DWORD_STAT(STAT_ProjectileActorsDestroyedPerSecond, FMath::RoundToInt(Traffic.NumDestroyed / WindowDuration));
+
+	SET_DWORD_STAT(STAT_ProjectileActorsDormant, NumDormant());
+
+	Traffic = FPoolTraffic();
+	Traffic.WindowStartTime = CurrentTime;
+}
+
+
+void FProjectileActorPool::OnPreGarbageCollect() {
+	GarbageCollectStartTime = FPlatformTime::Seconds();
+}
+
+
+void FProjectileActorPool::OnPostGarbageCollect() {
+	SET_FLOAT_STAT(STAT_ProjectileActorsLastGarbageCollectMs, (FPlatformTime::Seconds() - GarbageCollectStartTime) * 1000.0);
+}
+
+
+void FProjectileActorPool::Reset() {
+	DormantActors.Reset();
+	Traffic = FPoolTraffic();
+}
+
+
+int32 FProjectileActorPool::NumDormant() const {
+	int32 Count = 0;
+	for (const TPair<TObjectKey<UClass>, TArray<TWeakObjectPtr<AWeaponProjectileActor>>>& Pair : DormantActors) {
+		Count += Pair.Value.Num();
+	}
+	return Count;
+}
+
+
+AWeaponProjectileActor* FProjectileActorPool::SpawnDormant(UWorld* World, UClass* ActorClass) {
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParams.ObjectFlags |= RF_Transient;
+
+	AWeaponProjectileActor* Actor = World->SpawnActor<AWeaponProjectileActor>(ActorClass, ProjectileActorPool::DormantLocation, FRotator::ZeroRotator, SpawnParams);
+	if (Actor) {
+		Actor->Deactivate();
+		++Traffic.NumSpawned;
+		CSV_WEAPON_COUNT(ProjectileActorsSpawned, 1);
+	}
+
+	return Actor;
+}
@@ -0,0 +1,178 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Projectile/ProjectileHoming.h"
+
+#include "Projectile/PawnCapsuleBroadphase.h"
+#include "Projectile/ProjectileSimulation.h"
+
+static TAutoConsoleVariable<int32> CVarProjectileHomingReacquireFrames(
+	TEXT("weapon.Projectile.HomingReacquireFrames"),
+	6,
+	TEXT("Frames between target searches of one homing projectile, searches are spread evenly over rounds."));
+
+namespace ProjectileHoming {
+	FORCEINLINE VectorRegister4Float Dot3(const VectorRegister4Float& AX, const VectorRegister4Float& AY, const VectorRegister4Float& AZ,
+		const VectorRegister4Float& BX, const VectorRegister4Float& BY, const VectorRegister4Float& BZ) {
+		return VectorMultiplyAdd(AX, BX, VectorMultiplyAdd(AY, BY, VectorMultiply(AZ, BZ)));
+	}
+}
+
+
+void FProjectileHoming::UpdateTargets(const FPawnCapsuleBroadphase& Broadphase, const FInFlightView& InFlight) {
+	const TConstArrayView<FHitboxCapsule> Capsules = Broadphase.GetCapsules();
+
+	TargetCapsules.Reset();
+	for (int32 CapsuleIndex = 0; CapsuleIndex < Capsules.Num(); ++CapsuleIndex) {
+		TargetCapsules.Add(FObjectKey(Capsules[CapsuleIndex].Actor.Get()), CapsuleIndex);
+	}
+
+	const uint32 ReacquireFrames = static_cast<uint32>(FMath::Max(CVarProjectileHomingReacquireFrames.GetValueOnGameThread(), 1));
+	++FrameCounter;
+
+	for (int32 Index = 0; Index < InFlight.Positions.Num(); ++Index) {
+		const FProjectileDefinition& Definition = InFlight.Definitions[InFlight.DefinitionIndices[Index]];
+		if (Definition.HomingAcceleration <= 0.0f) {
+			continue;
+		}
+
+		// Indices shift when rounds are removed, which only nudges the rotation
+		if ((static_cast<uint32>(Index) + FrameCounter) % ReacquireFrames == 0) {
+			InFlight.Targets[Index] = AcquireTarget(Broadphase, Definition, InFlight.Positions[Index], InFlight.Velocities[Index], InFlight.IgnoredActors[Index].Get());
+		}
+
+		if (InFlight.Targets[Index] == FObjectKey()) {
+			continue;
+		}
+
+		// A target that left the capsule list is lost until the next search
+		if (const int32* CapsuleIndex = TargetCapsules.Find(InFlight.Targets[Index])) {
+			InFlight.AimPoints[Index] = Capsules[*CapsuleIndex].Center;
+		} else {
+			InFlight.Targets[Index] = FObjectKey();
+		}
+	}
+}
+
+
+/**
+ * Rotates each velocity towards the aim point by at most acceleration times step time.
+ *
+ * @remark Only the part of the aim direction perpendicular to the velocity is applied,
+ *         then the velocity is rescaled to its original speed
+ */
+void FProjectileHoming::Steer(const FInFlightView& InFlight, float StepTime) {
+	SteeredIndices.Reset();
+	for (int32 Index = 0; Index < InFlight.Positions.Num(); ++Index) {
+		if (InFlight.Targets[Index] != FObjectKey()) {
+			SteeredIndices.Add(Index);
+		}
+	}
+
+	const VectorRegister4Float Epsilon = VectorSetFloat1(UE_KINDA_SMALL_NUMBER);
+
+	alignas(16) float LaneVelocity[3][4];
+	alignas(16) float LaneAim[3][4];
+	alignas(16) float LaneMaxTurn[4];
+
+	for (int32 BatchStart = 0; BatchStart < SteeredIndices.Num(); BatchStart += 4) {
+		const int32 NumLanes = FMath::Min(SteeredIndices.Num() - BatchStart, 4);
+
+		for (int32 Lane = 0; Lane < 4; ++Lane) {
+			// Pad the last batch with rounds that cannot turn
+			const int32 Index = Lane < NumLanes ? SteeredIndices[BatchStart + Lane] : INDEX_NONE;
+			const FVector3f Velocity = Index != INDEX_NONE ? FVector3f(InFlight.Velocities[Index]) : FVector3f::ForwardVector;
+			const FVector3f Aim = Index != INDEX_NONE ? FVector3f(InFlight.AimPoints[Index] - InFlight.Positions[Index]) : FVector3f::ForwardVector;
+
+			LaneVelocity[0][Lane] = Velocity.X;
+			LaneVelocity[1][Lane] = Velocity.Y;
+			LaneVelocity[2][Lane] = Velocity.Z;
+			LaneAim[0][Lane] = Aim.X;
+			LaneAim[1][Lane] = Aim.Y;
+			LaneAim[2][Lane] = Aim.Z;
+			LaneMaxTurn[Lane] = Index != INDEX_NONE ? InFlight.Definitions[InFlight.DefinitionIndices[Index]].HomingAcceleration * StepTime : 0.0f;
+		}
+
+		const VectorRegister4Float VelocityX = VectorLoadAligned(LaneVelocity[0]);
+		const VectorRegister4Float VelocityY = VectorLoadAligned(LaneVelocity[1]);
+		const VectorRegister4Float VelocityZ = VectorLoadAligned(LaneVelocity[2]);
+		const VectorRegister4Float Speed = VectorSqrt(VectorMax(ProjectileHoming::Dot3(VelocityX, VelocityY, VelocityZ, VelocityX, VelocityY, VelocityZ), Epsilon));
+		const VectorRegister4Float InvSpeed = VectorReciprocal(Speed);
+
+		const VectorRegister4Float AimX = VectorLoadAligned(LaneAim[0]);
+		const VectorRegister4Float AimY = VectorLoadAligned(LaneAim[1]);
+		const VectorRegister4Float AimZ = VectorLoadAligned(LaneAim[2]);
+		const VectorRegister4Float InvAimLength = VectorReciprocalSqrt(VectorMax(ProjectileHoming::Dot3(AimX, AimY, AimZ, AimX, AimY, AimZ), Epsilon));
+
+		const VectorRegister4Float ForwardX = VectorMultiply(VelocityX, InvSpeed);
+		const VectorRegister4Float ForwardY = VectorMultiply(VelocityY, InvSpeed);
+		const VectorRegister4Float ForwardZ = VectorMultiply(VelocityZ, InvSpeed);
+		const VectorRegister4Float DirectionX = VectorMultiply(AimX, InvAimLength);
+		const VectorRegister4Float DirectionY = VectorMultiply(AimY, InvAimLength);
+		const VectorRegister4Float DirectionZ = VectorMultiply(AimZ, InvAimLength);
+
+		// Aim direction without its component along the current heading
+		const VectorRegister4Float Along = ProjectileHoming::Dot3(DirectionX, DirectionY, DirectionZ, ForwardX, ForwardY, ForwardZ);
+		const VectorRegister4Float LateralX = VectorNegateMultiplyAdd(ForwardX, Along, DirectionX);
+		const VectorRegister4Float LateralY = VectorNegateMultiplyAdd(ForwardY, Along, DirectionY);
+		const VectorRegister4Float LateralZ = VectorNegateMultiplyAdd(ForwardZ, Along, DirectionZ);
+		const VectorRegister4Float LateralLength = VectorSqrt(VectorMax(ProjectileHoming::Dot3(LateralX, LateralY, LateralZ, LateralX, LateralY, LateralZ), Epsilon));
+
+		// Velocity change that would point straight at the target, capped by the turn rate
+		const VectorRegister4Float Turn = VectorMin(VectorMultiply(LateralLength, Speed), VectorLoadAligned(LaneMaxTurn));
+		const VectorRegister4Float TurnScale = VectorDivide(Turn, LateralLength);
+
+		const VectorRegister4Float NewVelocityX = VectorMultiplyAdd(LateralX, TurnScale, VelocityX);
+		const VectorRegister4Float NewVelocityY = VectorMultiplyAdd(LateralY, TurnScale, VelocityY);
+		const VectorRegister4Float NewVelocityZ = VectorMultiplyAdd(LateralZ, TurnScale, VelocityZ);
+		const VectorRegister4Float SpeedScale = VectorMultiply(Speed, VectorReciprocalSqrt(VectorMax(ProjectileHoming::Dot3(NewVelocityX, NewVelocityY, NewVelocityZ, NewVelocityX, NewVelocityY, NewVelocityZ), Epsilon)));
+
+		VectorStoreAligned(VectorMultiply(NewVelocityX, SpeedScale), LaneVelocity[0]);
+		VectorStoreAligned(VectorMultiply(NewVelocityY, SpeedScale), LaneVelocity[1]);
+		VectorStoreAligned(VectorMultiply(NewVelocityZ, SpeedScale), LaneVelocity[2]);
+
+		for (int32 Lane = 0; Lane < NumLanes; ++Lane) {
+			InFlight.Velocities[SteeredIndices[BatchStart + Lane]] = FVector(LaneVelocity[0][Lane], LaneVelocity[1][Lane], LaneVelocity[2][Lane]);
+		}
+	}
+}
+
+
+void FProjectileHoming::Reset() {
+	TargetCapsules.Reset();
+	SteeredIndices.Reset();
+	FrameCounter = 0;
+}
+
+
+/**
+ * Scores candidates by distance within the definition's seeker range and cone.
+ */
+FObjectKey FProjectileHoming::AcquireTarget(const FPawnCapsuleBroadphase& Broadphase, const FProjectileDefinition& Definition, const FVector& Position, const FVector& Velocity, const AActor* IgnoredActor) const {
+	TArray<int32, TInlineAllocator<32>> Candidates;
+	Broadphase.QuerySphere(Position, Definition.HomingRange, Candidates);
+
+	const TConstArrayView<FHitboxCapsule> Capsules = Broadphase.GetCapsules();
+	const FVector Forward = Velocity.GetSafeNormal();
+	const float RangeSquared = FMath::Square(Definition.HomingRange);
+
+	float ClosestDistanceSquared = RangeSquared;
+	FObjectKey Target;
+
+	for (const int32 CapsuleIndex : Candidates) {
+		const FHitboxCapsule& Capsule = Capsules[CapsuleIndex];
+		if (Capsule.Actor == IgnoredActor) {
+			continue;
+		}
+
+		const FVector ToCapsule = Capsule.Center - Position;
+		const float DistanceSquared = ToCapsule.SizeSquared();
+		if (DistanceSquared >= ClosestDistanceSquared || (ToCapsule | Forward) < Definition.HomingConeCos * FMath::Sqrt(DistanceSquared)) {
+			continue;
+		}
+
+		ClosestDistanceSquared = DistanceSquared;
+		Target = FObjectKey(Capsule.Actor.Get());
+	}
+
+	return Target;
+}
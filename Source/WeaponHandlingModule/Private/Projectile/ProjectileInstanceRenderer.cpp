@@ -0,0 +1,141 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Projectile/ProjectileInstanceRenderer.h"
+
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "Projectile/ProjectileSimulation.h"
+
+static TAutoConsoleVariable<bool> CVarProjectileInstancedVisuals(
+	TEXT("weapon.Projectile.InstancedVisuals"),
+	true,
+	TEXT("Draw in-flight projectiles as instances of their definition's mesh."));
+
+
+/**
+ * Buckets projectiles by definition and pushes one transform batch per component.
+ *
+ * @note One linear pass over the simulation arrays plus one batch update per definition
+ * @remark Rounds are drawn where they will be at the end of the frame, along their current velocity
+ */
+void FProjectileInstanceRenderer::Update(UWorld* World, const FProjectileSimulation& ProjectileSimulation, float ExtrapolationTime) {
+	if (World->GetNetMode() == NM_DedicatedServer) {
+		return;
+	}
+
+	if (!CVarProjectileInstancedVisuals.GetValueOnGameThread()) {
+		if (Batches.Num() > 0) {
+			Reset();
+		}
+		return;
+	}
+
+	Batches.SetNum(FMath::Max(Batches.Num(), ProjectileSimulation.NumDefinitions()));
+	for (FProjectileInstanceBatch& Batch : Batches) {
+		Batch.Transforms.Reset();
+	}
+
+	const TArray<FVector>& Positions = ProjectileSimulation.GetPositions();
+	const TArray<FVector>& Velocities = ProjectileSimulation.GetVelocities();
+	const TArray<int32>& DefinitionIndices = ProjectileSimulation.GetDefinitionIndices();
+
+	for (int32 Index = 0; Index < Positions.Num(); ++Index) {
+		const FProjectileDefinition& Definition = ProjectileSimulation.GetDefinition(DefinitionIndices[Index]);
+		if (Definition.Mesh.IsValid()) {
+			Batches[DefinitionIndices[Index]].Transforms.Emplace(Velocities[Index].ToOrientationQuat(), Positions[Index] + Velocities[Index] * ExtrapolationTime, Definition.MeshScale);
+		}
+	}
+
+	for (int32 DefinitionIndex = 0; DefinitionIndex < Batches.Num(); ++DefinitionIndex) {
+		FProjectileInstanceBatch& Batch = Batches[DefinitionIndex];
+
+		// Definitions never drawn yet do not get a component until they are
+		UInstancedStaticMeshComponent* Component = Batch.Transforms.Num() > 0 ? FindOrAddComponent(World, ProjectileSimulation, DefinitionIndex) : Batch.Component.Get();
+		if (!Component) {
+			continue;
+		}
+
+		SyncInstanceCount(Component, Batch.Transforms.Num());
+		if (Batch.Transforms.Num() > 0) {
+			Component->BatchUpdateInstancesTransforms(0, Batch.Transforms, false, true, true);
+		}
+	}
+}
+
+
+void FProjectileInstanceRenderer::Reset() {
+	// A world being torn down destroys the host itself
+	AActor* Host = HostActor.Get();
+	if (Host && !Host->GetWorld()->bIsTearingDown) {
+		Host->Destroy();
+	}
+	HostActor.Reset();
+	Batches.Reset();
+}
+
+
+/**
+ * Creates a render-only instanced component for a definition's mesh.
+ *
+ * @note The host actor sits at the origin, so instance space is world space
+ */
+UInstancedStaticMeshComponent* FProjectileInstanceRenderer::FindOrAddComponent(UWorld* World, const FProjectileSimulation& ProjectileSimulation, int32 DefinitionIndex) {
+	FProjectileInstanceBatch& Batch = Batches[DefinitionIndex];
+	if (UInstancedStaticMeshComponent* Component = Batch.Component.Get()) {
+		return Component;
+	}
+
+	AActor* Host = HostActor.Get();
+	if (!Host) {
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.Name = MakeUniqueObjectName(World->GetCurrentLevel(), AActor::StaticClass(), TEXT("ProjectileInstanceHost"));
+		SpawnParameters.ObjectFlags = RF_Transient;
+		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+		Host = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParameters);
+		if (!Host) {
+			return nullptr;
+		}
+		HostActor = Host;
+	}
+
+	UInstancedStaticMeshComponent* Component = NewObject<UInstancedStaticMeshComponent>(Host, NAME_None, RF_Transient);
+	Component->SetStaticMesh(ProjectileSimulation.GetDefinition(DefinitionIndex).Mesh.Get());
+	Component->SetMobility(EComponentMobility::Movable);
+	Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Component->SetCanEverAffectNavigation(false);
+	Component->SetCastShadow(false);
+	Component->SetGenerateOverlapEvents(false);
+	Component->RegisterComponent();
+	Host->AddInstanceComponent(Component);
+
+	if (!Host->GetRootComponent()) {
+		Host->SetRootComponent(Component);
+	}
+
+	Batch.Component = Component;
+	return Component;
+}
+
+
+/**
+ * Adds or removes instances at the end of the component.
+ *
+ * @note Capacity only changes when the number of rounds in flight does - steady fire costs nothing here
+ */
+void FProjectileInstanceRenderer::SyncInstanceCount(UInstancedStaticMeshComponent* Component, int32 NumInstances) {
+	const int32 CurrentCount = Component->GetInstanceCount();
+
+	if (CurrentCount < NumInstances) {
+		TArray<FTransform> NewInstances;
+		NewInstances.Init(FTransform::Identity, NumInstances - CurrentCount);
+		Component->AddInstances(NewInstances, false, false, false);
+	} else if (CurrentCount > NumInstances) {
+		RemovedInstances.Reset();
+		for (int32 InstanceIndex = CurrentCount - 1; InstanceIndex >= NumInstances; --InstanceIndex) {
+			RemovedInstances.Add(InstanceIndex);
+		}
+		Component->RemoveInstances(RemovedInstances, true);
+	}
+}
@@ -0,0 +1,461 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Projectile/ProjectileSimulation.h"
+
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "Projectile/HitboxHistory.h"
+#include "Trace/WeaponCsvStats.h"
+
+static TAutoConsoleVariable<float> CVarProjectileMaxCatchUpMs(
+	TEXT("weapon.Projectile.MaxCatchUpMs"),
+	200.0f,
+	TEXT("Hard cap on how far a client-fired projectile is fast-forwarded on the server (ms)."));
+
+static TAutoConsoleVariable<float> CVarProjectileCatchUpStepMs(
+	TEXT("weapon.Projectile.CatchUpStepMs"),
+	16.0f,
+	TEXT("Length of one rewound time slice during projectile catch-up (ms)."));
+
+static TAutoConsoleVariable<bool> CVarProjectileAsyncIntegrate(
+	TEXT("weapon.Sim.AsyncProjectiles"),
+	true,
+	TEXT("Integrate projectiles on a worker, overlapping the rest of the frame."));
+
+static TAutoConsoleVariable<bool> CVarProjectileUseStaticOccupancy(
+	TEXT("weapon.Projectile.UseStaticOccupancy"),
+	true,
+	TEXT("Skip static world sweeps for projectile segments through baked free space."));
+
+static TAutoConsoleVariable<bool> CVarProjectileOccupancySkipsDynamic(
+	TEXT("weapon.Projectile.OccupancySkipsDynamic"),
+	false,
+	TEXT("Also skip the dynamic world sweep in baked free space. Only safe on maps where moving world geometry never stops rounds."));
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectile sweeps"), STAT_ProjectileSweeps, STATGROUP_WeaponProjectile);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectile static sweeps skipped"), STAT_ProjectileStaticSweepsSkipped, STATGROUP_WeaponProjectile);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectile world geometry sweeps skipped"), STAT_ProjectileSweepsSkipped, STATGROUP_WeaponProjectile);
+
+static TAutoConsoleVariable<float> CVarProjectileMaxSubstep(
+	TEXT("weapon.Projectile.MaxSubstep"),
+	1.0f / 30.0f,
+	TEXT("Longest integration step for in-flight projectiles, longer frames are split (seconds)."));
+
+namespace ProjectileSimulation {
+	/**
+	 * Advances one projectile under gravity and quadratic drag with semi-implicit Euler.
+	 *
+	 * @param Wind Air velocity around the projectile, drag acts on the velocity relative to it
+	 */
+	FORCEINLINE void StepBallistics(const FProjectileDefinition& Definition, const FVector& Position, const FVector& Velocity, const FVector& Wind, float StepTime, FVector& OutPosition, FVector& OutVelocity) {
+		const FVector AirVelocity = Velocity - Wind;
+		const FVector Acceleration = FVector(0.0f, 0.0f, Definition.GravityZ) - AirVelocity * (Definition.DragCoefficient * AirVelocity.Size());
+		OutVelocity = Velocity + Acceleration * StepTime;
+		OutPosition = Position + OutVelocity * StepTime;
+	}
+
+	/**
+	 * Adds the object types of everything but world geometry that projectiles can hit.
+	 *
+	 * @note Characters are among them, TraceScene() leaves those to the capsule broadphase
+	 */
+	void AddActorObjectTypes(FCollisionObjectQueryParams& ObjectParams) {
+		ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
+		ObjectParams.AddObjectTypesToQuery(ECC_PhysicsBody);
+		ObjectParams.AddObjectTypesToQuery(ECC_Vehicle);
+	}
+
+	/**
+	 * Finds the closest scene hit along a segment that is not a character.
+	 *
+	 * @param SceneHits Scratch for the multi trace, reused between calls
+	 * @return True if anything but a character was hit
+	 *
+	 * @note Characters are tested against the capsule broadphase, rewound during catch-up,
+	 *       so their current capsules must neither hit nor shadow what lies behind them
+	 */
+	bool TraceScene(const UWorld* World, const FVector& Start, const FVector& End, const FCollisionObjectQueryParams& ObjectParams, const FCollisionQueryParams& QueryParams, TArray<FHitResult>& SceneHits, FHitResult& OutHit) {
+		SceneHits.Reset();
+		World->LineTraceMultiByObjectType(SceneHits, Start, End, ObjectParams, QueryParams);
+
+		// Sorted by distance
+		for (const FHitResult& SceneHit : SceneHits) {
+			if (!Cast<ACharacter>(SceneHit.GetActor())) {
+				OutHit = SceneHit;
+				OutHit.bBlockingHit = true;
+				return true;
+			}
+		}
+		return false;
+	}
+}
+
+
+int32 FProjectileSimulation::RegisterDefinition(const FProjectileDefinition& Definition) {
+	// The integration task reads definitions
+	WaitForIntegrate();
+
+	bHasHomingDefinitions |= Definition.IsHoming();
+
+	const int32 ExistingIndex = Definitions.IndexOfByKey(Definition);
+	return ExistingIndex != INDEX_NONE ? ExistingIndex : Definitions.Add(Definition);
+}
+
+
+/**
+ * Holds a projectile for the next catch-up pass.
+ *
+ * @note Catch-up is capped here so a high ping cannot buy unbounded server work
+ * @remark Never touches in-flight state, so it is safe while the integration task runs
+ */
+void FProjectileSimulation::Launch(const FProjectileLaunchParams& LaunchParams) {
+	if (!Definitions.IsValidIndex(LaunchParams.DefinitionIndex)) {
+		return;
+	}
+
+	const FProjectileDefinition& Definition = Definitions[LaunchParams.DefinitionIndex];
+	const FVector Velocity = LaunchParams.Direction.GetSafeNormal() * Definition.MuzzleSpeed;
+
+	const float MaxCatchUpTime = FMath::Max(CVarProjectileMaxCatchUpMs.GetValueOnGameThread() * 0.001f, 0.0f);
+
+	FCatchUpProjectile& CatchUpProjectile = PendingCatchUp.AddDefaulted_GetRef();
+	CatchUpProjectile.LaunchParams = LaunchParams;
+	CatchUpProjectile.LaunchParams.CatchUpTime = FMath::Clamp(LaunchParams.CatchUpTime, 0.0f, MaxCatchUpTime);
+	CatchUpProjectile.Position = LaunchParams.Origin;
+	CatchUpProjectile.Velocity = Velocity;
+}
+
+
+/**
+ * Fast-forwards newly launched projectiles through rewound time slices.
+ *
+ * Slices run from the oldest launch towards the present. Each slice rewinds
+ * character capsules once and advances every projectile already fired at that
+ * point, so the cost is slices + projectiles rather than slices * projectiles
+ * hitbox reconstructions.
+ *
+ * @note Characters are tested analytically against their rewound capsules, the
+ *       scene query sees world geometry and every other pawn, vehicle and physics body
+ * @remark Projectiles without catch-up time skip every slice and go straight into flight
+ */
+void FProjectileSimulation::RunCatchUp(UWorld* World, const FHitboxHistory& HitboxHistory, TArray<FProjectileImpact>& OutImpacts) {
+	if (PendingCatchUp.Num() == 0) {
+		return;
+	}
+	WaitForIntegrate();
+
+	// Never rewind past the recorded history
+	const float HistoryDuration = static_cast<float>(HitboxHistory.GetHistoryDuration());
+	float LongestCatchUpTime = 0.0f;
+	for (FCatchUpProjectile& CatchUpProjectile : PendingCatchUp) {
+		CatchUpProjectile.LaunchParams.CatchUpTime = FMath::Min(CatchUpProjectile.LaunchParams.CatchUpTime, HistoryDuration);
+		LongestCatchUpTime = FMath::Max(LongestCatchUpTime, CatchUpProjectile.LaunchParams.CatchUpTime);
+	}
+
+	const double CurrentTime = World->GetTimeSeconds();
+	const float SliceLength = FMath::Max(CVarProjectileCatchUpStepMs.GetValueOnGameThread() * 0.001f, 0.001f);
+
+	FCollisionObjectQueryParams WorldObjectParams;
+	WorldObjectParams.AddObjectTypesToQuery(ECC_WorldStatic);
+	WorldObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
+	ProjectileSimulation::AddActorObjectTypes(WorldObjectParams);
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ProjectileCatchUp), false);
+	TArray<FHitResult> SceneHits;
+
+	FWeaponFrameArenaMark ArenaMark;
+	TArray<FHitboxCapsule, FWeaponFrameAllocator> RewoundCapsules;
+	int32 NumTraces = 0;
+
+	// Seconds before now at which the current slice begins
+	float SliceStart = LongestCatchUpTime;
+	while (SliceStart > KINDA_SMALL_NUMBER) {
+		const float SliceEnd = FMath::Max(SliceStart - SliceLength, 0.0f);
+		HitboxHistory.GetCapsulesAtTime(CurrentTime - SliceStart, RewoundCapsules);
+		CatchUpBroadphase.Build(RewoundCapsules);
+
+		for (FCatchUpProjectile& CatchUpProjectile : PendingCatchUp) {
+			// Already resolved, or fired after this slice
+			if (CatchUpProjectile.bFinished || CatchUpProjectile.LaunchParams.CatchUpTime <= SliceEnd) {
+				continue;
+			}
+
+			const FProjectileDefinition& Definition = Definitions[CatchUpProjectile.LaunchParams.DefinitionIndex];
+			const float StepTime = FMath::Min(SliceStart, CatchUpProjectile.LaunchParams.CatchUpTime) - SliceEnd;
+
+			FVector NewPosition;
+			FVector NewVelocity;
+			ProjectileSimulation::StepBallistics(Definition, CatchUpProjectile.Position, CatchUpProjectile.Velocity, WindField.Sample(CatchUpProjectile.Position), StepTime, NewPosition, NewVelocity);
+
+			FHitResult ClosestHit;
+			CatchUpBroadphase.SweepSegment(CatchUpProjectile.Position, NewPosition, CatchUpProjectile.LaunchParams.IgnoredActor.Get(), ClosestHit);
+			float ClosestDistance = ClosestHit.bBlockingHit ? ClosestHit.Distance : TNumericLimits<float>::Max();
+
+			QueryParams.ClearIgnoredActors();
+			QueryParams.AddIgnoredActor(CatchUpProjectile.LaunchParams.IgnoredActor.Get());
+			QueryParams.AddIgnoredActor(CatchUpProjectile.LaunchParams.DamageCauser.Get());
+
+			FHitResult WorldHit;
+			++NumTraces;
+			if (ProjectileSimulation::TraceScene(World, CatchUpProjectile.Position, NewPosition, WorldObjectParams, QueryParams, SceneHits, WorldHit) && WorldHit.Distance < ClosestDistance) {
+				ClosestDistance = WorldHit.Distance;
+				ClosestHit = WorldHit;
+			}
+
+			if (ClosestHit.bBlockingHit) {
+				FProjectileImpact& Impact = OutImpacts.AddDefaulted_GetRef();
+				Impact.HitResult = ClosestHit;
+				Impact.DefinitionIndex = CatchUpProjectile.LaunchParams.DefinitionIndex;
+				Impact.DamageCauser = CatchUpProjectile.LaunchParams.DamageCauser;
+				Impact.InstigatorController = CatchUpProjectile.LaunchParams.InstigatorController;
+				CatchUpProjectile.bFinished = true;
+				continue;
+			}
+
+			CatchUpProjectile.Position = NewPosition;
+			CatchUpProjectile.Velocity = NewVelocity;
+			CatchUpProjectile.FlightTime += StepTime;
+			CatchUpProjectile.bFinished = CatchUpProjectile.FlightTime >= Definition.MaxFlightTime;
+		}
+
+		SliceStart = SliceEnd;
+	}
+
+	CatchUpBroadphase.Reset();
+	CSV_WEAPON_COUNT(Traces, NumTraces);
+
+	// Survivors are now in the present and continue as regular projectiles
+	for (const FCatchUpProjectile& CatchUpProjectile : PendingCatchUp) {
+		if (!CatchUpProjectile.bFinished) {
+			AddInFlight(CatchUpProjectile.Position, CatchUpProjectile.Velocity, CatchUpProjectile.FlightTime, CatchUpProjectile.LaunchParams);
+		}
+	}
+	PendingCatchUp.Reset();
+}
+
+
+/**
+ * Moves every in-flight projectile and sweeps the covered segment.
+ *
+ * @note Long frames are split into substeps so trajectories stay curved
+ */
+void FProjectileSimulation::Integrate(UWorld* World, float DeltaTime, TArray<FProjectileImpact>& OutImpacts) {
+	if (Positions.Num() == 0 || DeltaTime <= 0.0f) {
+		return;
+	}
+
+	// Runs on the integration task as well as the game thread
+	const float MaxSubstep = FMath::Max(CVarProjectileMaxSubstep.GetValueOnAnyThread(), 0.001f);
+	const int32 NumSubsteps = FMath::Max(FMath::CeilToInt32(DeltaTime / MaxSubstep), 1);
+	const float StepTime = DeltaTime / NumSubsteps;
+
+	FCollisionObjectQueryParams WorldObjectParams;
+	WorldObjectParams.AddObjectTypesToQuery(ECC_WorldStatic);
+	WorldObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
+	ProjectileSimulation::AddActorObjectTypes(WorldObjectParams);
+	FCollisionObjectQueryParams DynamicObjectParams(ECC_WorldDynamic);
+	ProjectileSimulation::AddActorObjectTypes(DynamicObjectParams);
+	FCollisionObjectQueryParams ActorObjectParams;
+	ProjectileSimulation::AddActorObjectTypes(ActorObjectParams);
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(ProjectileIntegrate), false);
+	TArray<FHitResult> SceneHits;
+
+	const bool bUseStaticOccupancy = StaticOccupancy.IsLoaded() && CVarProjectileUseStaticOccupancy.GetValueOnAnyThread();
+	const bool bOccupancySkipsDynamic = CVarProjectileOccupancySkipsDynamic.GetValueOnAnyThread();
+	int32 NumTraces = 0;
+
+	if (bHasHomingDefinitions) {
+		Homing.Steer(GetHomingView(), DeltaTime);
+	}
+
+	// Reverse order so removals only swap in already processed projectiles
+	for (int32 Index = Positions.Num() - 1; Index >= 0; --Index) {
+		const FProjectileDefinition& Definition = Definitions[DefinitionIndices[Index]];
+
+		QueryParams.ClearIgnoredActors();
+		QueryParams.AddIgnoredActor(IgnoredActors[Index].Get());
+		QueryParams.AddIgnoredActor(DamageCausers[Index].Get());
+
+		// Wind varies over kilometres, once per step is plenty
+		const FVector Wind = WindField.Sample(Positions[Index]);
+
+		for (int32 Substep = 0; Substep < NumSubsteps; ++Substep) {
+			FVector NewPosition;
+			FVector NewVelocity;
+			ProjectileSimulation::StepBallistics(Definition, Positions[Index], Velocities[Index], Wind, StepTime, NewPosition, NewVelocity);
+
+			FHitResult HitResult;
+			PawnBroadphase.SweepSegment(Positions[Index], NewPosition, IgnoredActors[Index].Get(), HitResult);
+
+			// Open air only needs the geometry the bake could not see
+			const bool bStaticFree = bUseStaticOccupancy && StaticOccupancy.IsSegmentFree(Positions[Index], NewPosition);
+			if (bStaticFree) {
+				INC_DWORD_STAT(STAT_ProjectileStaticSweepsSkipped);
+			}
+
+			// Pawns, vehicles and physics bodies outside the broadphase are never baked, so always swept
+			const FCollisionObjectQueryParams* SceneObjectParams = &WorldObjectParams;
+			if (bStaticFree && bOccupancySkipsDynamic) {
+				INC_DWORD_STAT(STAT_ProjectileSweepsSkipped);
+				SceneObjectParams = &ActorObjectParams;
+			} else if (bStaticFree) {
+				SceneObjectParams = &DynamicObjectParams;
+			}
+
+			INC_DWORD_STAT(STAT_ProjectileSweeps);
+			++NumTraces;
+
+			FHitResult WorldHit;
+			if (ProjectileSimulation::TraceScene(World, Positions[Index], NewPosition, *SceneObjectParams, QueryParams, SceneHits, WorldHit)
+				&& (!HitResult.bBlockingHit || WorldHit.Distance < HitResult.Distance)) {
+				HitResult = WorldHit;
+			}
+
+			if (HitResult.bBlockingHit) {
+				FProjectileImpact& Impact = OutImpacts.AddDefaulted_GetRef();
+				Impact.HitResult = HitResult;
+				Impact.DefinitionIndex = DefinitionIndices[Index];
+				Impact.DamageCauser = DamageCausers[Index];
+				Impact.InstigatorController = InstigatorControllers[Index];
+
+				RemoveInFlight(Index);
+				break;
+			}
+
+			Positions[Index] = NewPosition;
+			Velocities[Index] = NewVelocity;
+			FlightTimes[Index] += StepTime;
+
+			if (FlightTimes[Index] >= Definition.MaxFlightTime) {
+				RemoveInFlight(Index);
+				break;
+			}
+		}
+	}
+
+	CSV_WEAPON_COUNT(Traces, NumTraces);
+}
+
+
+/**
+ * Rebuilds the pawn broadphase on the game thread and integrates in the background.
+ *
+ * @note World traces are thread safe - only actor iteration has to stay on the game thread
+ */
+void FProjectileSimulation::BeginIntegrate(UWorld* World, float StepTime, int32 NumSteps) {
+	WaitForIntegrate();
+
+	if (Positions.Num() == 0 || NumSteps <= 0 || StepTime <= 0.0f) {
+		return;
+	}
+
+	// Characters are tested against the capsule broadphase, the scene query skips them
+	PawnBroadphase.Rebuild(World);
+	WindField.Update(World, Positions);
+
+	// Targets come from the capsules just gathered, aim points stay fixed for this frame's steps
+	if (bHasHomingDefinitions) {
+		Homing.UpdateTargets(PawnBroadphase, GetHomingView());
+	}
+
+	auto IntegrateSteps = [this, World, StepTime, NumSteps]() {
+		CSV_WEAPON_SCOPED_TIMING(ProjectileIntegrate);
+		for (int32 Step = 0; Step < NumSteps && Positions.Num() > 0; ++Step) {
+			Integrate(World, StepTime, IntegrateImpacts);
+		}
+	};
+
+	if (CVarProjectileAsyncIntegrate.GetValueOnGameThread()) {
+		IntegrateTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, MoveTemp(IntegrateSteps));
+	} else {
+		IntegrateSteps();
+	}
+}
+
+
+void FProjectileSimulation::FinishIntegrate(TArray<FProjectileImpact>& OutImpacts) {
+	WaitForIntegrate();
+
+	OutImpacts.Append(IntegrateImpacts);
+	IntegrateImpacts.Reset();
+}
+
+
+/**
+ * Looks for a grid baked next to the persistent level's map package.
+ */
+void FProjectileSimulation::LoadStaticOccupancy(const UWorld* World) {
+	WaitForIntegrate();
+
+	const FString MapPackageName = UWorld::RemovePIEPrefix(World->GetOutermost()->GetName());
+	StaticOccupancy.Load(MapPackageName);
+}
+
+
+void FProjectileSimulation::Reset() {
+	WaitForIntegrate();
+	IntegrateImpacts.Reset();
+	Definitions.Reset();
+	Positions.Reset();
+	Velocities.Reset();
+	FlightTimes.Reset();
+	DefinitionIndices.Reset();
+	DamageCausers.Reset();
+	InstigatorControllers.Reset();
+	IgnoredActors.Reset();
+	HomingTargets.Reset();
+	HomingAimPoints.Reset();
+	Homing.Reset();
+	WindField.Reset();
+	bHasHomingDefinitions = false;
+	PendingCatchUp.Reset();
+	PawnBroadphase.Reset();
+	CatchUpBroadphase.Reset();
+	StaticOccupancy.Reset();
+}
+
+
+void FProjectileSimulation::AddInFlight(const FVector& Position, const FVector& Velocity, float FlightTime, const FProjectileLaunchParams& LaunchParams) {
+	Positions.Add(Position);
+	Velocities.Add(Velocity);
+	FlightTimes.Add(FlightTime);
+	DefinitionIndices.Add(LaunchParams.DefinitionIndex);
+	DamageCausers.Add(LaunchParams.DamageCauser);
+	InstigatorControllers.Add(LaunchParams.InstigatorController);
+	IgnoredActors.Add(LaunchParams.IgnoredActor);
+	HomingTargets.AddDefaulted();
+	HomingAimPoints.Add(Position);
+}
+
+
+void FProjectileSimulation::RemoveInFlight(int32 Index) {
+	Positions.RemoveAtSwap(Index);
+	Velocities.RemoveAtSwap(Index);
+	FlightTimes.RemoveAtSwap(Index);
+	DefinitionIndices.RemoveAtSwap(Index);
+	DamageCausers.RemoveAtSwap(Index);
+	InstigatorControllers.RemoveAtSwap(Index);
+	IgnoredActors.RemoveAtSwap(Index);
+	HomingTargets.RemoveAtSwap(Index);
+	HomingAimPoints.RemoveAtSwap(Index);
+}
+
+
+FProjectileHoming::FInFlightView FProjectileSimulation::GetHomingView() {
+	FProjectileHoming::FInFlightView View;
+	View.Definitions = Definitions;
+	View.DefinitionIndices = DefinitionIndices;
+	View.Positions = Positions;
+	View.Velocities = Velocities;
+	View.IgnoredActors = IgnoredActors;
+	View.Targets = HomingTargets;
+	View.AimPoints = HomingAimPoints;
+	return View;
+}
+
+
+void FProjectileSimulation::WaitForIntegrate() {
+	if (IntegrateTask.IsValid()) {
+		IntegrateTask.Wait();
+		IntegrateTask = UE::Tasks::FTask();
+	}
+}
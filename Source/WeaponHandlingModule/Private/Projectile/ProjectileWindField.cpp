@@ -0,0 +1,121 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Projectile/ProjectileWindField.h"
+
+#include "SceneInterface.h"
+#include "Engine/World.h"
+
+static TAutoConsoleVariable<bool> CVarProjectileWind(
+	TEXT("weapon.Projectile.Wind"),
+	true,
+	TEXT("Let wind sources push projectiles through their drag."));
+
+static TAutoConsoleVariable<float> CVarProjectileWindUpdateInterval(
+	TEXT("weapon.Projectile.WindUpdateInterval"),
+	0.5f,
+	TEXT("Seconds between resamples of the projectile wind grid."));
+
+static TAutoConsoleVariable<float> CVarProjectileWindCellSize(
+	TEXT("weapon.Projectile.WindCellSize"),
+	2000.0f,
+	TEXT("Spacing of the projectile wind grid points (cm)."));
+
+static TAutoConsoleVariable<float> CVarProjectileWindSpeedScale(
+	TEXT("weapon.Projectile.WindSpeedScale"),
+	10000.0f,
+	TEXT("Wind source speed to projectile wind velocity (cm/s per unit)."));
+
+namespace ProjectileWindField {
+	// Grid points per axis, the grid is flat because rounds spread out far more than up
+	const FIntVector MaxResolution(16, 16, 4);
+}
+
+
+/**
+ * Recenters the grid on the rounds and samples every point from the scene.
+ *
+ * @note Grid points snap to the cell size, so a moving grid does not make the wind shimmer
+ */
+void FProjectileWindField::Update(const UWorld* World, TConstArrayView<FVector> Positions) {
+	if (!CVarProjectileWind.GetValueOnGameThread()) {
+		Reset();
+		return;
+	}
+
+	const double CurrentTime = World->GetTimeSeconds();
+	if (CurrentTime - LastUpdateTime < CVarProjectileWindUpdateInterval.GetValueOnGameThread() || Positions.Num() == 0 || !World->Scene) {
+		return;
+	}
+	LastUpdateTime = CurrentTime;
+
+	const FBox Bounds(Positions.GetData(), Positions.Num());
+	CellSize = FMath::Max(CVarProjectileWindCellSize.GetValueOnGameThread(), 1.0f);
+
+	// Cover the rounds where possible, centered on them when they spread further
+	const FVector Extent = Bounds.GetSize() / CellSize;
+	Resolution = FIntVector(
+		FMath::Clamp(FMath::CeilToInt32(Extent.X) + 2, 2, ProjectileWindField::MaxResolution.X),
+		FMath::Clamp(FMath::CeilToInt32(Extent.Y) + 2, 2, ProjectileWindField::MaxResolution.Y),
+		FMath::Clamp(FMath::CeilToInt32(Extent.Z) + 2, 2, ProjectileWindField::MaxResolution.Z));
+
+	const FVector HalfSize = FVector(Resolution - FIntVector(1)) * CellSize * 0.5;
+	Origin = ((Bounds.GetCenter() - HalfSize) / CellSize).GridSnap(1.0) * CellSize;
+
+	const float SpeedScale = CVarProjectileWindSpeedScale.GetValueOnGameThread();
+	Samples.SetNumUninitialized(Resolution.X * Resolution.Y * Resolution.Z);
+	bCalm = true;
+
+	for (int32 Z = 0; Z < Resolution.Z; ++Z) {
+		for (int32 Y = 0; Y < Resolution.Y; ++Y) {
+			for (int32 X = 0; X < Resolution.X; ++X) {
+				FVector Direction;
+				float Speed = 0.0f;
+				float MinGust = 0.0f;
+				float MaxGust = 0.0f;
+				World->Scene->GetWindParameters_GameThread(Origin + FVector(FIntVector(X, Y, Z)) * CellSize, Direction, Speed, MinGust, MaxGust);
+
+				// Gusts are averaged, the grid is too coarse in time to follow them
+				const FVector3f Wind(Direction * ((Speed + (MinGust + MaxGust) * 0.5f) * SpeedScale));
+				Samples[GetSampleIndex(X, Y, Z)] = Wind;
+				bCalm &= Wind.IsNearlyZero();
+			}
+		}
+	}
+}
+
+
+FVector FProjectileWindField::Sample(const FVector& Location) const {
+	if (bCalm) {
+		return FVector::ZeroVector;
+	}
+
+	const FVector GridLocation = (Location - Origin) / CellSize;
+	const FVector Clamped(
+		FMath::Clamp(GridLocation.X, 0.0, Resolution.X - 1.0),
+		FMath::Clamp(GridLocation.Y, 0.0, Resolution.Y - 1.0),
+		FMath::Clamp(GridLocation.Z, 0.0, Resolution.Z - 1.0));
+
+	const int32 X0 = FMath::Min(FMath::FloorToInt32(Clamped.X), Resolution.X - 2);
+	const int32 Y0 = FMath::Min(FMath::FloorToInt32(Clamped.Y), Resolution.Y - 2);
+	const int32 Z0 = FMath::Min(FMath::FloorToInt32(Clamped.Z), Resolution.Z - 2);
+	const FVector3f Alpha(Clamped - FVector(FIntVector(X0, Y0, Z0)));
+
+	const FVector3f Bottom = FMath::Lerp(
+		FMath::Lerp(Samples[GetSampleIndex(X0, Y0, Z0)], Samples[GetSampleIndex(X0 + 1, Y0, Z0)], Alpha.X),
+		FMath::Lerp(Samples[GetSampleIndex(X0, Y0 + 1, Z0)], Samples[GetSampleIndex(X0 + 1, Y0 + 1, Z0)], Alpha.X),
+		Alpha.Y);
+	const FVector3f Top = FMath::Lerp(
+		FMath::Lerp(Samples[GetSampleIndex(X0, Y0, Z0 + 1)], Samples[GetSampleIndex(X0 + 1, Y0, Z0 + 1)], Alpha.X),
+		FMath::Lerp(Samples[GetSampleIndex(X0, Y0 + 1, Z0 + 1)], Samples[GetSampleIndex(X0 + 1, Y0 + 1, Z0 + 1)], Alpha.X),
+		Alpha.Y);
+
+	return FVector(FMath::Lerp(Bottom, Top, Alpha.Z));
+}
+
+
+void FProjectileWindField::Reset() {
+	Samples.Reset();
+	Resolution = FIntVector::ZeroValue;
+	LastUpdateTime = -UE_BIG_NUMBER;
+	bCalm = true;
+}
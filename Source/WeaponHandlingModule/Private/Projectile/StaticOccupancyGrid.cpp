@@ -0,0 +1,187 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Projectile/StaticOccupancyGrid.h"
+
+#include "Logging.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/PackageName.h"
+
+FStaticOccupancyGrid::FStaticOccupancyGrid() = default;
+
+FStaticOccupancyGrid::~FStaticOccupancyGrid() = default;
+
+
+FString FStaticOccupancyGrid::GetFilename(const FString& MapPackageName) {
+	FString Filename;
+	FPackageName::TryConvertLongPackageNameToFilename(MapPackageName, Filename, TEXT(".wocc"));
+	return Filename;
+}
+
+
+/**
+ * Maps the grid file and validates its header.
+ *
+ * @note Missing files are expected for maps that were never baked and are not reported
+ */
+bool FStaticOccupancyGrid::Load(const FString& MapPackageName) {
+	Reset();
+
+	const FString Filename = GetFilename(MapPackageName);
+	if (Filename.IsEmpty()) {
+		return false;
+	}
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (!PlatformFile.FileExists(*Filename)) {
+		return false;
+	}
+
+	MappedFile.Reset(PlatformFile.OpenMapped(*Filename));
+	if (!MappedFile.IsValid() || MappedFile->GetFileSize() < static_cast<int64>(sizeof(FStaticOccupancyHeader))) {
+		UE_LOG(LogWeaponHandlingModule, Warning, TEXT("StaticOccupancyGrid: Could not map %s"), *Filename);
+		Reset();
+		return false;
+	}
+
+	MappedRegion.Reset(MappedFile->MapRegion());
+	if (!MappedRegion.IsValid()) {
+		UE_LOG(LogWeaponHandlingModule, Warning, TEXT("StaticOccupancyGrid: Could not map %s"), *Filename);
+		Reset();
+		return false;
+	}
+
+	const FStaticOccupancyHeader* MappedHeader = reinterpret_cast<const FStaticOccupancyHeader*>(MappedRegion->GetMappedPtr());
+	if (!IsValidHeader(*MappedHeader, MappedRegion->GetMappedSize())) {
+		UE_LOG(LogWeaponHandlingModule, Warning, TEXT("StaticOccupancyGrid: %s is invalid or out of date, rebake it"), *Filename);
+		Reset();
+		return false;
+	}
+
+	// Every brick index is checked once here so lookups never have to
+	const uint32* MappedBrickTable = reinterpret_cast<const uint32*>(MappedRegion->GetMappedPtr() + sizeof(FStaticOccupancyHeader));
+	const uint32 BrickEntryEnd = FStaticOccupancyHeader::FirstStoredBrick + static_cast<uint32>(MappedHeader->NumStoredBricks);
+	for (int32 BrickIndex = 0; BrickIndex < MappedHeader->GetNumBricks(); ++BrickIndex) {
+		if (MappedBrickTable[BrickIndex] >= BrickEntryEnd) {
+			UE_LOG(LogWeaponHandlingModule, Warning, TEXT("StaticOccupancyGrid: %s has a brick outside its brick data, rebake it"), *Filename);
+			Reset();
+			return false;
+		}
+	}
+
+	Header = MappedHeader;
+	BrickTable = MappedBrickTable;
+	BrickWords = reinterpret_cast<const uint64*>(MappedRegion->GetMappedPtr() + Header->GetBrickDataOffset());
+	NumCells = FIntVector(Header->NumBricksX, Header->NumBricksY, Header->NumBricksZ) * FStaticOccupancyHeader::BrickSize;
+
+	UE_LOG(LogWeaponHandlingModule, Log, TEXT("StaticOccupancyGrid: Mapped %s (%d bricks, %d stored)"), *Filename, Header->GetNumBricks(), Header->NumStoredBricks);
+	return true;
+}
+
+
+/**
+ * Checks the header against itself and the mapped size.
+ *
+ * @note Dimensions are checked in 64 bits first, so a corrupt header cannot overflow the size it implies
+ */
+bool FStaticOccupancyGrid::IsValidHeader(const FStaticOccupancyHeader& InHeader, int64 MappedSize) {
+	if (InHeader.Magic != FStaticOccupancyHeader::ExpectedMagic || InHeader.Version != FStaticOccupancyHeader::CurrentVersion || InHeader.CellSize <= 0.0f) {
+		return false;
+	}
+
+	if (InHeader.NumBricksX <= 0 || InHeader.NumBricksY <= 0 || InHeader.NumBricksZ <= 0 || InHeader.NumStoredBricks < 0) {
+		return false;
+	}
+
+	const int64 NumBricks = static_cast<int64>(InHeader.NumBricksX) * InHeader.NumBricksY * InHeader.NumBricksZ;
+	if (NumBricks > MAX_int32 || static_cast<int64>(InHeader.NumBricksX) * FStaticOccupancyHeader::BrickSize > MAX_int32
+		|| static_cast<int64>(InHeader.NumBricksY) * FStaticOccupancyHeader::BrickSize > MAX_int32
+		|| static_cast<int64>(InHeader.NumBricksZ) * FStaticOccupancyHeader::BrickSize > MAX_int32) {
+		return false;
+	}
+
+	return InHeader.GetFileSize() == MappedSize;
+}
+
+
+void FStaticOccupancyGrid::Reset() {
+	Header = nullptr;
+	BrickTable = nullptr;
+	BrickWords = nullptr;
+	NumCells = FIntVector::ZeroValue;
+	MappedRegion.Reset();
+	MappedFile.Reset();
+}
+
+
+/**
+ * Steps through every cell on the segment with a 3D DDA.
+ *
+ * @note Cells outside the baked bounds are unknown and count as occupied, so the caller sweeps
+ */
+bool FStaticOccupancyGrid::IsSegmentFree(const FVector& Start, const FVector& End) const {
+	if (!Header) {
+		return false;
+	}
+
+	const FVector Origin(Header->OriginX, Header->OriginY, Header->OriginZ);
+	const FVector LocalStart = (Start - Origin) / Header->CellSize;
+	const FVector LocalEnd = (End - Origin) / Header->CellSize;
+	const FVector LocalDelta = LocalEnd - LocalStart;
+
+	FIntVector Cell(FMath::FloorToInt32(LocalStart.X), FMath::FloorToInt32(LocalStart.Y), FMath::FloorToInt32(LocalStart.Z));
+	const FIntVector EndCell(FMath::FloorToInt32(LocalEnd.X), FMath::FloorToInt32(LocalEnd.Y), FMath::FloorToInt32(LocalEnd.Z));
+
+	// Per axis: cell step, segment fraction to the next boundary, and fraction per cell
+	FIntVector Step;
+	FVector NextBoundary;
+	FVector BoundaryInterval;
+	for (int32 Axis = 0; Axis < 3; ++Axis) {
+		if (LocalDelta[Axis] > 0.0) {
+			Step[Axis] = 1;
+			BoundaryInterval[Axis] = 1.0 / LocalDelta[Axis];
+			NextBoundary[Axis] = (Cell[Axis] + 1 - LocalStart[Axis]) * BoundaryInterval[Axis];
+		} else if (LocalDelta[Axis] < 0.0) {
+			Step[Axis] = -1;
+			BoundaryInterval[Axis] = -1.0 / LocalDelta[Axis];
+			NextBoundary[Axis] = (LocalStart[Axis] - Cell[Axis]) * BoundaryInterval[Axis];
+		} else {
+			Step[Axis] = 0;
+			BoundaryInterval[Axis] = TNumericLimits<double>::Max();
+			NextBoundary[Axis] = TNumericLimits<double>::Max();
+		}
+	}
+
+	const int32 MaxSteps = FMath::Abs(EndCell.X - Cell.X) + FMath::Abs(EndCell.Y - Cell.Y) + FMath::Abs(EndCell.Z - Cell.Z);
+	for (int32 StepIndex = 0; StepIndex <= MaxSteps; ++StepIndex) {
+		if (IsCellOccupied(Cell)) {
+			return false;
+		}
+
+		const int32 Axis = NextBoundary.X < NextBoundary.Y ? (NextBoundary.X < NextBoundary.Z ? 0 : 2) : (NextBoundary.Y < NextBoundary.Z ? 1 : 2);
+		Cell[Axis] += Step[Axis];
+		NextBoundary[Axis] += BoundaryInterval[Axis];
+	}
+
+	return true;
+}
+
+
+bool FStaticOccupancyGrid::IsCellOccupied(const FIntVector& Cell) const {
+	// Outside the bake nothing is known - geometry may have been added, or lie in an unbaked level
+	if (Cell.X < 0 || Cell.Y < 0 || Cell.Z < 0 || Cell.X >= NumCells.X || Cell.Y >= NumCells.Y || Cell.Z >= NumCells.Z) {
+		return true;
+	}
+
+	constexpr int32 BrickSize = FStaticOccupancyHeader::BrickSize;
+	const FIntVector Brick(Cell.X / BrickSize, Cell.Y / BrickSize, Cell.Z / BrickSize);
+	const uint32 BrickEntry = BrickTable[(Brick.Z * Header->NumBricksY + Brick.Y) * Header->NumBricksX + Brick.X];
+
+	if (BrickEntry < FStaticOccupancyHeader::FirstStoredBrick) {
+		return BrickEntry == FStaticOccupancyHeader::FullBrick;
+	}
+
+	const int32 BitIndex = ((Cell.Z % BrickSize) * BrickSize + Cell.Y % BrickSize) * BrickSize + Cell.X % BrickSize;
+	const uint64* Words = BrickWords + static_cast<int64>(BrickEntry - FStaticOccupancyHeader::FirstStoredBrick) * FStaticOccupancyHeader::WordsPerBrick;
+	return (Words[BitIndex / 64] >> (BitIndex % 64)) & 1;
+}
@@ -0,0 +1,143 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Projectile/WeaponProjectileActor.h"
+
+#include "Components/AudioComponent.h"
+#include "Components/SphereComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "Projectile/ProjectileSimulation.h"
+#include "Subsystem/WeaponSubsystem.h"
+
+
+AWeaponProjectileActor::AWeaponProjectileActor() {
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
+
+	// Every machine simulates its own copy, like batched projectiles
+	bReplicates = false;
+
+	CollisionSphere = CreateDefaultSubobject<USphereComponent>("Collision Sphere");
+	CollisionSphere->InitSphereRadius(5.0f);
+	CollisionSphere->SetCollisionProfileName(UCollisionProfile::BlockAllDynamic_ProfileName);
+	CollisionSphere->SetCollisionResponseToChannel(ECC_Camera, ECR_Ignore);
+	CollisionSphere->SetCanEverAffectNavigation(false);
+	SetRootComponent(CollisionSphere);
+
+	ProjectileMovement = CreateDefaultSubobject<UProjectileMovementComponent>("Projectile Movement");
+	ProjectileMovement->bRotationFollowsVelocity = true;
+	ProjectileMovement->bShouldBounce = false;
+	ProjectileMovement->bAutoActivate = false;
+}
+
+
+void AWeaponProjectileActor::PostInitializeComponents() {
+	Super::PostInitializeComponents();
+
+	for (UActorComponent* Component : GetComponents()) {
+		if (Component->bAutoActivate && (Component->IsA<UFXSystemComponent>() || Component->IsA<UAudioComponent>())) {
+			EffectComponents.Add(Component);
+		}
+	}
+
+	ProjectileMovement->OnProjectileStop.AddDynamic(this, &AWeaponProjectileActor::HandleProjectileStop);
+}
+
+
+/**
+ * Expires rounds that outlived their definition's flight time.
+ *
+ * @note Only ticks while in flight
+ */
+void AWeaponProjectileActor::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	if (bInFlight && GetWorld()->GetTimeSeconds() >= ExpireTime) {
+		Release();
+	}
+}
+
+
+void AWeaponProjectileActor::Launch(const FProjectileLaunchParams& LaunchParams, const FProjectileDefinition& Definition) {
+	DamageCauser = LaunchParams.DamageCauser;
+	InstigatorController = LaunchParams.InstigatorController;
+	IgnoredActor = LaunchParams.IgnoredActor;
+	ImpactParticle = Definition.ImpactParticle;
+	Damage = Definition.Damage;
+	ExpireTime = GetWorld()->GetTimeSeconds() + Definition.MaxFlightTime;
+	bInFlight = true;
+
+	SetActorLocationAndRotation(LaunchParams.Origin, LaunchParams.Direction.Rotation(), false, nullptr, ETeleportType::ResetPhysics);
+	SetActorHiddenInGame(false);
+	SetActorTickEnabled(true);
+
+	CollisionSphere->ClearMoveIgnoreActors();
+	CollisionSphere->IgnoreActorWhenMoving(IgnoredActor.Get(), true);
+	CollisionSphere->IgnoreActorWhenMoving(DamageCauser.Get(), true);
+	CollisionSphere->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+
+	const float WorldGravityZ = GetWorld()->GetGravityZ();
+	ProjectileMovement->ProjectileGravityScale = FMath::IsNearlyZero(WorldGravityZ) ? 0.0f : Definition.GravityZ / WorldGravityZ;
+	ProjectileMovement->SetUpdatedComponent(CollisionSphere);
+	ProjectileMovement->Velocity = LaunchParams.Direction * Definition.MuzzleSpeed;
+	ProjectileMovement->Activate(true);
+
+	for (UActorComponent* Component : EffectComponents) {
+		Component->Activate(true);
+	}
+
+	OnLaunched();
+}
+
+
+void AWeaponProjectileActor::Deactivate() {
+	bInFlight = false;
+
+	ProjectileMovement->StopMovementImmediately();
+	ProjectileMovement->Deactivate();
+
+	CollisionSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	CollisionSphere->ClearMoveIgnoreActors();
+
+	for (UActorComponent* Component : EffectComponents) {
+		Component->Deactivate();
+	}
+
+	SetActorHiddenInGame(true);
+	SetActorTickEnabled(false);
+
+	DamageCauser.Reset();
+	InstigatorController.Reset();
+	IgnoredActor.Reset();
+	ImpactParticle.Reset();
+
+	OnDeactivated();
+}
+
+
+/**
+ * Resolves the impact through the shared damage path.
+ */
+void AWeaponProjectileActor::HandleProjectileStop(const FHitResult& ImpactResult) {
+	if (!bInFlight) {
+		return;
+	}
+
+	if (UWeaponSubsystem* WeaponSubsystem = GetWorld()->GetSubsystem<UWeaponSubsystem>()) {
+		FHitResult HitResult = ImpactResult;
+		WeaponSubsystem->ApplyWeaponDamage(Damage, InstigatorController.Get(), DamageCauser.Get(), HitResult, ImpactParticle.Get());
+	}
+
+	Release();
+}
+
+
+void AWeaponProjectileActor::Release() {
+	if (UWeaponSubsystem* WeaponSubsystem = GetWorld()->GetSubsystem<UWeaponSubsystem>()) {
+		WeaponSubsystem->ReleaseProjectileActor(this);
+	} else {
+		Destroy();
+	}
+}
@@ -0,0 +1,51 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Spatial/WeaponSpatialGrid.h"
+
+FWeaponSpatialGrid::FWeaponSpatialGrid(float InCellSize) : CellSize(FMath::Max(InCellSize, 1.0f)) {}
+
+
+FIntVector FWeaponSpatialGrid::GetCell(const FVector& Location, float CellSize) {
+	return FIntVector(
+		FMath::FloorToInt(Location.X / CellSize),
+		FMath::FloorToInt(Location.Y / CellSize),
+		FMath::FloorToInt(Location.Z / CellSize));
+}
+
+
+void FWeaponSpatialGrid::SetCellSize(float InCellSize) {
+	CellSize = FMath::Max(InCellSize, 1.0f);
+	Cells.Reset();
+}
+
+
+void FWeaponSpatialGrid::Reset() {
+	for (TPair<FIntVector, TArray<int32>>& Cell : Cells) {
+		Cell.Value.Reset();
+	}
+}
+
+
+void FWeaponSpatialGrid::Add(int32 Item, const FVector& Location) {
+	Cells.FindOrAdd(GetCell(Location)).Add(Item);
+}
+
+
+void FWeaponSpatialGrid::AddBounds(int32 Item, const FBox& Bounds) {
+	const FIntVector MinCell = GetCell(Bounds.Min);
+	const FIntVector MaxCell = GetCell(Bounds.Max);
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X) {
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y) {
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z) {
+				Cells.FindOrAdd(FIntVector(X, Y, Z)).Add(Item);
+			}
+		}
+	}
+}
+
+
+const TArray<int32>* FWeaponSpatialGrid::FindCell(const FIntVector& Cell) const {
+	const TArray<int32>* CellItems = Cells.Find(Cell);
+	return CellItems && CellItems->Num() > 0 ? CellItems : nullptr;
+}
@@ -0,0 +1,362 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystem/WeaponSoakTestSubsystem.h"
+
+#include "AIController.h"
+#include "Component/WeaponHandlingComponent.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "EngineUtils.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/PlayerStart.h"
+#include "HAL/PlatformMemory.h"
+#include "Logging.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "Subsystem/WeaponSubsystem.h"
+#include "UObject/UObjectIterator.h"
+#include "Weapon/RangedWeapon.h"
+#include "Weapon/WeaponDefinition.h"
+
+static TAutoConsoleVariable<float> CVarSoakHours(
+	TEXT("weapon.Soak.Hours"),
+	1.0f,
+	TEXT("Length of a soak run, overridden by -WeaponSoakHours."));
+
+static TAutoConsoleVariable<int32> CVarSoakBots(
+	TEXT("weapon.Soak.Bots"),
+	16,
+	TEXT("Scripted bots in a soak run, overridden by -WeaponSoakBots."));
+
+static TAutoConsoleVariable<float> CVarSoakSampleInterval(
+	TEXT("weapon.Soak.SampleInterval"),
+	60.0f,
+	TEXT("Seconds between soak samples."));
+
+static TAutoConsoleVariable<float> CVarSoakWarmupTime(
+	TEXT("weapon.Soak.WarmupTime"),
+	120.0f,
+	TEXT("Seconds before the first soak sample, so pools can fill first."));
+
+static TAutoConsoleVariable<int32> CVarSoakGrowthWindow(
+	TEXT("weapon.Soak.GrowthWindow"),
+	10,
+	TEXT("A value that grew in this many consecutive soak samples is reported as a leak."));
+
+static TAutoConsoleVariable<float> CVarSoakArmedTime(
+	TEXT("weapon.Soak.ArmedTime"),
+	5.0f,
+	TEXT("Seconds a soak bot fires before dropping its weapon."));
+
+static TAutoConsoleVariable<float> CVarSoakDroppedTime(
+	TEXT("weapon.Soak.DroppedTime"),
+	2.0f,
+	TEXT("Seconds a soak bot waits before re-equipping, shorter than the drop settle time on purpose."));
+
+static TAutoConsoleVariable<bool> CVarSoakSynchronizedDrops(
+	TEXT("weapon.Soak.SynchronizedDrops"),
+	false,
+	TEXT("Drop every soak bot's weapon on the same frame, to measure mass death drop traffic."));
+
+static TAutoConsoleVariable<float> CVarSoakFireInterval(
+	TEXT("weapon.Soak.FireInterval"),
+	0.1f,
+	TEXT("Seconds between trigger pulls of an armed soak bot."));
+
+namespace WeaponSoakTest {
+	// Memory moves by a few pages between samples without anything leaking
+	constexpr int64 MemoryTolerance = 1024 * 1024;
+
+	// Bots aim down and outwards, so every shot reaches an impact
+	constexpr float AimPitch = -20.0f;
+}
+
+
+bool UWeaponSoakTestSubsystem::ShouldCreateSubsystem(UObject* Outer) const {
+	return Super::ShouldCreateSubsystem(Outer) && FParse::Param(FCommandLine::Get(), TEXT("WeaponSoak"));
+}
+
+
+bool UWeaponSoakTestSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const {
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
+
+
+/**
+ * Reads the run options and spawns the bots.
+ *
+ * @note Fails the run at once when the weapon definition is missing,
+ *       rather than soaking an empty world for hours
+ */
+void UWeaponSoakTestSubsystem::OnWorldBeginPlay(UWorld& InWorld) {
+	Super::OnWorldBeginPlay(InWorld);
+
+	// Weapons are only authoritative, and only leak what matters, on the server
+	if (InWorld.GetNetMode() == NM_Client) {
+		return;
+	}
+
+	FString WeaponName;
+	if (!FParse::Value(FCommandLine::Get(), TEXT("WeaponSoakWeapon="), WeaponName)) {
+		UE_LOG(LogWeaponHandlingModule, Error, TEXT("WeaponSoak: -WeaponSoakWeapon=<WeaponDefinition> is required"));
+		bFailed = true;
+		FinishRun();
+		return;
+	}
+	WeaponDefinitionId = FPrimaryAssetId(UWeaponDefinition::PrimaryAssetType, FName(*WeaponName));
+
+	float Hours = CVarSoakHours.GetValueOnGameThread();
+	FParse::Value(FCommandLine::Get(), TEXT("WeaponSoakHours="), Hours);
+	int32 NumBots = CVarSoakBots.GetValueOnGameThread();
+	FParse::Value(FCommandLine::Get(), TEXT("WeaponSoakBots="), NumBots);
+
+	FVector Center = FVector::ZeroVector;
+	for (TActorIterator<APlayerStart> It(&InWorld); It; ++It) {
+		Center = It->GetActorLocation();
+		break;
+	}
+
+	for (int32 BotIndex = 0; BotIndex < NumBots; ++BotIndex) {
+		if (!SpawnBot(BotIndex, NumBots, Center)) {
+			UE_LOG(LogWeaponHandlingModule, Error, TEXT("WeaponSoak: Could not spawn a weapon from %s"), *WeaponDefinitionId.ToString());
+			bFailed = true;
+			FinishRun();
+			return;
+		}
+	}
+
+	const double CurrentTime = InWorld.GetRealTimeSeconds();
+	EndTime = CurrentTime + Hours * 3600.0;
+	NextSampleTime = CurrentTime + CVarSoakWarmupTime.GetValueOnGameThread();
+	bRunning = true;
+
+	UE_LOG(LogWeaponHandlingModule, Display, TEXT("WeaponSoak: %d bots with %s for %.2f hours"), NumBots, *WeaponDefinitionId.ToString(), Hours);
+}
+
+
+void UWeaponSoakTestSubsystem::Deinitialize() {
+	Bots.Reset();
+	Metrics.Reset();
+
+	Super::Deinitialize();
+}
+
+
+void UWeaponSoakTestSubsystem::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	if (!bRunning) {
+		return;
+	}
+
+	const double CurrentTime = GetWorld()->GetRealTimeSeconds();
+	for (FSoakBot& Bot : Bots) {
+		TickBot(Bot, CurrentTime);
+
+		// A bot that could not replace its weapon ended the run
+		if (!bRunning) {
+			return;
+		}
+	}
+
+	// Sampled right after a full collection, so counts do not include pending garbage
+	if (bSamplePending) {
+		bSamplePending = false;
+		TakeSample();
+	} else if (CurrentTime >= NextSampleTime) {
+		GEngine->ForceGarbageCollection(true);
+		bSamplePending = true;
+		NextSampleTime = CurrentTime + FMath::Max(CVarSoakSampleInterval.GetValueOnGameThread(), 1.0f);
+	}
+
+	if (CurrentTime >= EndTime) {
+		TakeSample();
+		FinishRun();
+	}
+}
+
+
+TStatId UWeaponSoakTestSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UWeaponSoakTestSubsystem, STATGROUP_Tickables);
+}
+
+
+/**
+ * Spawns a bot on a ring around the center, with its weapon at its feet.
+ *
+ * @note The weapon handling component is added at runtime, so any character works as a bot
+ */
+bool UWeaponSoakTestSubsystem::SpawnBot(int32 BotIndex, int32 NumBots, const FVector& Center) {
+	UWorld* World = GetWorld();
+	UWeaponSubsystem* WeaponSubsystem = World->GetSubsystem<UWeaponSubsystem>();
+
+	const float Angle = 2.0f * PI * BotIndex / FMath::Max(NumBots, 1);
+	const float Radius = 200.0f + 50.0f * NumBots;
+	const FVector Location = Center + FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.0f) * Radius;
+	const FRotator Rotation(0.0f, FMath::RadiansToDegrees(Angle), 0.0f);
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+	ACharacter* Character = World->SpawnActor<ACharacter>(ACharacter::StaticClass(), Location, Rotation, SpawnParams);
+	if (!Character) {
+		return false;
+	}
+
+	// Weapons aim along the controller's view point
+	Character->AIControllerClass = AAIController::StaticClass();
+	Character->SpawnDefaultController();
+	if (AController* Controller = Character->GetController()) {
+		Controller->SetControlRotation(FRotator(WeaponSoakTest::AimPitch, Rotation.Yaw, 0.0f));
+	}
+
+	UWeaponHandlingComponent* WeaponHandling = NewObject<UWeaponHandlingComponent>(Character, TEXT("SoakWeaponHandling"));
+	Character->AddInstanceComponent(WeaponHandling);
+	WeaponHandling->RegisterComponent();
+
+	ARangedWeapon* Weapon = WeaponSubsystem ? WeaponSubsystem->SpawnWeapon(WeaponDefinitionId, Character->GetActorTransform()) : nullptr;
+	if (!Weapon) {
+		Character->Destroy();
+		return false;
+	}
+
+	FSoakBot& Bot = Bots.AddDefaulted_GetRef();
+	Bot.Character = Character;
+	Bot.WeaponHandling = WeaponHandling;
+	Bot.Weapon = Weapon;
+
+	// Staggered, so drops and equips are spread over the cycle instead of landing on one frame
+	const float CycleTime = CVarSoakArmedTime.GetValueOnGameThread() + CVarSoakDroppedTime.GetValueOnGameThread();
+	const float Stagger = CVarSoakSynchronizedDrops.GetValueOnGameThread() ? 0.0f : CycleTime * BotIndex / FMath::Max(NumBots, 1);
+	Bot.PhaseEndTime = World->GetRealTimeSeconds() + Stagger;
+	return true;
+}
+
+
+void UWeaponSoakTestSubsystem::TickBot(FSoakBot& Bot, double CurrentTime) {
+	UWeaponHandlingComponent* WeaponHandling = Bot.WeaponHandling.Get();
+	if (!WeaponHandling || !Bot.Character.IsValid()) {
+		return;
+	}
+
+	// Dropped weapons can fall out of the world - replace them like a respawned pick up
+	if (!Bot.Weapon.IsValid()) {
+		UWeaponSubsystem* WeaponSubsystem = GetWorld()->GetSubsystem<UWeaponSubsystem>();
+		Bot.Weapon = WeaponSubsystem ? WeaponSubsystem->SpawnWeapon(WeaponDefinitionId, Bot.Character->GetActorTransform()) : nullptr;
+		Bot.bArmed = false;
+		if (!Bot.Weapon.IsValid()) {
+			UE_LOG(LogWeaponHandlingModule, Error, TEXT("WeaponSoak: Could not respawn a weapon from %s"), *WeaponDefinitionId.ToString());
+			bFailed = true;
+			FinishRun();
+			return;
+		}
+	}
+
+	if (CurrentTime >= Bot.PhaseEndTime) {
+		if (Bot.bArmed) {
+			WeaponHandling->UnequipWeapon();
+			Bot.PhaseEndTime = CurrentTime + CVarSoakDroppedTime.GetValueOnGameThread();
+		} else {
+			WeaponHandling->EquipWeaponInstance(Bot.Weapon.Get());
+			Bot.PhaseEndTime = CurrentTime + CVarSoakArmedTime.GetValueOnGameThread();
+		}
+		Bot.bArmed = !Bot.bArmed;
+	}
+
+	// Pulled and released per shot, so single fire definitions re-arm and keep firing
+	if (Bot.bArmed && CurrentTime >= Bot.NextShotTime) {
+		WeaponHandling->StartWeaponAttack();
+		WeaponHandling->WeaponAttack();
+		WeaponHandling->StopWeaponAttack();
+		Bot.NextShotTime = CurrentTime + CVarSoakFireInterval.GetValueOnGameThread();
+	}
+}
+
+
+/**
+ * Records one sample of every tracked value.
+ *
+ * @note Walks every UObject - a few milliseconds, once per sample interval
+ */
+void UWeaponSoakTestSubsystem::TakeSample() {
+	++NumSamples;
+
+	TMap<const UClass*, int64> ObjectCounts;
+	for (FThreadSafeObjectIterator It; It; ++It) {
+		++ObjectCounts.FindOrAdd(It->GetClass());
+	}
+	int64 NumObjects = 0;
+	for (const TPair<const UClass*, int64>& Pair : ObjectCounts) {
+		RecordMetric(FString::Printf(TEXT("Objects/%s"), *Pair.Key->GetName()), Pair.Value, 0);
+		NumObjects += Pair.Value;
+	}
+	RecordMetric(TEXT("Objects/Total"), NumObjects, 0);
+
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+	RecordMetric(TEXT("Memory/UsedPhysical"), MemoryStats.UsedPhysical, WeaponSoakTest::MemoryTolerance);
+	RecordMetric(TEXT("Memory/UsedVirtual"), MemoryStats.UsedVirtual, WeaponSoakTest::MemoryTolerance);
+
+	int64 NumSettleTimers = 0;
+	int64 NumIgnoredActors = 0;
+	for (TActorIterator<ABaseWeapon> It(GetWorld()); It; ++It) {
+		NumSettleTimers += It->IsSettlingAfterFall() ? 1 : 0;
+		NumIgnoredActors += It->GetActorsToIgnore().Num();
+	}
+	RecordMetric(TEXT("Timers/WeaponSettle"), NumSettleTimers, 0);
+	RecordMetric(TEXT("Weapons/IgnoredActors"), NumIgnoredActors, 0);
+
+	if (UWeaponSubsystem* WeaponSubsystem = GetWorld()->GetSubsystem<UWeaponSubsystem>()) {
+		WeaponSubsystem->ForEachPoolSize([this](const TCHAR* Name, int64 Size) {
+			RecordMetric(FString::Printf(TEXT("Pools/%s"), Name), Size, 0);
+		});
+	}
+
+	UE_LOG(LogWeaponHandlingModule, Display, TEXT("WeaponSoak: Sample %d - %lld objects, %.1f MB physical"),
+		NumSamples, NumObjects, MemoryStats.UsedPhysical / (1024.0 * 1024.0));
+}
+
+
+/**
+ * Adds a sample and flags the metric once it grew in every step of the growth window.
+ *
+ * @remark Pools that fill up and plateau, or sawtooth with collection, are not flagged
+ */
+void UWeaponSoakTestSubsystem::RecordMetric(const FString& Name, int64 Value, int64 Tolerance) {
+	FSoakMetric& Metric = Metrics.FindOrAdd(Name);
+	Metric.Tolerance = Tolerance;
+	Metric.Samples.Add(Value);
+
+	const int32 GrowthWindow = FMath::Max(CVarSoakGrowthWindow.GetValueOnGameThread(), 2);
+	if (Metric.bFlagged || Metric.Samples.Num() <= GrowthWindow) {
+		return;
+	}
+
+	const int32 FirstIndex = Metric.Samples.Num() - GrowthWindow;
+	for (int32 Index = FirstIndex; Index < Metric.Samples.Num(); ++Index) {
+		if (Metric.Samples[Index] <= Metric.Samples[Index - 1] + Tolerance) {
+			return;
+		}
+	}
+
+	Metric.bFlagged = true;
+	bFailed = true;
+	UE_LOG(LogWeaponHandlingModule, Error, TEXT("WeaponSoak: %s grew in each of the last %d samples, %lld -> %lld"),
+		*Name, GrowthWindow, Metric.Samples[FirstIndex - 1], Value);
+}
+
+
+void UWeaponSoakTestSubsystem::FinishRun() {
+	bRunning = false;
+
+	int32 NumFlagged = 0;
+	for (const TPair<FString, FSoakMetric>& Pair : Metrics) {
+		NumFlagged += Pair.Value.bFlagged ? 1 : 0;
+	}
+
+	if (bFailed) {
+		UE_LOG(LogWeaponHandlingModule, Error, TEXT("WeaponSoak: FAILED after %d samples, %d values kept growing"), NumSamples, NumFlagged);
+	} else {
+		UE_LOG(LogWeaponHandlingModule, Display, TEXT("WeaponSoak: PASSED after %d samples of %d values"), NumSamples, Metrics.Num());
+	}
+
+	FPlatformMisc::RequestExitWithStatus(false, bFailed ? 1 : 0);
+}
@@ -0,0 +1,354 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Subsystem/WeaponSubsystem.h"
+
+#include "Engine/World.h"
+#include "Interfaces/PawnDamageInterface.h"
+#include "Kismet/GameplayStatics.h"
+#include "Memory/WeaponFrameArena.h"
+#include "Memory/WeaponObjectCreationTracker.h"
+#include "Projectile/WeaponProjectileActor.h"
+#include "Trace/WeaponCsvStats.h"
+#include "Trace/WeaponShotTrace.h"
+#include "UObject/UObjectGlobals.h"
+#include "Weapon/BallisticTable.h"
+#include "Weapon/RangedWeapon.h"
+#include "Weapon/WeaponDefinition.h"
+#include "Weapon/WeaponDefinitionDatabase.h"
+
+static TAutoConsoleVariable<float> CVarWeaponSimFixedStepHz(
+	TEXT("weapon.Sim.FixedStepHz"),
+	60.0f,
+	TEXT("Rate of the fixed-step weapon simulation, 0 to step once per frame."));
+
+static TAutoConsoleVariable<int32> CVarWeaponSimMaxStepsPerFrame(
+	TEXT("weapon.Sim.MaxStepsPerFrame"),
+	8,
+	TEXT("Fixed steps run at most per frame, time beyond that is dropped after a hitch."));
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Cosmetic shots/s"), STAT_ShotCosmeticShotsPerSecond, STATGROUP_WeaponNet);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Cosmetic shot RPCs/s"), STAT_ShotCosmeticRPCsPerSecond, STATGROUP_WeaponNet);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Cosmetic shot payload bytes/s"), STAT_ShotCosmeticBytesPerSecond, STATGROUP_WeaponNet);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Weapon drop updates/s"), STAT_WeaponDropUpdatesPerSecond, STATGROUP_WeaponNet);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Weapon drop payload bytes/s"), STAT_WeaponDropBytesPerSecond, STATGROUP_WeaponNet);
+
+
+void UWeaponSubsystem::Initialize(FSubsystemCollectionBase& Collection) {
+	Super::Initialize(Collection);
+
+	// The integration task resolves weak pointers, so it must be done before anything is collected
+	PreGarbageCollectHandle = FCoreUObjectDelegates::GetPreGarbageCollectDelegate().AddWeakLambda(this, [this]() {
+		ProjectileSimulation.WaitForIntegrate();
+		ProjectileActorPool.OnPreGarbageCollect();
+	});
+	PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddWeakLambda(this, [this]() {
+		ProjectileActorPool.OnPostGarbageCollect();
+	});
+}
+
+
+void UWeaponSubsystem::Deinitialize() {
+	FCoreUObjectDelegates::GetPreGarbageCollectDelegate().Remove(PreGarbageCollectHandle);
+	FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+
+	GunfireOcclusionCache.Reset();
+	GunfireStimulusAggregator.Reset();
+	HitboxHistory.Reset();
+	ProjectileSimulation.Reset();
+	ProjectileInstanceRenderer.Reset();
+	ProjectileActorPool.Reset();
+	PendingShotCosmeticWeapons.Reset();
+	ShotInterestManager.Reset();
+	AbstractCombatResolver.Reset();
+	HitFeedbackAggregator.Reset();
+	SentryTurretManager.Reset();
+	FBallisticTable::ResetCache();
+
+	Super::Deinitialize();
+}
+
+
+void UWeaponSubsystem::OnWorldBeginPlay(UWorld& InWorld) {
+	Super::OnWorldBeginPlay(InWorld);
+
+	ProjectileSimulation.LoadStaticOccupancy(&InWorld);
+}
+
+
+/**
+ * Advances every shared weapon system by one frame.
+ *
+ * @param DeltaTime Frame time increment
+ * @note Projectiles fired this frame are caught up before regular integration,
+ *       so they advance by this frame's steps as well as their catch-up time
+ * @remark Projectile integration runs in fixed steps on a worker and overlaps the
+ *         rest of the frame, its hits are resolved at the start of the next Tick
+ * @see WeaponCsvStats.h for the per-stage CSV timings
+ */
+void UWeaponSubsystem::Tick(float DeltaTime) {
+	Super::Tick(DeltaTime);
+
+	FWeaponObjectCreationScope ObjectCreationScope;
+	UWorld* World = GetWorld();
+
+	FinishProjectileIntegration();
+
+	// Lag compensation history is only needed where projectiles are authoritative
+	if (World->GetNetMode() != NM_Client) {
+		{
+			CSV_WEAPON_SCOPED_TIMING(HitboxHistory);
+			HitboxHistory.Record(World);
+		}
+		{
+			// Reuses the capsules just recorded, sentries add no world iteration of their own
+			CSV_WEAPON_SCOPED_TIMING(SentryTurrets);
+			SentryTurretManager.Tick(World, HitboxHistory.GetNewestCapsules());
+		}
+	}
+
+	{
+		CSV_WEAPON_SCOPED_TIMING(ProjectileCatchUp);
+		ProjectileSimulation.RunCatchUp(World, HitboxHistory, ProjectileImpacts);
+	}
+	HandleProjectileImpacts(ProjectileImpacts);
+	ProjectileImpacts.Reset();
+
+	// Same steps at any frame rate, so weapons behave identically on a 30 Hz and a 120 Hz server
+	const float FixedStepHz = CVarWeaponSimFixedStepHz.GetValueOnGameThread();
+	const float StepTime = FixedStepHz > 0.0f ? 1.0f / FixedStepHz : DeltaTime;
+	int32 NumSteps = 0;
+	if (StepTime > 0.0f) {
+		const int32 MaxStepsPerFrame = FMath::Max(CVarWeaponSimMaxStepsPerFrame.GetValueOnGameThread(), 1);
+		SimulationAccumulator += DeltaTime;
+		NumSteps = FMath::FloorToInt32(SimulationAccumulator / StepTime);
+		SimulationAccumulator -= NumSteps * StepTime;
+		NumSteps = FMath::Min(NumSteps, MaxStepsPerFrame);
+		SimulationTime += NumSteps * StepTime;
+		MaxSimulationAdvance = MaxStepsPerFrame * StepTime;
+	}
+
+	CSV_WEAPON_SET(Projectiles, ProjectileSimulation.Num());
+
+	// Drawn before the steps start, where the rounds will be once they are done
+	{
+		CSV_WEAPON_SCOPED_TIMING(ProjectileRender);
+		ProjectileInstanceRenderer.Update(World, ProjectileSimulation, NumSteps * StepTime + SimulationAccumulator);
+	}
+	{
+		CSV_WEAPON_SCOPED_TIMING(ProjectileBroadphase);
+		ProjectileSimulation.BeginIntegrate(World, StepTime, NumSteps);
+	}
+	{
+		CSV_WEAPON_SCOPED_TIMING(GunfireOcclusion);
+		GunfireOcclusionCache.Tick(GetWorld(), DeltaTime);
+	}
+	{
+		CSV_WEAPON_SCOPED_TIMING(GunfireStimulus);
+		GunfireStimulusAggregator.Tick(GetWorld());
+	}
+
+	// Runs after every actor has ticked, so each weapon sends one batch for the whole frame
+	{
+		CSV_WEAPON_SCOPED_TIMING(ShotCosmetics);
+		for (const TWeakObjectPtr<ARangedWeapon>& Weapon : PendingShotCosmeticWeapons) {
+			if (Weapon.IsValid()) {
+				Weapon->FlushShotCosmetics();
+			}
+		}
+		PendingShotCosmeticWeapons.Reset();
+	}
+
+	if (World->GetNetMode() != NM_Client) {
+		{
+			CSV_WEAPON_SCOPED_TIMING(ShotInterest);
+			ShotInterestManager.Tick(World);
+		}
+		{
+			CSV_WEAPON_SCOPED_TIMING(HitFeedback);
+			HitFeedbackAggregator.Flush();
+		}
+	}
+
+	ProjectileActorPool.Tick(World);
+	FWeaponObjectCreationTracker::Get().Tick();
+
+	const double CurrentTime = World->GetRealTimeSeconds();
+	if (CurrentTime - ShotCosmeticTraffic.WindowStartTime >= 1.0) {
+		const double WindowDuration = CurrentTime - ShotCosmeticTraffic.WindowStartTime;
+		SET_DWORD_STAT(STAT_ShotCosmeticShotsPerSecond, FMath::RoundToInt(ShotCosmeticTraffic.NumShots / WindowDuration));
+		SET_DWORD_STAT(STAT_ShotCosmeticRPCsPerSecond, FMath::RoundToInt(ShotCosmeticTraffic.NumRPCs / WindowDuration));
+		SET_DWORD_STAT(STAT_ShotCosmeticBytesPerSecond, FMath::RoundToInt(ShotCosmeticTraffic.NumBits / (8.0 * WindowDuration)));
+		SET_DWORD_STAT(STAT_WeaponDropUpdatesPerSecond, FMath::RoundToInt(WeaponDropTraffic.NumUpdates / WindowDuration));
+		SET_DWORD_STAT(STAT_WeaponDropBytesPerSecond, FMath::RoundToInt(WeaponDropTraffic.NumBits / (8.0 * WindowDuration)));
+
+		WeaponDropTraffic = FWeaponDropTraffic();
+		ShotCosmeticTraffic = FShotCosmeticTraffic();
+		ShotCosmeticTraffic.WindowStartTime = CurrentTime;
+	}
+
+	// Transient shot data never outlives the frame
+	FWeaponFrameArena::Get().Reset();
+}
+
+
+void UWeaponSubsystem::ForEachPoolSize(TFunctionRef<void(const TCHAR*, int64)> Report) {
+	// The in-flight arrays belong to the integration task until it is done
+	ProjectileSimulation.WaitForIntegrate();
+
+	Report(TEXT("ProjectilesInFlight"), ProjectileSimulation.Num());
+	Report(TEXT("ProjectileDefinitions"), ProjectileSimulation.NumDefinitions());
+	Report(TEXT("DormantProjectileActors"), ProjectileActorPool.NumDormant());
+	Report(TEXT("PendingShotCosmeticWeapons"), PendingShotCosmeticWeapons.Num());
+	Report(TEXT("SentryTurrets"), SentryTurretManager.Num());
+}
+
+
+TStatId UWeaponSubsystem::GetStatId() const {
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UWeaponSubsystem, STATGROUP_Tickables);
+}
+
+
+ARangedWeapon* UWeaponSubsystem::SpawnWeapon(const FPrimaryAssetId& DefinitionId, const FTransform& Transform) {
+	TSubclassOf<ARangedWeapon> WeaponClass;
+	if (const FCookedWeaponDefinition* CookedDefinition = FWeaponDefinitionDatabase::Get().Find(DefinitionId)) {
+		WeaponClass = UWeaponDefinition::GetWeaponClass(static_cast<EWeaponDelivery>(CookedDefinition->Delivery));
+	} else if (const UWeaponDefinition* Definition = UWeaponDefinition::Load(DefinitionId)) {
+		WeaponClass = Definition->GetWeaponClass();
+	} else {
+		return nullptr;
+	}
+
+	// Deferred so the ID is set before begin play applies it
+	ARangedWeapon* Weapon = GetWorld()->SpawnActorDeferred<ARangedWeapon>(WeaponClass, Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	if (Weapon) {
+		Weapon->SetWeaponDefinitionId(DefinitionId);
+		Weapon->FinishSpawning(Transform);
+	}
+
+	return Weapon;
+}
+
+
+float UWeaponSubsystem::GetGunfireVolumeMultiplier(const FVector& ShooterLocation) {
+	return GunfireOcclusionCache.GetVolumeMultiplier(GetWorld(), ShooterLocation);
+}
+
+
+void UWeaponSubsystem::ReportGunfire(AActor* Shooter, const FVector& Location, float Loudness, float MaxRange) {
+	GunfireStimulusAggregator.ReportShot(Shooter, Location, Loudness, MaxRange);
+}
+
+
+int32 UWeaponSubsystem::RegisterProjectileDefinition(const FProjectileDefinition& Definition) {
+	return ProjectileSimulation.RegisterDefinition(Definition);
+}
+
+
+void UWeaponSubsystem::LaunchProjectile(const FProjectileLaunchParams& LaunchParams) {
+	ProjectileSimulation.Launch(LaunchParams);
+}
+
+
+AWeaponProjectileActor* UWeaponSubsystem::LaunchProjectileActor(TSubclassOf<AWeaponProjectileActor> ActorClass, const FProjectileLaunchParams& LaunchParams) {
+	if (LaunchParams.DefinitionIndex == INDEX_NONE) {
+		return nullptr;
+	}
+
+	AWeaponProjectileActor* Actor = ProjectileActorPool.Acquire(GetWorld(), ActorClass);
+	if (Actor) {
+		Actor->Launch(LaunchParams, ProjectileSimulation.GetDefinition(LaunchParams.DefinitionIndex));
+	}
+
+	return Actor;
+}
+
+
+void UWeaponSubsystem::ReleaseProjectileActor(AWeaponProjectileActor* Actor) {
+	ProjectileActorPool.Release(Actor);
+}
+
+
+void UWeaponSubsystem::PrewarmProjectileActors(TSubclassOf<AWeaponProjectileActor> ActorClass, int32 Count) {
+	ProjectileActorPool.Prewarm(GetWorld(), ActorClass, Count);
+}
+
+
+/**
+ * Applies weapon damage through IPawnDamageInterface.
+ *
+ * @note Actors not implementing the interface only receive the impact effect
+ */
+void UWeaponSubsystem::ApplyWeaponDamage(float DamageAmount, AController* InstigatorController, AActor* DamageCauser, FHitResult& HitResult, UParticleSystem* ImpactParticle) {
+	FWeaponObjectCreationScope ObjectCreationScope;
+	UWorld* World = GetWorld();
+	AActor* HitActor = HitResult.GetActor();
+
+	if (HitActor && HitActor->Implements<UPawnDamageInterface>()) {
+		if (World->GetNetMode() != NM_Client) {
+			CSV_WEAPON_COUNT(DamageEvents, 1);
+			IPawnDamageInterface::Execute_ApplyDamage(HitActor, DamageAmount, InstigatorController, DamageCauser, HitResult, ImpactParticle);
+			HitFeedbackAggregator.ReportHit(InstigatorController, HitActor, HitResult.ImpactPoint, DamageAmount);
+		}
+		return;
+	}
+
+	if (ImpactParticle && World->GetNetMode() != NM_DedicatedServer) {
+		UGameplayStatics::SpawnEmitterAtLocation(World, ImpactParticle, HitResult.ImpactPoint, HitResult.ImpactNormal.Rotation(), FVector(1.0f), true, EPSCPoolMethod::AutoRelease);
+		CSV_WEAPON_COUNT(Effects, 1);
+	}
+}
+
+
+void UWeaponSubsystem::QueueShotCosmeticFlush(ARangedWeapon* Weapon) {
+	PendingShotCosmeticWeapons.AddUnique(Weapon);
+}
+
+
+int32 UWeaponSubsystem::DeliverShotCosmetics(ARangedWeapon* Weapon, const FShotCosmeticBatch& Batch, float AudibleRange, float VisibleRange) {
+	return ShotInterestManager.Deliver(GetWorld(), Weapon, Batch, AudibleRange, VisibleRange);
+}
+
+
+bool UWeaponSubsystem::IsObservedByPlayer(const FVector& ShotOrigin, const FVector& ShotEnd, float AudibleRange, float VisibleRange) {
+	return ShotInterestManager.IsObserved(GetWorld(), ShotOrigin, ShotEnd, AudibleRange, VisibleRange);
+}
+
+
+void UWeaponSubsystem::RecordShotCosmeticRPCs(int32 NumRPCs, int32 NumShots, int64 NumBits) {
+	ShotCosmeticTraffic.NumShots += NumShots;
+	ShotCosmeticTraffic.NumRPCs += NumRPCs;
+	ShotCosmeticTraffic.NumBits += NumRPCs * NumBits;
+}
+
+
+void UWeaponSubsystem::RecordWeaponDropUpdates(int32 NumConnections, int64 NumBits) {
+	WeaponDropTraffic.NumUpdates += NumConnections;
+	WeaponDropTraffic.NumBits += NumConnections * NumBits;
+}
+
+
+void UWeaponSubsystem::FinishProjectileIntegration() {
+	{
+		// Time the game thread spends blocked on the worker
+		CSV_WEAPON_SCOPED_TIMING(ProjectileWait);
+		ProjectileSimulation.FinishIntegrate(ProjectileImpacts);
+	}
+	HandleProjectileImpacts(ProjectileImpacts);
+	ProjectileImpacts.Reset();
+}
+
+
+void UWeaponSubsystem::HandleProjectileImpacts(TArray<FProjectileImpact>& Impacts) {
+	CSV_WEAPON_SCOPED_TIMING(ProjectileImpacts);
+
+	for (FProjectileImpact& Impact : Impacts) {
+		const FProjectileDefinition& Definition = ProjectileSimulation.GetDefinition(Impact.DefinitionIndex);
+		TRACE_WEAPON_PELLET(Cast<ARangedWeapon>(Impact.DamageCauser.Get()), Impact.HitResult);
+		ApplyWeaponDamage(Definition.Damage, Impact.InstigatorController.Get(), Impact.DamageCauser.Get(), Impact.HitResult, Definition.ImpactParticle.Get());
+	}
+}
+
+
+bool UWeaponSubsystem::DoesSupportWorldType(const EWorldType::Type WorldType) const {
+	return WorldType == EWorldType::Game || WorldType == EWorldType::PIE;
+}
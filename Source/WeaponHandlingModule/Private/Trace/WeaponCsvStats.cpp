@@ -0,0 +1,56 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Trace/WeaponCsvStats.h"
+
+#include "Weapon/RangedWeapon.h"
+
+#if WEAPON_CSV_STATS_ENABLED
+
+CSV_DEFINE_CATEGORY_MODULE(WEAPONHANDLINGMODULE_API, Weapon, true);
+CSV_DEFINE_CATEGORY_MODULE(WEAPONHANDLINGMODULE_API, WeaponClass, false);
+
+namespace WeaponCsvStats {
+	struct FClassStatNames {
+		FName Shots;
+		FName FireTime;
+	};
+
+	/** Column names per definition or class name, kept for the process lifetime */
+	const FClassStatNames& GetClassStatNames(const FName ColumnPrefix) {
+		static TMap<FName, FClassStatNames> ClassStatNames;
+
+		if (const FClassStatNames* Found = ClassStatNames.Find(ColumnPrefix)) {
+			return *Found;
+		}
+
+		const FString Prefix = ColumnPrefix.ToString();
+		return ClassStatNames.Add(ColumnPrefix, { FName(Prefix + TEXT("/Shots")), FName(Prefix + TEXT("/FireTime")) });
+	}
+}
+
+
+/**
+ * @note Variants share the native weapon classes, so the definition name is what tells them apart
+ */
+FWeaponClassCsvScope::FWeaponClassCsvScope(const ARangedWeapon* Weapon) {
+	if (!Weapon || !FCsvProfiler::Get()->IsCapturing()) {
+		return;
+	}
+
+	const FPrimaryAssetId& DefinitionId = Weapon->GetWeaponDefinitionId();
+	const FName ColumnPrefix = DefinitionId.IsValid() ? DefinitionId.PrimaryAssetName : Weapon->GetClass()->GetFName();
+	const WeaponCsvStats::FClassStatNames& StatNames = WeaponCsvStats::GetClassStatNames(ColumnPrefix);
+	FireTimeStatName = StatNames.FireTime;
+
+	FCsvProfiler::RecordCustomStat(StatNames.Shots, CSV_CATEGORY_INDEX(WeaponClass), 1, ECsvCustomStatOp::Accumulate);
+	FCsvProfiler::BeginStat(FireTimeStatName, CSV_CATEGORY_INDEX(WeaponClass));
+}
+
+
+FWeaponClassCsvScope::~FWeaponClassCsvScope() {
+	if (!FireTimeStatName.IsNone()) {
+		FCsvProfiler::EndStat(FireTimeStatName, CSV_CATEGORY_INDEX(WeaponClass));
+	}
+}
+
+#endif
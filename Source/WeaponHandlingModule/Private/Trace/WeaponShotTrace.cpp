@@ -0,0 +1,107 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Trace/WeaponShotTrace.h"
+
+#if WEAPON_SHOT_TRACE_ENABLED
+
+#include "Engine/HitResult.h"
+#include "GameFramework/Controller.h"
+#include "HAL/PlatformTime.h"
+#include "Weapon/RangedWeapon.h"
+
+UE_TRACE_CHANNEL_DEFINE(WeaponShotChannel)
+
+UE_TRACE_EVENT_BEGIN(WeaponShot, Shot)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(double, RecordingTime)
+	UE_TRACE_EVENT_FIELD(uint64, WeaponId)
+	UE_TRACE_EVENT_FIELD(uint64, InstigatorId)
+	UE_TRACE_EVENT_FIELD(float[], Muzzle)
+	UE_TRACE_EVENT_FIELD(float[], AimRay)
+	UE_TRACE_EVENT_FIELD(float, FireInterval)
+	UE_TRACE_EVENT_FIELD(uint16, NumPellets)
+	UE_TRACE_EVENT_FIELD(uint8, FiringMode)
+	UE_TRACE_EVENT_FIELD(uint8, BurstShotCount)
+	UE_TRACE_EVENT_FIELD(bool, bBurstCooldown)
+UE_TRACE_EVENT_END()
+
+UE_TRACE_EVENT_BEGIN(WeaponShot, Pellet)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(double, RecordingTime)
+	UE_TRACE_EVENT_FIELD(uint64, WeaponId)
+	UE_TRACE_EVENT_FIELD(uint64, HitActorId)
+	UE_TRACE_EVENT_FIELD(float[], Ray)
+	UE_TRACE_EVENT_FIELD(float[], HitLocation)
+	UE_TRACE_EVENT_FIELD(bool, bHit)
+UE_TRACE_EVENT_END()
+
+
+/**
+ * Writes the muzzle as location and rotation, the aim ray as start and end.
+ *
+ * @note Also traces the weapon object so the Rewind Debugger can list it
+ */
+void FWeaponShotTrace::OutputShot(const ARangedWeapon* Weapon, const AController* InstigatorController, const FTransform& MuzzleTransform, float AimRange,
+	uint8 FiringMode, uint8 BurstShotCount, bool bBurstCooldown, float FireInterval, int32 NumPellets) {
+	if (!Weapon) {
+		return;
+	}
+
+	TRACE_OBJECT(Weapon);
+
+	const FVector MuzzleLocation = MuzzleTransform.GetLocation();
+	const FRotator MuzzleRotation = MuzzleTransform.Rotator();
+	const float Muzzle[6] = {
+		static_cast<float>(MuzzleLocation.X), static_cast<float>(MuzzleLocation.Y), static_cast<float>(MuzzleLocation.Z),
+		static_cast<float>(MuzzleRotation.Pitch), static_cast<float>(MuzzleRotation.Yaw), static_cast<float>(MuzzleRotation.Roll)
+	};
+
+	FVector AimStart = MuzzleLocation;
+	FRotator AimRotation = MuzzleRotation;
+	if (InstigatorController) {
+		InstigatorController->GetPlayerViewPoint(AimStart, AimRotation);
+	}
+	const FVector AimEnd = AimStart + AimRotation.Vector() * AimRange;
+	const float AimRay[6] = {
+		static_cast<float>(AimStart.X), static_cast<float>(AimStart.Y), static_cast<float>(AimStart.Z),
+		static_cast<float>(AimEnd.X), static_cast<float>(AimEnd.Y), static_cast<float>(AimEnd.Z)
+	};
+
+	UE_TRACE_LOG(WeaponShot, Shot, WeaponShotChannel)
+		<< Shot.Cycle(FPlatformTime::Cycles64())
+		<< Shot.RecordingTime(FObjectTrace::GetWorldElapsedTime(Weapon->GetWorld()))
+		<< Shot.WeaponId(FObjectTrace::GetObjectId(Weapon))
+		<< Shot.InstigatorId(FObjectTrace::GetObjectId(InstigatorController))
+		<< Shot.Muzzle(Muzzle, UE_ARRAY_COUNT(Muzzle))
+		<< Shot.AimRay(AimRay, UE_ARRAY_COUNT(AimRay))
+		<< Shot.FireInterval(FireInterval)
+		<< Shot.NumPellets(static_cast<uint16>(NumPellets))
+		<< Shot.FiringMode(FiringMode)
+		<< Shot.BurstShotCount(BurstShotCount)
+		<< Shot.bBurstCooldown(bBurstCooldown);
+}
+
+
+void FWeaponShotTrace::OutputPellet(const ARangedWeapon* Weapon, const FHitResult& HitResult) {
+	if (!Weapon) {
+		return;
+	}
+
+	const FVector HitLocation = HitResult.bBlockingHit ? HitResult.ImpactPoint : HitResult.TraceEnd;
+	const float Ray[6] = {
+		static_cast<float>(HitResult.TraceStart.X), static_cast<float>(HitResult.TraceStart.Y), static_cast<float>(HitResult.TraceStart.Z),
+		static_cast<float>(HitResult.TraceEnd.X), static_cast<float>(HitResult.TraceEnd.Y), static_cast<float>(HitResult.TraceEnd.Z)
+	};
+	const float Hit[3] = { static_cast<float>(HitLocation.X), static_cast<float>(HitLocation.Y), static_cast<float>(HitLocation.Z) };
+
+	UE_TRACE_LOG(WeaponShot, Pellet, WeaponShotChannel)
+		<< Pellet.Cycle(FPlatformTime::Cycles64())
+		<< Pellet.RecordingTime(FObjectTrace::GetWorldElapsedTime(Weapon->GetWorld()))
+		<< Pellet.WeaponId(FObjectTrace::GetObjectId(Weapon))
+		<< Pellet.HitActorId(FObjectTrace::GetObjectId(HitResult.GetActor()))
+		<< Pellet.Ray(Ray, UE_ARRAY_COUNT(Ray))
+		<< Pellet.HitLocation(Hit, UE_ARRAY_COUNT(Hit))
+		<< Pellet.bHit(HitResult.bBlockingHit);
+}
+
+#endif
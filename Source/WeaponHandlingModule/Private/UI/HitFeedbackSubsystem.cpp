@@ -0,0 +1,72 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "UI/HitFeedbackSubsystem.h"
+
+#include "Engine/GameViewportClient.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/World.h"
+#include "UI/SHitFeedbackOverlay.h"
+
+static TAutoConsoleVariable<int32> CVarHitFeedbackPoolSize(
+	TEXT("weapon.UI.HitFeedbackPoolSize"),
+	32,
+	TEXT("Damage numbers shown at once, the oldest is recycled when full. Applied when the overlay is created."));
+
+namespace HitFeedbackSubsystem {
+	// Above the game HUD
+	constexpr int32 OverlayZOrder = 10;
+}
+
+
+void UHitFeedbackSubsystem::Deinitialize() {
+	RemoveOverlay();
+
+	Super::Deinitialize();
+}
+
+
+void UHitFeedbackSubsystem::AddHits(TConstArrayView<FHitFeedback> Hits) {
+	if (Hits.Num() == 0) {
+		return;
+	}
+
+	if (SHitFeedbackOverlay* HitFeedbackOverlay = FindOrAddOverlay()) {
+		HitFeedbackOverlay->AddHits(Hits);
+	}
+}
+
+
+SHitFeedbackOverlay* UHitFeedbackSubsystem::FindOrAddOverlay() {
+	ULocalPlayer* LocalPlayer = GetLocalPlayer();
+	UWorld* World = LocalPlayer->GetWorld();
+	if (Overlay.IsValid() && OverlayWorld == World) {
+		return Overlay.Get();
+	}
+
+	RemoveOverlay();
+
+	APlayerController* PlayerController = LocalPlayer->GetPlayerController(World);
+	UGameViewportClient* ViewportClient = World ? World->GetGameViewport() : nullptr;
+	if (!PlayerController || !ViewportClient) {
+		return nullptr;
+	}
+
+	Overlay = SNew(SHitFeedbackOverlay, PlayerController)
+		.PoolSize(CVarHitFeedbackPoolSize.GetValueOnGameThread());
+	ViewportClient->AddViewportWidgetForPlayer(LocalPlayer, Overlay.ToSharedRef(), HitFeedbackSubsystem::OverlayZOrder);
+	OverlayWorld = World;
+
+	return Overlay.Get();
+}
+
+
+void UHitFeedbackSubsystem::RemoveOverlay() {
+	UWorld* World = OverlayWorld.Get();
+	UGameViewportClient* ViewportClient = World ? World->GetGameViewport() : nullptr;
+	if (Overlay.IsValid() && ViewportClient) {
+		ViewportClient->RemoveViewportWidgetForPlayer(GetLocalPlayer(), Overlay.ToSharedRef());
+	}
+
+	Overlay.Reset();
+	OverlayWorld.Reset();
+}
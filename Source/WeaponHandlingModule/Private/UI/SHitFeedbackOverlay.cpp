@@ -0,0 +1,150 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "UI/SHitFeedbackOverlay.h"
+
+#include "GameFramework/PlayerController.h"
+#include "Net/ShotCosmeticBatch.h"
+#include "Rendering/DrawElements.h"
+#include "Styling/CoreStyle.h"
+
+static TAutoConsoleVariable<float> CVarHitNumberLifetime(
+	TEXT("weapon.UI.HitNumberLifetime"),
+	1.0f,
+	TEXT("Seconds a damage number stays on screen after the last hit it shows."));
+
+static TAutoConsoleVariable<float> CVarHitMarkerDuration(
+	TEXT("weapon.UI.HitMarkerDuration"),
+	0.15f,
+	TEXT("Seconds the hit marker shows after a confirmed hit."));
+
+namespace HitFeedbackOverlay {
+	// Upward drift of damage numbers (slate units per second)
+	constexpr float RiseSpeed = 40.0f;
+
+	// Hit marker arm start and end distance from the screen center (slate units)
+	constexpr float MarkerInnerRadius = 6.0f;
+	constexpr float MarkerOuterRadius = 14.0f;
+}
+
+
+void SHitFeedbackOverlay::Construct(const FArguments& InArgs, APlayerController* InPlayerController) {
+	PlayerController = InPlayerController;
+	HitNumbers.SetNum(FMath::Max(InArgs._PoolSize, 1));
+	Font = FCoreStyle::GetDefaultFontStyle("Bold", 18);
+
+	SetCanTick(true);
+	SetVisibility(EVisibility::HitTestInvisible);
+}
+
+
+void SHitFeedbackOverlay::AddHits(TConstArrayView<FHitFeedback> Hits) {
+	for (const FHitFeedback& Hit : Hits) {
+		FHitNumber& HitNumber = FindOrRecycle(Hit.Target);
+		if (!HitNumber.bActive) {
+			HitNumber.Damage = 0.0f;
+		}
+
+		HitNumber.Target = Hit.Target;
+		HitNumber.WorldLocation = Hit.Location;
+		HitNumber.Damage += Hit.Damage;
+		HitNumber.Age = 0.0f;
+		HitNumber.bActive = true;
+
+		HitNumber.Text.Reset();
+		HitNumber.Text.AppendInt(FMath::RoundToInt32(HitNumber.Damage));
+	}
+
+	HitMarkerAge = 0.0f;
+}
+
+
+/**
+ * Ages elements and projects the live ones into this widget's space.
+ */
+void SHitFeedbackOverlay::Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime) {
+	const float Lifetime = CVarHitNumberLifetime.GetValueOnGameThread();
+	const APlayerController* OwningPlayerController = PlayerController.Get();
+	bool bAnyActive = false;
+
+	for (FHitNumber& HitNumber : HitNumbers) {
+		if (!HitNumber.bActive) {
+			continue;
+		}
+
+		HitNumber.Age += InDeltaTime;
+		if (HitNumber.Age > Lifetime || !OwningPlayerController) {
+			HitNumber.bActive = false;
+			continue;
+		}
+		bAnyActive = true;
+
+		FVector2D ViewportPosition;
+		HitNumber.bOnScreen = OwningPlayerController->ProjectWorldLocationToScreen(HitNumber.WorldLocation, ViewportPosition, true);
+		HitNumber.ScreenPosition = ViewportPosition / AllottedGeometry.Scale - FVector2D(0.0f, HitNumber.Age * HitFeedbackOverlay::RiseSpeed);
+	}
+
+	HitMarkerAge += InDeltaTime;
+
+	if (bAnyActive || HitMarkerAge <= CVarHitMarkerDuration.GetValueOnGameThread() + InDeltaTime) {
+		Invalidate(EInvalidateWidgetReason::Paint);
+	}
+}
+
+
+int32 SHitFeedbackOverlay::OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const {
+	const float Lifetime = FMath::Max(CVarHitNumberLifetime.GetValueOnGameThread(), UE_KINDA_SMALL_NUMBER);
+
+	for (const FHitNumber& HitNumber : HitNumbers) {
+		if (!HitNumber.bActive || !HitNumber.bOnScreen) {
+			continue;
+		}
+
+		const FLinearColor Color(1.0f, 0.9f, 0.3f, 1.0f - HitNumber.Age / Lifetime);
+		FSlateDrawElement::MakeText(OutDrawElements, LayerId,
+			AllottedGeometry.ToPaintGeometry(FVector2f(200.0f, 40.0f), FSlateLayoutTransform(FVector2f(HitNumber.ScreenPosition))),
+			HitNumber.Text, Font, ESlateDrawEffect::None, Color * InWidgetStyle.GetColorAndOpacityTint());
+	}
+
+	const float HitMarkerDuration = CVarHitMarkerDuration.GetValueOnGameThread();
+	if (HitMarkerAge <= HitMarkerDuration) {
+		const FVector2f Center = AllottedGeometry.GetLocalSize() * 0.5f;
+		const FLinearColor Color(1.0f, 1.0f, 1.0f, 1.0f - HitMarkerAge / FMath::Max(HitMarkerDuration, UE_KINDA_SMALL_NUMBER));
+		const FVector2f Diagonals[] = { FVector2f(1.0f, 1.0f), FVector2f(-1.0f, 1.0f), FVector2f(1.0f, -1.0f), FVector2f(-1.0f, -1.0f) };
+
+		for (const FVector2f& Diagonal : Diagonals) {
+			const TArray<FVector2f> Points = { Center + Diagonal * HitFeedbackOverlay::MarkerInnerRadius, Center + Diagonal * HitFeedbackOverlay::MarkerOuterRadius };
+			FSlateDrawElement::MakeLines(OutDrawElements, LayerId, AllottedGeometry.ToPaintGeometry(), Points, ESlateDrawEffect::None, Color * InWidgetStyle.GetColorAndOpacityTint(), true, 2.0f);
+		}
+	}
+
+	return LayerId;
+}
+
+
+FVector2D SHitFeedbackOverlay::ComputeDesiredSize(float LayoutScaleMultiplier) const {
+	return FVector2D::ZeroVector;
+}
+
+
+/**
+ * Picks the live element of the target, else a free one, else the oldest.
+ */
+SHitFeedbackOverlay::FHitNumber& SHitFeedbackOverlay::FindOrRecycle(const AActor* Target) {
+	FHitNumber* Oldest = &HitNumbers[0];
+	FHitNumber* Free = nullptr;
+
+	for (FHitNumber& HitNumber : HitNumbers) {
+		if (!HitNumber.bActive) {
+			Free = Free ? Free : &HitNumber;
+			continue;
+		}
+		if (HitNumber.Target == Target) {
+			return HitNumber;
+		}
+		if (HitNumber.Age > Oldest->Age || !Oldest->bActive) {
+			Oldest = &HitNumber;
+		}
+	}
+
+	return Free ? *Free : *Oldest;
+}
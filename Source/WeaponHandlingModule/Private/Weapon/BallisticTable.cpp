@@ -0,0 +1,218 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Weapon/BallisticTable.h"
+
+#include "UObject/ObjectKey.h"
+
+namespace BallisticTable {
+	// Integration step used when building tables (seconds)
+	constexpr float BuildStepTime = 1.0f / 240.0f;
+
+	// Upper bound on simulated flight so degenerate definitions cannot stall loading
+	constexpr float MaxBuildFlightTime = 60.0f;
+
+	using FTableKey = TTuple<FObjectKey, float, float, float, float, float>;
+
+	TMap<FTableKey, TSharedRef<const FBallisticTable>>& GetTableCache() {
+		static TMap<FTableKey, TSharedRef<const FBallisticTable>> TableCache;
+		return TableCache;
+	}
+
+	/**
+	 * Solves |Delta + Velocity * t| = Speed * t for the earliest positive t.
+	 *
+	 * @return False if the target outruns the projectile
+	 */
+	bool SolveInterceptTime(const FVector& Delta, const FVector& Velocity, float Speed, float& OutTime) {
+		const float A = Velocity.SizeSquared() - FMath::Square(Speed);
+		const float B = 2.0f * FVector::DotProduct(Delta, Velocity);
+		const float C = Delta.SizeSquared();
+
+		// Target and projectile equally fast - equation degenerates to linear
+		if (FMath::IsNearlyZero(A)) {
+			if (B >= 0.0f) {
+				return false;
+			}
+			OutTime = -C / B;
+			return true;
+		}
+
+		const float Discriminant = FMath::Square(B) - 4.0f * A * C;
+		if (Discriminant < 0.0f) {
+			return false;
+		}
+
+		const float Root = FMath::Sqrt(Discriminant);
+		const float FirstTime = (-B - Root) / (2.0f * A);
+		const float SecondTime = (-B + Root) / (2.0f * A);
+
+		// Prefer the earliest intercept that lies in the future
+		if (FirstTime > 0.0f && (SecondTime <= 0.0f || FirstTime < SecondTime)) {
+			OutTime = FirstTime;
+			return true;
+		}
+		if (SecondTime > 0.0f) {
+			OutTime = SecondTime;
+			return true;
+		}
+		return false;
+	}
+}
+
+
+/**
+ * Returns the shared table for a set of ballistic parameters.
+ *
+ * @note Tables are built at most once per asset and parameter set, so weapons sharing a
+ *       definition share a table and a changed definition simply resolves to a new one
+ */
+TSharedRef<const FBallisticTable> FBallisticTable::FindOrBuild(const UObject* Source, float MuzzleSpeed, float GravityZ, float DragCoefficient, float MaxFlightTime, float MaxRange) {
+	check(IsInGameThread());
+
+	const BallisticTable::FTableKey Key(FObjectKey(Source), MuzzleSpeed, GravityZ, DragCoefficient, MaxFlightTime, MaxRange);
+	if (const TSharedRef<const FBallisticTable>* ExistingTable = BallisticTable::GetTableCache().Find(Key)) {
+		return *ExistingTable;
+	}
+
+	const TSharedRef<FBallisticTable> NewTable = MakeShareable(new FBallisticTable());
+	NewTable->Build(MuzzleSpeed, GravityZ, DragCoefficient, MaxFlightTime, MaxRange);
+	BallisticTable::GetTableCache().Add(Key, NewTable);
+	return NewTable;
+}
+
+
+void FBallisticTable::Invalidate(const UObject* Source) {
+	check(IsInGameThread());
+
+	const FObjectKey SourceKey(Source);
+	for (auto It = BallisticTable::GetTableCache().CreateIterator(); It; ++It) {
+		if (It->Key.Get<0>() == SourceKey) {
+			It.RemoveCurrent();
+		}
+	}
+}
+
+
+void FBallisticTable::ResetCache() {
+	check(IsInGameThread());
+
+	BallisticTable::GetTableCache().Empty();
+}
+
+
+/**
+ * Integrates a horizontal shot under gravity and quadratic drag.
+ *
+ * @note Samples are interpolated between integration steps so table accuracy does
+ *       not depend on the step size lining up with the range spacing
+ */
+void FBallisticTable::Build(float InMuzzleSpeed, float InGravityZ, float InDragCoefficient, float InMaxFlightTime, float InMaxRange) {
+	MuzzleSpeed = InMuzzleSpeed;
+	RangeStep = InMaxRange / (NumSamples - 1);
+	MaxReachableRange = 0.0f;
+
+	TimeOfFlight.SetNumZeroed(NumSamples);
+	Drop.SetNumZeroed(NumSamples);
+
+	if (MuzzleSpeed <= 0.0f || RangeStep <= 0.0f) {
+		TimeOfFlight.SetNum(1);
+		Drop.SetNum(1);
+		return;
+	}
+
+	const float FlightTimeLimit = FMath::Min(InMaxFlightTime, BallisticTable::MaxBuildFlightTime);
+
+	// X is distance down range, Y is height relative to the bore line
+	FVector2D Position = FVector2D::ZeroVector;
+	FVector2D Velocity(MuzzleSpeed, 0.0f);
+	float Time = 0.0f;
+	int32 NextSample = 1;
+
+	while (NextSample < NumSamples && Time < FlightTimeLimit && Velocity.X > KINDA_SMALL_NUMBER) {
+		const FVector2D PreviousPosition = Position;
+		const float PreviousTime = Time;
+
+		const FVector2D Acceleration = FVector2D(0.0f, InGravityZ) - Velocity * (InDragCoefficient * Velocity.Size());
+		Velocity += Acceleration * BallisticTable::BuildStepTime;
+		Position += Velocity * BallisticTable::BuildStepTime;
+		Time += BallisticTable::BuildStepTime;
+
+		// Record every range sample crossed during this step
+		while (NextSample < NumSamples && Position.X >= NextSample * RangeStep) {
+			const float SampleRange = NextSample * RangeStep;
+			const float Alpha = (SampleRange - PreviousPosition.X) / (Position.X - PreviousPosition.X);
+
+			TimeOfFlight[NextSample] = FMath::Lerp(PreviousTime, Time, Alpha);
+			Drop[NextSample] = -FMath::Lerp(PreviousPosition.Y, Position.Y, Alpha);
+			MaxReachableRange = SampleRange;
+			++NextSample;
+		}
+	}
+
+	// Discard samples the projectile never reached
+	TimeOfFlight.SetNum(NextSample);
+	Drop.SetNum(NextSample);
+}
+
+
+/**
+ * Linearly interpolates the two samples surrounding Range.
+ *
+ * @return False if Range lies beyond the projectile's reach
+ */
+bool FBallisticTable::SampleAtRange(float Range, float& OutTimeOfFlight, float& OutDrop) const {
+	if (TimeOfFlight.Num() < 2 || Range > MaxReachableRange) {
+		return false;
+	}
+
+	const float SamplePosition = FMath::Max(Range, 0.0f) / RangeStep;
+	const int32 LowerIndex = FMath::Min(FMath::FloorToInt32(SamplePosition), TimeOfFlight.Num() - 2);
+	const float Alpha = SamplePosition - LowerIndex;
+
+	OutTimeOfFlight = FMath::Lerp(TimeOfFlight[LowerIndex], TimeOfFlight[LowerIndex + 1], Alpha);
+	OutDrop = FMath::Lerp(Drop[LowerIndex], Drop[LowerIndex + 1], Alpha);
+	return true;
+}
+
+
+float FBallisticTable::GetEffectiveSpeedAtRange(float Range) const {
+	float RangeTimeOfFlight;
+	float RangeDrop;
+
+	// Inside the first sample drag has not had time to act
+	if (Range < RangeStep || !SampleAtRange(Range, RangeTimeOfFlight, RangeDrop) || RangeTimeOfFlight <= 0.0f) {
+		return MuzzleSpeed;
+	}
+	return Range / RangeTimeOfFlight;
+}
+
+
+/**
+ * Predicts an intercept point and compensates it for drop.
+ *
+ * @note The first pass assumes the average speed to the target's current range, the
+ *       second corrects it with the average speed to the predicted intercept range
+ */
+bool FBallisticTable::SolveLead(const FVector& Origin, const FVector& TargetLocation, const FVector& TargetVelocity, FVector& OutAimPoint, float& OutTimeOfFlight) const {
+	const FVector Delta = TargetLocation - Origin;
+
+	float InterceptTime = 0.0f;
+	float EffectiveSpeed = GetEffectiveSpeedAtRange(Delta.Size());
+	for (int32 Pass = 0; Pass < 2; ++Pass) {
+		if (!BallisticTable::SolveInterceptTime(Delta, TargetVelocity, EffectiveSpeed, InterceptTime)) {
+			return false;
+		}
+		EffectiveSpeed = GetEffectiveSpeedAtRange((Delta + TargetVelocity * InterceptTime).Size());
+	}
+
+	const FVector InterceptLocation = TargetLocation + TargetVelocity * InterceptTime;
+
+	float InterceptDrop;
+	if (!SampleAtRange(FVector::Dist(Origin, InterceptLocation), OutTimeOfFlight, InterceptDrop)) {
+		return false;
+	}
+
+	// Raise the aim point by the distance the projectile will fall
+	OutAimPoint = InterceptLocation + FVector::UpVector * InterceptDrop;
+	return true;
+}
@@ -5,7 +5,28 @@
 
 #include "Logging.h"
 #include "Components/BoxComponent.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/Character.h"
+#include "TimerManager.h"
 #include "Kismet/KismetSystemLibrary.h"
+#include "Net/UnrealNetwork.h"
+#include "Serialization/BitWriter.h"
+#include "Subsystem/WeaponSubsystem.h"
+#include "Trace/WeaponCsvStats.h"
+
+static TAutoConsoleVariable<float> CVarWeaponDropRestBlendTime(
+	TEXT("weapon.Net.DropRestBlendTime"),
+	0.25f,
+	TEXT("Seconds over which clients blend a dropped weapon from their own simulation to the server's rest pose."));
+
+namespace WeaponDrop {
+	// Longest a dropped weapon simulates before it is settled regardless of its body (seconds)
+	constexpr float MaxSettleTime = 8.0f;
+
+	// Bodies are asleep when released, so sleep is only trusted after this long (seconds)
+	constexpr float SleepGracePeriod = 0.5f;
+}
 
 
 // Sets default values
@@ -32,6 +53,32 @@ void ABaseWeapon::BeginPlay() {
 void ABaseWeapon::Tick( float DeltaTime ) {
 	Super::Tick(DeltaTime);
 
+	// The server settles as soon as the body sleeps, which sends the rest pose early
+	if (HasAuthority() && IsSettlingAfterFall() && GetWorld()->GetTimeSeconds() - DropTime > WeaponDrop::SleepGracePeriod && !GetWeaponMesh()->RigidBodyIsAwake()) {
+		GetWorld()->GetTimerManager().ClearTimer(SettleTimerHandle);
+		SettleAfterFall();
+	}
+
+	if (RestBlendElapsed >= 0.0f) {
+		RestBlendElapsed += DeltaTime;
+		const float BlendTime = CVarWeaponDropRestBlendTime.GetValueOnGameThread();
+		const float Alpha = BlendTime > 0.0f ? FMath::Min(RestBlendElapsed / BlendTime, 1.0f) : 1.0f;
+
+		FTransform BlendedTransform;
+		BlendedTransform.Blend(RestBlendStart, FTransform(DropState.RestRotation, DropState.RestLocation, RestBlendStart.GetScale3D()), FMath::SmoothStep(0.0f, 1.0f, Alpha));
+		GetWeaponMesh()->SetWorldTransform(BlendedTransform);
+
+		if (Alpha >= 1.0f) {
+			RestBlendElapsed = -1.0f;
+		}
+	}
+}
+
+
+void ABaseWeapon::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const {
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ABaseWeapon, DropState);
 }
 
 /**
@@ -42,31 +89,71 @@ void ABaseWeapon::Tick( float DeltaTime ) {
  */
 void ABaseWeapon::SetOwningCharacter(ACharacter* NewOwner) {
 	OwningCharacter = NewOwner;
+
+	// Picked up again before the last drop settled - it cannot be attached while simulating
+	if (NewOwner && IsSettlingAfterFall()) {
+		GetWorld()->GetTimerManager().ClearTimer(SettleTimerHandle);
+		SettleAfterFall();
+	}
+
+	// A blend still running would pull the mesh off its new owner
+	if (NewOwner) {
+		RestBlendElapsed = -1.0f;
+	}
 }
 
 
+/**
+ * Drops the weapon from its owner.
+ *
+ * @note Clears the ignore list, the next owner sets its own in InitializeWeapon()
+ * @note The settle timer is bound to this weapon, so it is cleared with it and replaced
+ *       by the next drop rather than stacking one timer per drop
+ */
 void ABaseWeapon::Fall() {
+	// The weapon leaves with the momentum of whoever carried it
+	const FVector DropVelocity = OwningCharacter ? OwningCharacter->GetVelocity() : FVector::ZeroVector;
+
 	SetOwningCharacter(nullptr);
-	FDetachmentTransformRules DetachmentRules(EDetachmentRule::KeepWorld, true);
-	GetWeaponMesh()->DetachFromComponent(DetachmentRules);
-	
+
+	// The previous owner must not stay reachable through a weapon lying on the ground
+	ActorsToIgnore.Reset();
+
 	if (bShouldUsePhysicsSimulation) {
-		GetWeaponMesh()->SetCollisionEnabled(ECollisionEnabled::PhysicsOnly);
-		GetWeaponMesh()->SetCollisionResponseToAllChannels(ECR_Block);
-		GetWeaponMesh()->SetSimulatePhysics(true);
-
-		FTimerHandle SimulationTimerHandle;
-		GetWorld()->GetTimerManager().SetTimer(SimulationTimerHandle, [this](){
-			GetWeaponMesh()->SetSimulatePhysics(false);
-			GetWeaponMesh()->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-		}, 8.0f, false);
+		BeginDropSimulation(DropVelocity);
+
+		// The ID the server gives this drop, so a client that dropped the weapon itself keeps its simulation
+		LastAppliedDropId = static_cast<uint8>(DropState.DropId + 1);
+
+		if (HasAuthority()) {
+			++DropState.DropId;
+			DropState.bAtRest = false;
+			DropState.StartLocation = GetWeaponMesh()->GetComponentLocation();
+			DropState.StartRotation = GetWeaponMesh()->GetComponentRotation();
+			DropState.StartVelocity = DropVelocity;
+			PublishDropState();
+		}
 	} else {
+		FDetachmentTransformRules DetachmentRules(EDetachmentRule::KeepWorld, true);
+		GetWeaponMesh()->DetachFromComponent(DetachmentRules);
+
 		FHitResult GroundTraceHitResult;
 		UKismetSystemLibrary::LineTraceSingle(GetWorld(), GetActorLocation(), GetActorLocation() - FVector(0, 0, 5000),UEngineTypes::ConvertToTraceType(ECC_Visibility),
 			true, TArray<AActor*>(), EDrawDebugTrace::None, GroundTraceHitResult, true);
 
 		if (GroundTraceHitResult.bBlockingHit) {
 			SetActorLocation(GroundTraceHitResult.ImpactPoint);
+
+			// Nothing to simulate, clients go straight to the rest pose
+			if (HasAuthority()) {
+				++DropState.DropId;
+				DropState.bAtRest = true;
+				DropState.RestLocation = GetWeaponMesh()->GetComponentLocation();
+				DropState.RestRotation = GetWeaponMesh()->GetComponentRotation();
+				DropState.QuantizeRestPose();
+				GetWeaponMesh()->SetWorldLocationAndRotation(DropState.RestLocation, DropState.RestRotation);
+				PublishDropState();
+			}
 		} else {
 			UE_LOG(LogWeaponHandlingModule, Warning, TEXT("BaseWeapon::Fall - No ground hit detected, weapon may fall through the world!"));
 			bShouldUsePhysicsSimulation = true; // Reset to default behavior
@@ -76,6 +163,113 @@ void ABaseWeapon::Fall() {
 	
 }
 
+bool ABaseWeapon::IsSettlingAfterFall() const {
+	const UWorld* World = GetWorld();
+	return World && World->GetTimerManager().IsTimerActive(SettleTimerHandle);
+}
+
+
+void ABaseWeapon::BeginDropSimulation(const FVector& Velocity) {
+	FDetachmentTransformRules DetachmentRules(EDetachmentRule::KeepWorld, true);
+	GetWeaponMesh()->DetachFromComponent(DetachmentRules);
+
+	GetWeaponMesh()->SetCollisionEnabled(ECollisionEnabled::PhysicsOnly);
+	GetWeaponMesh()->SetCollisionResponseToAllChannels(ECR_Block);
+	GetWeaponMesh()->SetSimulatePhysics(true);
+	GetWeaponMesh()->SetPhysicsLinearVelocity(Velocity);
+
+	DropTime = GetWorld()->GetTimeSeconds();
+	RestBlendElapsed = -1.0f;
+	GetWorld()->GetTimerManager().SetTimer(SettleTimerHandle, this, &ABaseWeapon::SettleAfterFall, WeaponDrop::MaxSettleTime, false);
+}
+
+
+/**
+ * @note On the server this also publishes the rest pose, rounded so every machine agrees on it
+ * @remark Clients keep their own pose until the rest pose arrives, then blend to it
+ */
+void ABaseWeapon::SettleAfterFall() {
+	GetWeaponMesh()->SetSimulatePhysics(false);
+	GetWeaponMesh()->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+
+	if (HasAuthority() && !OwningCharacter) {
+		DropState.bAtRest = true;
+		DropState.RestLocation = GetWeaponMesh()->GetComponentLocation();
+		DropState.RestRotation = GetWeaponMesh()->GetComponentRotation();
+		DropState.QuantizeRestPose();
+		GetWeaponMesh()->SetWorldLocationAndRotation(DropState.RestLocation, DropState.RestRotation);
+		PublishDropState();
+	}
+}
+
+
+void ABaseWeapon::BlendToRestPose() {
+	GetWorld()->GetTimerManager().ClearTimer(SettleTimerHandle);
+
+	// Still attached if this client never saw the fall - relevant only after the drop, or the start update was superseded
+	FDetachmentTransformRules DetachmentRules(EDetachmentRule::KeepWorld, true);
+	GetWeaponMesh()->DetachFromComponent(DetachmentRules);
+
+	GetWeaponMesh()->SetSimulatePhysics(false);
+	GetWeaponMesh()->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+
+	RestBlendStart = GetWeaponMesh()->GetComponentTransform();
+	RestBlendElapsed = 0.0f;
+}
+
+
+/**
+ * @note Clients that already dropped the weapon locally, such as its previous owner, keep their simulation
+ * @remark A new drop restarts the fall even while the previous one is still settling
+ */
+void ABaseWeapon::OnRep_DropState() {
+	if (OwningCharacter) {
+		return;
+	}
+
+	if (DropState.bAtRest) {
+		LastAppliedDropId = DropState.DropId;
+		BlendToRestPose();
+		return;
+	}
+
+	if (DropState.DropId != LastAppliedDropId) {
+		LastAppliedDropId = DropState.DropId;
+		GetWeaponMesh()->SetWorldLocationAndRotation(DropState.StartLocation, DropState.StartRotation);
+		BeginDropSimulation(DropState.StartVelocity);
+	}
+}
+
+
+/**
+ * @note Each change is one property update per relevant connection, estimated as every client connection
+ */
+void ABaseWeapon::PublishDropState() {
+	ForceNetUpdate();
+
+	const UNetDriver* NetDriver = GetWorld()->GetNetDriver();
+	const int32 NumConnections = NetDriver ? NetDriver->ClientConnections.Num() : 0;
+	if (NumConnections == 0) {
+		return;
+	}
+
+	int64 NumBits = 0;
+#if STATS || WEAPON_CSV_STATS_ENABLED
+	FBitWriter Writer(0, true);
+	bool bSuccess = false;
+	DropState.NetSerialize(Writer, nullptr, bSuccess);
+	NumBits = Writer.GetNumBits();
+#endif
+
+	CSV_WEAPON_COUNT(DropUpdates, NumConnections);
+	CSV_WEAPON_COUNT(DropBytes, NumConnections * FMath::DivideAndRoundUp<int64>(NumBits, 8));
+
+	if (UWeaponSubsystem* WeaponSubsystem = GetWorld()->GetSubsystem<UWeaponSubsystem>()) {
+		WeaponSubsystem->RecordWeaponDropUpdates(NumConnections, NumBits);
+	}
+}
+
+
 /**
  * Adds single actor to collision exclusion list.
  * 
@@ -84,7 +278,7 @@ void ABaseWeapon::Fall() {
  */
 void ABaseWeapon::AddActorToIgnore(AActor* IgnoredActor) {
 	if (IgnoredActor) {
-		ActorsToIgnore.Emplace(IgnoredActor);
+		ActorsToIgnore.AddUnique(IgnoredActor);
 	}
 }
 
@@ -94,11 +288,12 @@ void ABaseWeapon::AddActorToIgnore(AActor* IgnoredActor) {
  * 
  * @param IgnoredActors Array of entities to exclude from traces
  * @note Efficient solution for ignoring related actor groups
+ * @remark Actors already ignored are skipped, so re-equipping does not grow the list
  */
 void ABaseWeapon::AddActorToIgnore(TArray<AActor*> IgnoredActors) {
 	if (IgnoredActors.Num() > 0) {
 		for (AActor* Actor : IgnoredActors) {
-			ActorsToIgnore.Emplace(Actor);
+			ActorsToIgnore.AddUnique(Actor);
 		}
 	}
 }
@@ -3,6 +3,18 @@
 
 #include "Weapon/ProjectileWeapon.h"
 
+#include "Logging.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "Projectile/ProjectileSimulation.h"
+#include "Projectile/WeaponProjectileActor.h"
+#include "Subsystem/WeaponSubsystem.h"
+#include "Trace/WeaponShotTrace.h"
+#include "Weapon/BallisticTable.h"
+#include "Weapon/WeaponDefinition.h"
+#include "Weapon/WeaponDefinitionDatabase.h"
+
 
 // Sets default values
 AProjectileWeapon::AProjectileWeapon() {
@@ -14,12 +26,126 @@ AProjectileWeapon::AProjectileWeapon() {
 // Called when the game starts or when spawned
 void AProjectileWeapon::BeginPlay() {
 	Super::BeginPlay();
-	
+
+	// Tables depend on world gravity, so resolve once the world is known
+	RefreshBallisticTable();
+	RegisterProjectileDefinition();
+
+	// Weapons placed in the map prewarm at load
+	UWeaponSubsystem* WeaponSubsystem = GetWorld()->GetSubsystem<UWeaponSubsystem>();
+	if (WeaponSubsystem && ProjectileData.ProjectileActorClass) {
+		WeaponSubsystem->PrewarmProjectileActors(ProjectileData.ProjectileActorClass, ProjectileData.PrewarmedActorCount);
+	}
+}
+
+
+void AProjectileWeapon::ApplyWeaponDefinition(const UWeaponDefinition& Definition) {
+	ProjectileData = Definition.ProjectileData;
+
+	Super::ApplyWeaponDefinition(Definition);
+}
+
+
+void AProjectileWeapon::ApplyCookedWeaponDefinition(const FCookedWeaponDefinition& Definition, const FWeaponDefinitionDatabase& Database) {
+	Database.ResolveProjectileData(Definition, ProjectileData);
+
+	Super::ApplyCookedWeaponDefinition(Definition, Database);
+}
+
+
+/**
+ * Launches the volley's projectiles into the batched simulation.
+ *
+ * @param Volley Muzzles firing on this trigger event
+ * @param IgnoredActors Entities excluded from collision
+ * @param WeaponFireHitResult Unused - projectile hits resolve asynchronously
+ * @param InstigatorController Controller credited with the projectile
+ *
+ * @note On the server, shots from remote players are fast-forwarded by the
+ *       shooter's latency so the projectile lines up with what they saw
+ * @remark Aim and latency are resolved once, every muzzle converges on the aim point
+ */
+void AProjectileWeapon::ShootWeapon( const FMuzzleVolley& Volley, const TArray<AActor*>& IgnoredActors, FHitResult& WeaponFireHitResult, AController* InstigatorController ) {
+	Super::ShootWeapon(Volley, IgnoredActors, WeaponFireHitResult, InstigatorController);
+
+	UWeaponSubsystem* WeaponSubsystem = GetWorld()->GetSubsystem<UWeaponSubsystem>();
+	if (!WeaponSubsystem || ProjectileDefinitionIndex == INDEX_NONE) {
+		UE_LOG(LogWeaponHandlingModule, Warning, TEXT("ProjectileWeapon: Projectile definition not registered"));
+		return;
+	}
+
+	FVector AimPoint;
+	const bool bHasAimPoint = GetAimPoint(InstigatorController, AimPoint);
+
+	FProjectileLaunchParams LaunchParams;
+	LaunchParams.DefinitionIndex = ProjectileDefinitionIndex;
+	LaunchParams.DamageCauser = this;
+	LaunchParams.InstigatorController = InstigatorController;
+	LaunchParams.IgnoredActor = GetOwningCharacter();
+	LaunchParams.CatchUpTime = GetShooterLatency(InstigatorController);
+
+	for (const FTransform& MuzzleTransform : Volley.MuzzleTransforms) {
+		LaunchParams.Origin = MuzzleTransform.GetLocation();
+		LaunchParams.Direction = bHasAimPoint ? (AimPoint - LaunchParams.Origin).GetSafeNormal() : MuzzleTransform.GetRotation().Vector();
+		const FVector ShotEnd = LaunchParams.Origin + LaunchParams.Direction * WeaponData.WeaponRange;
+
+		for (int32 Pellet = 0; Pellet < Volley.PelletsPerMuzzle; ++Pellet) {
+			LaunchProjectile(LaunchParams);
+
+			// Impacts are traced as separate pellets when the simulation resolves them
+			TRACE_WEAPON_PELLET(this, FHitResult(LaunchParams.Origin, ShotEnd));
+
+			QueueShotCosmetic(LaunchParams.Origin, ShotEnd, false);
+		}
+	}
+}
+
+
+/**
+ * Launches a cosmetic copy of a replicated projectile.
+ *
+ * @note Client projectiles never apply damage, see UWeaponSubsystem::ApplyWeaponDamage()
+ */
+void AProjectileWeapon::PlayShotCosmetic(const FVector& ShotOrigin, const FVector& ShotEnd, bool bHit, uint8 Seed) {
+	SpawnMuzzleFlash(FindMuzzleIndex(ShotOrigin));
+
+	UWeaponSubsystem* WeaponSubsystem = GetWorld()->GetSubsystem<UWeaponSubsystem>();
+	if (!WeaponSubsystem || ProjectileDefinitionIndex == INDEX_NONE) {
+		return;
+	}
+
+	FProjectileLaunchParams LaunchParams;
+	LaunchParams.DefinitionIndex = ProjectileDefinitionIndex;
+	LaunchParams.Origin = ShotOrigin;
+	LaunchParams.Direction = (ShotEnd - ShotOrigin).GetSafeNormal();
+	LaunchParams.DamageCauser = this;
+	LaunchParams.IgnoredActor = GetOwningCharacter();
+
+	LaunchProjectile(LaunchParams);
+}
+
+
+void AProjectileWeapon::LaunchProjectile(const FProjectileLaunchParams& LaunchParams) {
+	UWeaponSubsystem* WeaponSubsystem = GetWorld()->GetSubsystem<UWeaponSubsystem>();
+	if (!WeaponSubsystem) {
+		return;
+	}
+
+	if (ProjectileData.ProjectileActorClass) {
+		WeaponSubsystem->LaunchProjectileActor(ProjectileData.ProjectileActorClass, LaunchParams);
+	} else {
+		WeaponSubsystem->LaunchProjectile(LaunchParams);
+	}
 }
 
-void AProjectileWeapon::ShootWeapon( const TArray<AActor*>& IgnoredActors, FHitResult& WeaponFireHitResult, AController* InstigatorController ) {
-	Super::ShootWeapon(IgnoredActors, WeaponFireHitResult, InstigatorController);
-	
+
+void AProjectileWeapon::SetOwningCharacter(ACharacter* NewOwner) {
+	Super::SetOwningCharacter(NewOwner);
+
+	UWeaponSubsystem* WeaponSubsystem = GetWorld()->GetSubsystem<UWeaponSubsystem>();
+	if (NewOwner && WeaponSubsystem && ProjectileData.ProjectileActorClass) {
+		WeaponSubsystem->PrewarmProjectileActors(ProjectileData.ProjectileActorClass, ProjectileData.PrewarmedActorCount);
+	}
 }
 
 // Called every frame
@@ -28,3 +154,106 @@ void AProjectileWeapon::Tick( float DeltaTime ) {
 
 }
 
+
+#if WITH_EDITOR
+void AProjectileWeapon::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) {
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	// Live tuning during play - pick up the table for the new definition
+	if (HasActorBegunPlay()) {
+		RefreshBallisticTable();
+		RegisterProjectileDefinition();
+	}
+}
+#endif
+
+
+/**
+ * Resolves the shared ballistic table for the current definition.
+ *
+ * @note Weapons of one definition, or one class without a definition, with identical
+ *       ProjectileData and range share one table
+ */
+void AProjectileWeapon::RefreshBallisticTable() {
+	const UObject* Source = WeaponDefinition ? static_cast<const UObject*>(WeaponDefinition) : GetClass();
+	const float GravityZ = GetWorld()->GetGravityZ() * ProjectileData.GravityScale;
+	BallisticTable = FBallisticTable::FindOrBuild(Source, ProjectileData.MuzzleSpeed, GravityZ, ProjectileData.DragCoefficient, ProjectileData.MaxFlightTime, WeaponData.WeaponRange);
+}
+
+
+void AProjectileWeapon::RegisterProjectileDefinition() {
+	UWeaponSubsystem* WeaponSubsystem = GetWorld()->GetSubsystem<UWeaponSubsystem>();
+	if (!WeaponSubsystem) {
+		return;
+	}
+
+	FProjectileDefinition Definition;
+	Definition.MuzzleSpeed = ProjectileData.MuzzleSpeed;
+	Definition.GravityZ = GetWorld()->GetGravityZ() * ProjectileData.GravityScale;
+	Definition.DragCoefficient = ProjectileData.DragCoefficient;
+	Definition.MaxFlightTime = ProjectileData.MaxFlightTime;
+	Definition.Damage = WeaponData.WeaponDamage;
+	Definition.ImpactParticle = WeaponData.ImpactParticle;
+	Definition.Mesh = ProjectileData.ProjectileMesh;
+	Definition.MeshScale = ProjectileData.ProjectileMeshScale;
+	Definition.HomingAcceleration = ProjectileData.HomingAcceleration;
+	Definition.HomingRange = ProjectileData.HomingRange;
+	Definition.HomingConeCos = FMath::Cos(FMath::DegreesToRadians(ProjectileData.HomingConeAngle));
+
+	ProjectileDefinitionIndex = WeaponSubsystem->RegisterProjectileDefinition(Definition);
+}
+
+
+/**
+ * Finds the point the instigator is looking at, for muzzles to aim at.
+ *
+ * @note Without an instigator, muzzles fire along their forward axis
+ */
+bool AProjectileWeapon::GetAimPoint(const AController* InstigatorController, FVector& OutAimPoint) const {
+	if (!InstigatorController) {
+		return false;
+	}
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	InstigatorController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+	OutAimPoint = ViewLocation + ViewRotation.Vector() * WeaponData.WeaponRange;
+	return true;
+}
+
+
+/**
+ * Estimates one-way latency from the shooter's round trip ping.
+ *
+ * @note Only meaningful with authority over a remote player's shot
+ */
+float AProjectileWeapon::GetShooterLatency(const AController* InstigatorController) const {
+	const APlayerController* PlayerController = Cast<APlayerController>(InstigatorController);
+	if (!HasAuthority() || !PlayerController || PlayerController->IsLocalController() || !PlayerController->PlayerState) {
+		return 0.0f;
+	}
+
+	return PlayerController->PlayerState->GetPingInMilliseconds() * 0.5f * 0.001f;
+}
+
+
+/**
+ * Computes a lead and drop compensated aim point from the barrel socket.
+ *
+ * @param TargetLocation Current target location
+ * @param TargetVelocity Current target velocity
+ * @param OutAimPoint Aim location, unchanged if unreachable
+ * @return True if an intercept was found
+ */
+bool AProjectileWeapon::ComputeLeadAimPoint(const FVector& TargetLocation, const FVector& TargetVelocity, FVector& OutAimPoint) const {
+	if (!BallisticTable.IsValid()) {
+		UE_LOG(LogWeaponHandlingModule, Warning, TEXT("ProjectileWeapon: Ballistic table requested before BeginPlay"));
+		return false;
+	}
+
+	const FVector MuzzleLocation = GetMuzzleTransform(0).GetLocation();
+
+	float TimeOfFlight;
+	return BallisticTable->SolveLead(MuzzleLocation, TargetLocation, TargetVelocity, OutAimPoint, TimeOfFlight);
+}
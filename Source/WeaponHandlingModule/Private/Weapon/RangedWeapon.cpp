@@ -2,8 +2,67 @@
 
 #include "Weapon/RangedWeapon.h"
 #include "Logging.h"
+#include "Engine/NetDriver.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/SkeletalMeshSocket.h"
+#include "GameFramework/Character.h"
 #include "Kismet/GameplayStatics.h"
+#include "Memory/WeaponObjectCreationTracker.h"
+#include "Net/UnrealNetwork.h"
 #include "Particles/ParticleSystemComponent.h"
+#include "Serialization/BitWriter.h"
+#include "Subsystem/WeaponSubsystem.h"
+#include "Trace/WeaponCsvStats.h"
+#include "Trace/WeaponShotTrace.h"
+#include "Weapon/WeaponDefinition.h"
+#include "Weapon/WeaponDefinitionDatabase.h"
+
+namespace ShotCosmetics {
+	static TAutoConsoleVariable<bool> CVarBatchShotCosmetics(
+		TEXT("weapon.Net.BatchShotCosmetics"),
+		true,
+		TEXT("Send cosmetic shot results as one multicast per weapon per frame instead of one per shot."));
+
+	static TAutoConsoleVariable<bool> CVarShotInterestManagement(
+		TEXT("weapon.Net.ShotInterestManagement"),
+		true,
+		TEXT("Send batched shot results only to connections within audible or visible range instead of multicasting them."));
+
+	/** Connections a multicast from this weapon goes out to */
+	int32 GetNumClientConnections(const UWorld* World) {
+		const UNetDriver* NetDriver = World->GetNetDriver();
+		return NetDriver ? NetDriver->ClientConnections.Num() : 0;
+	}
+
+	/** Payload size of a batch as it will be written to the wire */
+	int64 GetPayloadBits(FShotCosmeticBatch& Batch) {
+		FBitWriter Writer(0, true);
+		bool bSuccess = false;
+		Batch.NetSerialize(Writer, nullptr, bSuccess);
+		return Writer.GetNumBits();
+	}
+
+	/** Payload size of one per-shot multicast */
+	int64 GetPayloadBits(FVector_NetQuantize& ShotEnd, uint8 Seed) {
+		FBitWriter Writer(0, true);
+		bool bSuccess = false;
+		ShotEnd.NetSerialize(Writer, nullptr, bSuccess);
+		Writer.WriteBit(1);
+		Writer << Seed;
+		return Writer.GetNumBits();
+	}
+}
+
+namespace WeaponCadence {
+	// Shots fired at most by one attack call, bounds catch-up after a hitch
+	constexpr int32 MaxShotsPerAttack = 8;
+
+	// Shortest fire interval, keeps a zero fire rate from firing every owed step at once (seconds)
+	constexpr float MinFireInterval = 0.01f;
+
+	// Longest gap between attack calls that still counts as holding the trigger without a weapon subsystem (seconds)
+	constexpr double DefaultMaxTriggerGap = 0.1;
+}
 
 /**
  * Constructs weapon with core visual representation.
@@ -13,50 +72,105 @@
  */
 ARangedWeapon::ARangedWeapon() : CurrentBurstShotCount(0), bShouldFireWeapon(true), bShouldBurstShotCooldown(false) {
 	PrimaryActorTick.bCanEverTick = true;
+
+	// Remote clients receive shot cosmetics through multicasts on the weapon
+	bReplicates = true;
 }
 
 
+/**
+ * @note Clients receive WeaponDefinitionId with the initial replication, before begin play
+ * @remark The cooked database is preferred, the definition asset is only loaded when it has no record
+ */
 void ARangedWeapon::BeginPlay() {
+	if (WeaponDefinitionId.IsValid()) {
+		const FWeaponDefinitionDatabase& Database = FWeaponDefinitionDatabase::Get();
+		if (const FCookedWeaponDefinition* CookedDefinition = Database.Find(WeaponDefinitionId)) {
+			ApplyCookedWeaponDefinition(*CookedDefinition, Database);
+		} else if (const UWeaponDefinition* Definition = UWeaponDefinition::Load(WeaponDefinitionId)) {
+			ApplyWeaponDefinition(*Definition);
+		}
+	}
+
+	CacheMuzzles();
+
 	Super::BeginPlay();
 }
 
 
+void ARangedWeapon::ApplyWeaponDefinition(const UWeaponDefinition& Definition) {
+	WeaponDefinition = &Definition;
+	WeaponData = Definition.WeaponData;
+	WeaponBarrelSocket = Definition.BarrelSocket;
+	AdditionalBarrelSockets = Definition.AdditionalBarrelSockets;
+	MuzzleFiringOrder = Definition.MuzzleFiringOrder;
+
+	if (Definition.WeaponMesh) {
+		GetWeaponMesh()->SetSkeletalMeshAsset(Definition.WeaponMesh);
+	}
+}
+
+
+void ARangedWeapon::ApplyCookedWeaponDefinition(const FCookedWeaponDefinition& Definition, const FWeaponDefinitionDatabase& Database) {
+	Database.ResolveWeaponData(Definition, WeaponData);
+	WeaponBarrelSocket = FName(FString(Database.GetString(Definition.BarrelSocket)));
+	MuzzleFiringOrder = static_cast<EMuzzleFiringOrder>(Definition.MuzzleFiringOrder);
+
+	AdditionalBarrelSockets.Reset(Definition.NumAdditionalBarrelSockets);
+	for (uint32 SocketIndex = 0; SocketIndex < Definition.NumAdditionalBarrelSockets; ++SocketIndex) {
+		AdditionalBarrelSockets.Add(Database.GetStringRef(Definition.FirstAdditionalBarrelSocket + SocketIndex));
+	}
+
+	if (USkeletalMesh* Mesh = Database.ResolveAsset<USkeletalMesh>(Definition.WeaponMesh)) {
+		GetWeaponMesh()->SetSkeletalMeshAsset(Mesh);
+	}
+}
+
+
 void ARangedWeapon::Tick(float DeltaTime) {
 	Super::Tick(DeltaTime);
 }
 
 
+void ARangedWeapon::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const {
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// Fixed at spawn, clients only need it to configure themselves
+	DOREPLIFETIME_CONDITION(ARangedWeapon, WeaponDefinitionId, COND_InitialOnly);
+}
+
+
 /**
  * Visualizes projectile trajectory from muzzle to impact point.
  * 
+ * @param MuzzleTransform Where the shot left the weapon
  * @param TraceHitResult Contains impact data including:
  *        - ImpactPoint: World location where projectile hit
  *        - TraceEnd: Final point if no collision occurred
- * @param Mesh Reference weapon mesh for correct muzzle positioning
  * 
  * @note Creates temporary beam effect showing shot path
  * @warning Requires properly configured BeamTrail particle system
  * @remark Handles both hit-and-miss cases appropriately
  */
-void ARangedWeapon::SpawnBulletTrail(const FHitResult& TraceHitResult, const USkeletalMeshComponent* Mesh) const {
+void ARangedWeapon::SpawnBulletTrail(const FTransform& MuzzleTransform, const FHitResult& TraceHitResult) const {
 	// Early out if required assets aren't configured
-	if (!WeaponData.BeamTrail || !Mesh) {
-		UE_LOG(LogWeaponHandlingModule, Warning, TEXT("Missing BeamTrail effect and/or Mesh reference"));
+	if (!WeaponData.BeamTrail) {
+		UE_LOG(LogWeaponHandlingModule, Warning, TEXT("Missing BeamTrail effect"));
 		return;
 	}
 
-	// Get precise muzzle location from socket
-	const FTransform WeaponSocketTransform = Mesh->GetSocketTransform(WeaponBarrelSocket);
-	if (!WeaponSocketTransform.IsValid()) {
+	if (!MuzzleTransform.IsValid()) {
 		UE_LOG(LogWeaponHandlingModule, Error, TEXT("Invalid barrel socket transform"));
 		return;
 	}
 
-	// Spawn beam effect at muzzle location
-	UParticleSystemComponent* Beam = UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), WeaponData.BeamTrail, WeaponSocketTransform);
+	// Spawn beam effect at muzzle location, from the world's component pool
+	UParticleSystemComponent* Beam = UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), WeaponData.BeamTrail, MuzzleTransform, true, EPSCPoolMethod::AutoRelease);
 
 	// Configure beam target based on hit results
 	if (Beam) {
+		CSV_WEAPON_COUNT(Effects, 1);
+
 		const FVector TargetLocation = TraceHitResult.bBlockingHit ? TraceHitResult.ImpactPoint : TraceHitResult.TraceEnd;
 		Beam->SetVectorParameter(FName("Target"), TargetLocation);
 	}
@@ -66,22 +180,275 @@ void ARangedWeapon::SpawnBulletTrail(const FHitResult& TraceHitResult, const USk
 /**
  * Coordinates core firing sequence including visual feedback.
  * 
+ * @param Volley Muzzles firing on this trigger event
  * @param IgnoredActors Entities to exclude from hit detection
  * @param WeaponFireHitResult Output container for hit analysis
  * @param InstigatorController Responsible controller for attribution
  * 
- * @note Always plays muzzle flash when configured
- * @remark Base implementation handles visuals - override for game-specific damage
+ * @note One muzzle flash per firing muzzle, however many pellets leave it
+ * @remark Base implementation handles visuals - override for game-specific damage,
+ *         trails are left to overrides since they need the traced hit
  */
-void ARangedWeapon::ShootWeapon( const TArray<AActor*>& IgnoredActors, FHitResult& WeaponFireHitResult, AController* InstigatorController ) {
+void ARangedWeapon::ShootWeapon( const FMuzzleVolley& Volley, const TArray<AActor*>& IgnoredActors, FHitResult& WeaponFireHitResult, AController* InstigatorController ) {
+	for (const int32 MuzzleIndex : Volley.MuzzleIndices) {
+		SpawnMuzzleFlash(MuzzleIndex);
+	}
+}
+
+
+void ARangedWeapon::SpawnMuzzleFlash(int32 MuzzleIndex) const {
 	// Play muzzle flash effect if configured
 	if (WeaponData.MuzzleFlash) {
-		UGameplayStatics::SpawnEmitterAttached(WeaponData.MuzzleFlash, GetWeaponMesh(), WeaponBarrelSocket);
+		const FName SocketName = Muzzles.IsValidIndex(MuzzleIndex) ? Muzzles[MuzzleIndex].SocketName : WeaponBarrelSocket;
+		UGameplayStatics::SpawnEmitterAttached(WeaponData.MuzzleFlash, GetWeaponMesh(), SocketName, FVector::ZeroVector, FRotator::ZeroRotator,
+			EAttachLocation::KeepRelativeOffset, true, EPSCPoolMethod::AutoRelease);
+		CSV_WEAPON_COUNT(Effects, 1);
 	} else {
 		UE_LOG(LogWeaponHandlingModule, Warning, TEXT("Missing MuzzleFlash effect"));
 	}
-	// Visualize bullet trajectory
-	SpawnBulletTrail(WeaponFireHitResult, GetWeaponMesh());
+}
+
+
+/**
+ * Resolves every muzzle socket to its bone and offset.
+ *
+ * @note Sockets missing on the mesh fall back to a socket lookup by name when fired
+ */
+void ARangedWeapon::CacheMuzzles() {
+	Muzzles.Reset();
+	NextMuzzleIndex = 0;
+
+	const USkeletalMeshComponent* Mesh = GetWeaponMesh();
+	auto AddMuzzle = [this, Mesh](FName SocketName) {
+		FMuzzle& Muzzle = Muzzles.AddDefaulted_GetRef();
+		Muzzle.SocketName = SocketName;
+
+		if (const USkeletalMeshSocket* Socket = Mesh->GetSocketByName(SocketName)) {
+			Muzzle.BoneIndex = Mesh->GetBoneIndex(Socket->BoneName);
+			Muzzle.LocalTransform = Socket->GetSocketLocalTransform();
+		} else {
+			// Bones double as sockets
+			Muzzle.BoneIndex = Mesh->GetBoneIndex(SocketName);
+		}
+	};
+
+	AddMuzzle(WeaponBarrelSocket);
+	for (const FName SocketName : AdditionalBarrelSockets) {
+		AddMuzzle(SocketName);
+	}
+}
+
+
+FTransform ARangedWeapon::GetMuzzleTransform(int32 MuzzleIndex) const {
+	if (!Muzzles.IsValidIndex(MuzzleIndex)) {
+		return GetWeaponMesh()->GetSocketTransform(WeaponBarrelSocket);
+	}
+
+	const FMuzzle& Muzzle = Muzzles[MuzzleIndex];
+	if (Muzzle.BoneIndex == INDEX_NONE) {
+		return GetWeaponMesh()->GetSocketTransform(Muzzle.SocketName);
+	}
+
+	return Muzzle.LocalTransform * GetWeaponMesh()->GetBoneTransform(Muzzle.BoneIndex);
+}
+
+
+int32 ARangedWeapon::FindMuzzleIndex(const FVector& ShotOrigin) const {
+	if (Muzzles.Num() <= 1) {
+		return 0;
+	}
+
+	int32 ClosestIndex = 0;
+	double ClosestDistanceSquared = UE_DOUBLE_BIG_NUMBER;
+	for (int32 MuzzleIndex = 0; MuzzleIndex < Muzzles.Num(); ++MuzzleIndex) {
+		const double DistanceSquared = FVector::DistSquared(GetMuzzleTransform(MuzzleIndex).GetLocation(), ShotOrigin);
+		if (DistanceSquared < ClosestDistanceSquared) {
+			ClosestDistanceSquared = DistanceSquared;
+			ClosestIndex = MuzzleIndex;
+		}
+	}
+	return ClosestIndex;
+}
+
+
+void ARangedWeapon::GatherMuzzleVolley(FMuzzleVolley& OutVolley) {
+	OutVolley.PelletsPerMuzzle = WeaponData.ShotPattern == EShotPattern::ESP_Spread ? FMath::Max(WeaponData.PelletsPerBullet, 1) : 1;
+
+	const int32 NumMuzzles = GetNumMuzzles();
+	if (MuzzleFiringOrder == EMuzzleFiringOrder::EMFO_Simultaneous) {
+		for (int32 MuzzleIndex = 0; MuzzleIndex < NumMuzzles; ++MuzzleIndex) {
+			OutVolley.MuzzleIndices.Add(MuzzleIndex);
+		}
+	} else {
+		OutVolley.MuzzleIndices.Add(NextMuzzleIndex % NumMuzzles);
+		NextMuzzleIndex = (NextMuzzleIndex + 1) % NumMuzzles;
+	}
+
+	for (const int32 MuzzleIndex : OutVolley.MuzzleIndices) {
+		OutVolley.MuzzleTransforms.Add(GetMuzzleTransform(MuzzleIndex));
+	}
+
+	// Restarts the cosmetic sequence at the volley's first muzzle, so volleys that queued no
+	// cosmetics, such as abstract AI shots, cannot shift the muzzles clients replay from
+	const uint16 VolleySequence = static_cast<uint16>(FMath::Min(OutVolley.MuzzleIndices[0] * OutVolley.PelletsPerMuzzle, static_cast<int32>(MAX_uint16)));
+	if (VolleySequence != NextShotCosmeticSequence && !PendingShotCosmetics.IsEmpty()) {
+		// The batch numbers its shots consecutively, a jump needs a batch of its own
+		FlushShotCosmetics();
+	}
+	NextShotCosmeticSequence = VolleySequence;
+}
+
+
+/**
+ * Adds a shot to this frame's cosmetic batch.
+ *
+ * @note The first shot of a frame registers the weapon for the end of frame flush
+ * @remark With weapon.Net.BatchShotCosmetics disabled, sends one multicast per shot instead
+ */
+void ARangedWeapon::QueueShotCosmetic(const FVector& ShotOrigin, const FVector& ShotEnd, bool bHit) {
+	if (!HasAuthority() || GetNetMode() == NM_Standalone) {
+		return;
+	}
+
+	UWeaponSubsystem* WeaponSubsystem = GetWorld()->GetSubsystem<UWeaponSubsystem>();
+	const uint8 Seed = static_cast<uint8>(FMath::RandHelper(256));
+
+	if (!ShotCosmetics::CVarBatchShotCosmetics.GetValueOnGameThread()) {
+		FVector_NetQuantize QuantizedEnd(ShotEnd);
+		MulticastShotCosmetic(QuantizedEnd, bHit, Seed);
+
+		if (WeaponSubsystem) {
+			WeaponSubsystem->RecordShotCosmeticRPCs(ShotCosmetics::GetNumClientConnections(GetWorld()), 1, STATS ? ShotCosmetics::GetPayloadBits(QuantizedEnd, Seed) : 0);
+		}
+		return;
+	}
+
+	if (PendingShotCosmetics.IsFull()) {
+		FlushShotCosmetics();
+	}
+
+	if (PendingShotCosmetics.IsEmpty()) {
+		PendingShotCosmetics.FirstShotSequence = NextShotCosmeticSequence;
+		if (WeaponSubsystem) {
+			WeaponSubsystem->QueueShotCosmeticFlush(this);
+		}
+	}
+
+	PendingShotCosmetics.Add(ShotOrigin, ShotEnd, bHit, Seed);
+
+	// Wrapped to one round of pellets over every muzzle, so the count never overflows mid cycle
+	const int32 PelletsPerMuzzle = WeaponData.ShotPattern == EShotPattern::ESP_Spread ? FMath::Max(WeaponData.PelletsPerBullet, 1) : 1;
+	const int32 CycleLength = FMath::Min(GetNumMuzzles() * PelletsPerMuzzle, static_cast<int32>(MAX_uint16));
+	NextShotCosmeticSequence = static_cast<uint16>((NextShotCosmeticSequence + 1) % FMath::Max(CycleLength, 1));
+}
+
+
+/**
+ * Sends the pending cosmetic batch, if any.
+ *
+ * @note Unreliable - a dropped batch only loses effects
+ * @remark Goes only to connections in range unless weapon.Net.ShotInterestManagement is disabled
+ */
+void ARangedWeapon::FlushShotCosmetics() {
+	if (PendingShotCosmetics.IsEmpty()) {
+		return;
+	}
+
+	UWeaponSubsystem* WeaponSubsystem = GetWorld()->GetSubsystem<UWeaponSubsystem>();
+	int32 NumRecipients = 0;
+
+	if (WeaponSubsystem && ShotCosmetics::CVarShotInterestManagement.GetValueOnGameThread()) {
+		NumRecipients = WeaponSubsystem->DeliverShotCosmetics(this, PendingShotCosmetics, WeaponData.ShotAudibleRange, WeaponData.ShotVisibleRange);
+	} else {
+		MulticastShotCosmetics(PendingShotCosmetics);
+		NumRecipients = ShotCosmetics::GetNumClientConnections(GetWorld());
+	}
+
+	if (WeaponSubsystem) {
+		WeaponSubsystem->RecordShotCosmeticRPCs(NumRecipients, PendingShotCosmetics.Shots.Num(), STATS ? ShotCosmetics::GetPayloadBits(PendingShotCosmetics) : 0);
+	}
+
+	PendingShotCosmetics.Reset();
+}
+
+
+void ARangedWeapon::MulticastShotCosmetics_Implementation(const FShotCosmeticBatch& Batch) {
+	ReceiveShotCosmetics(Batch);
+}
+
+
+/**
+ * Replays every shot of a received batch.
+ *
+ * @param Batch Shots fired by this weapon in one server frame
+ * @note The batch carries a single origin, so multi-muzzle weapons spread the
+ *       shots over their own muzzles by the server's shot sequence instead
+ * @remark Indexed by sequence rather than a local count, so dropped batches and
+ *         late joins do not shift the muzzle of every later shot
+ */
+void ARangedWeapon::ReceiveShotCosmetics(const FShotCosmeticBatch& Batch) {
+	if (!ShouldPlayRemoteShotCosmetics()) {
+		return;
+	}
+
+	const int32 NumMuzzles = GetNumMuzzles();
+	const int32 PelletsPerMuzzle = WeaponData.ShotPattern == EShotPattern::ESP_Spread ? FMath::Max(WeaponData.PelletsPerBullet, 1) : 1;
+
+	for (int32 ShotIndex = 0; ShotIndex < Batch.Shots.Num(); ++ShotIndex) {
+		const FShotCosmetic& Shot = Batch.Shots[ShotIndex];
+		const int32 Sequence = Batch.FirstShotSequence + ShotIndex;
+		const FVector ShotEnd = Batch.Origin + Shot.EndOffset;
+		const FVector ShotOrigin = NumMuzzles > 1 ? GetMuzzleTransform((Sequence / PelletsPerMuzzle) % NumMuzzles).GetLocation() : Batch.Origin;
+
+		PlayShotCosmetic(ShotOrigin, ShotEnd, Shot.bHit, Shot.Seed);
+	}
+}
+
+
+void ARangedWeapon::MulticastShotCosmetic_Implementation(FVector_NetQuantize ShotEnd, bool bHit, uint8 Seed) {
+	if (!ShouldPlayRemoteShotCosmetics()) {
+		return;
+	}
+
+	PlayShotCosmetic(GetMuzzleTransform(0).GetLocation(), ShotEnd, bHit, Seed);
+}
+
+
+/**
+ * The server and the shooting client already played the shot locally.
+ */
+bool ARangedWeapon::ShouldPlayRemoteShotCosmetics() const {
+	if (HasAuthority() || GetNetMode() == NM_DedicatedServer) {
+		return false;
+	}
+
+	return !GetOwningCharacter() || !GetOwningCharacter()->IsLocallyControlled();
+}
+
+
+/**
+ * Plays muzzle flash, trail and impact effect for a replicated shot.
+ *
+ * @note The seed rolls the impact effect so repeated hits on one surface differ identically on every client
+ */
+void ARangedWeapon::PlayShotCosmetic(const FVector& ShotOrigin, const FVector& ShotEnd, bool bHit, uint8 Seed) {
+	FWeaponObjectCreationScope ObjectCreationScope;
+
+	SpawnMuzzleFlash(FindMuzzleIndex(ShotOrigin));
+
+	FHitResult CosmeticHitResult;
+	CosmeticHitResult.bBlockingHit = bHit;
+	CosmeticHitResult.TraceStart = ShotOrigin;
+	CosmeticHitResult.TraceEnd = ShotEnd;
+	CosmeticHitResult.ImpactPoint = ShotEnd;
+	SpawnBulletTrail(FTransform((ShotEnd - ShotOrigin).Rotation(), ShotOrigin), CosmeticHitResult);
+
+	if (bHit && WeaponData.ImpactParticle) {
+		FRotator ImpactRotation = (ShotOrigin - ShotEnd).Rotation();
+		ImpactRotation.Roll = FRandomStream(Seed).FRandRange(0.0f, 360.0f);
+		UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), WeaponData.ImpactParticle, ShotEnd, ImpactRotation, FVector(1.0f), true, EPSCPoolMethod::AutoRelease);
+		CSV_WEAPON_COUNT(Effects, 1);
+	}
 }
 
 
@@ -94,66 +461,81 @@ void ARangedWeapon::ShootWeapon( const TArray<AActor*>& IgnoredActors, FHitResul
  * 
  * @note Plays firing sound regardless of hit success
  * @remark Supports both precision and scatter shot configurations
+ * @see UWeaponSubsystem::GetGunfireVolumeMultiplier() for sound occlusion
+ * @see UWeaponSubsystem::ReportGunfire() for AI hearing
+ * @remark Counted and timed in the Weapon and WeaponClass CSV categories
  */
 void ARangedWeapon::ExecuteWeaponFire( const TArray<AActor*>& IgnoredActors, FHitResult& WeaponFireHitResult, AController* InstigatorController ) {
-	// Handle different shot patterns
-	switch (WeaponData.ShotPattern) {
-		case EShotPattern::ESP_Single:
-			ShootWeapon(IgnoredActors, WeaponFireHitResult, InstigatorController);
-			break;
+	CSV_WEAPON_SCOPED_TIMING(Fire);
+	CSV_WEAPON_CLASS_SCOPE(this);
+	FWeaponObjectCreationScope ObjectCreationScope;
 
-		case EShotPattern::ESP_Spread:
-			// Fire multiple pellets for spread pattern
-			for (uint8 Pellet = 1; Pellet <= WeaponData.PelletsPerBullet; Pellet++) {
-				ShootWeapon(IgnoredActors, WeaponFireHitResult, InstigatorController);
-			}
-			break;
-	}
+	// Every muzzle and pellet of the trigger event goes through one pass
+	FMuzzleVolley Volley;
+	GatherMuzzleVolley(Volley);
+	const int32 NumPellets = Volley.Num() * Volley.PelletsPerMuzzle;
+
+	CSV_WEAPON_COUNT(Shots, 1);
+	CSV_WEAPON_COUNT(Pellets, NumPellets);
+
+	TRACE_WEAPON_SHOT(this, InstigatorController, Volley.MuzzleTransforms[0], WeaponData.WeaponRange, static_cast<uint8>(WeaponData.FiringMode),
+		CurrentBurstShotCount, bShouldBurstShotCooldown, WeaponData.WeaponFireRate, NumPellets);
 
-	// Play weapon sound if configured
+	ShootWeapon(Volley, IgnoredActors, WeaponFireHitResult, InstigatorController);
+
+	const FVector SoundLocation = GetActorLocation();
+	UWeaponSubsystem* WeaponSubsystem = GetWorld()->GetSubsystem<UWeaponSubsystem>();
+
+	// Play weapon sound if configured, muffled by the cached occlusion for this area
 	if (WeaponData.WeaponFireSound) {
-		UGameplayStatics::PlaySoundAtLocation(GetWorld(), WeaponData.WeaponFireSound, 
-			GetOwner()->GetActorLocation());
+		const float VolumeMultiplier = WeaponSubsystem ? WeaponSubsystem->GetGunfireVolumeMultiplier(SoundLocation) : 1.0f;
+
+		UGameplayStatics::PlaySoundAtLocation(GetWorld(), WeaponData.WeaponFireSound, SoundLocation, VolumeMultiplier);
+		CSV_WEAPON_COUNT(Effects, 1);
+	}
+
+	// Let AI hear the shot - aggregated per shooter rather than one noise event per shot
+	if (WeaponSubsystem && HasAuthority() && WeaponData.NoiseLoudness > 0.0f) {
+		AActor* NoiseInstigator = GetOwningCharacter() ? static_cast<AActor*>(GetOwningCharacter()) : this;
+		WeaponSubsystem->ReportGunfire(NoiseInstigator, SoundLocation, WeaponData.NoiseLoudness, WeaponData.NoiseRange);
 	}
 }
 
 
 /**
- * Resets global firing cooldown state.
+ * Re-enables single-shot weapons after firing.
  * 
- * @note Called automatically by weapon timers
- * @warning Only affects weapons currently in cooldown
+ * @note Only affects weapons in single-fire mode
+ * @remark The fire rate still applies, see ExecuteSingleFire()
  */
-void ARangedWeapon::ResetShouldFireWeapon() {
-	if (!bShouldFireWeapon) {
+void ARangedWeapon::ResetShouldFireSingleShot() {
+	if (!bShouldFireWeapon && WeaponData.FiringMode == EFiringMode::EFM_Single) {
 		bShouldFireWeapon = true;
 	}
 }
 
 
-/**
- * Completes burst sequence recovery period.
- * 
- * @note Managed internally by burst fire logic
- * @warning Duration controlled by WeaponData.BurstShotCooldown
- */
-void ARangedWeapon::ResetBurstShotCooldown() {
-	if (bShouldBurstShotCooldown) {
-		bShouldBurstShotCooldown = false;
-	}
+double ARangedWeapon::GetSimulationTime() const {
+	const UWeaponSubsystem* WeaponSubsystem = GetWorld()->GetSubsystem<UWeaponSubsystem>();
+	return WeaponSubsystem ? WeaponSubsystem->GetSimulationTime() : GetWorld()->GetTimeSeconds();
 }
 
 
 /**
- * Re-enables single-shot weapons after firing.
- * 
- * @note Only affects weapons in single-fire mode
- * @remark Timer-controlled - not for direct calls
+ * Restarts the fire rate clock when the trigger was let go since the last call.
+ *
+ * @note Shots still cooling down stay blocked - only the backlog is dropped
+ * @remark The trigger counts as released once a whole frame's worth of steps passed without a call,
+ *         so the test holds at any weapon.Sim.FixedStepHz
  */
-void ARangedWeapon::ResetShouldFireSingleShot() {
-	if (!bShouldFireWeapon && WeaponData.FiringMode == EFiringMode::EFM_Single) {
-		bShouldFireWeapon = true;
+void ARangedWeapon::UpdateTriggerHold(double SimulationTime) {
+	const UWeaponSubsystem* WeaponSubsystem = GetWorld()->GetSubsystem<UWeaponSubsystem>();
+	const double MaxTriggerGap = WeaponSubsystem ? WeaponSubsystem->GetMaxSimulationAdvance() : WeaponCadence::DefaultMaxTriggerGap;
+
+	if (SimulationTime - LastTriggerTime > MaxTriggerGap) {
+		NextFireTime = FMath::Max(NextFireTime, SimulationTime);
 	}
+	LastTriggerTime = SimulationTime;
 }
 
 
@@ -168,22 +550,27 @@ void ARangedWeapon::ResetShouldFireSingleShot() {
  * @remark Enforces cooldown between burst sequences
  */
 void ARangedWeapon::ExecuteBurstFire( const TArray<AActor*>& IgnoredActors, FHitResult& WeaponFireHitResult, AController* InstigatorController ) {
-	if (bShouldFireWeapon && !bShouldBurstShotCooldown) {
-		// Fire single shot in burst sequence
+	const double SimulationTime = GetSimulationTime();
+	UpdateTriggerHold(SimulationTime);
+	bShouldBurstShotCooldown = SimulationTime < BurstCooldownEndTime;
+
+	for (int32 NumShots = 0; NumShots < WeaponCadence::MaxShotsPerAttack; ++NumShots) {
+		// Next shot is due once both the fire rate and any burst cooldown have elapsed
+		const double ShotTime = FMath::Max(NextFireTime, BurstCooldownEndTime);
+		if (ShotTime > SimulationTime) {
+			break;
+		}
+
+		bShouldBurstShotCooldown = false;
 		ExecuteWeaponFire(IgnoredActors, WeaponFireHitResult, InstigatorController);
-		bShouldFireWeapon = false;
-		CurrentBurstShotCount++;
+		NextFireTime = ShotTime + FMath::Max(WeaponData.WeaponFireRate, WeaponCadence::MinFireInterval);
 
 		// Check if burst sequence is complete
-		if (CurrentBurstShotCount >= WeaponData.MaxBurstShotCount) {
+		if (++CurrentBurstShotCount >= WeaponData.MaxBurstShotCount) {
 			CurrentBurstShotCount = 0;
 			bShouldBurstShotCooldown = true;
-			// Start burst cooldown timer
-			GetWorld()->GetTimerManager().SetTimer(WeaponBurstCooldownTimer, this, &ARangedWeapon::ResetBurstShotCooldown, WeaponData.BurstShotCooldown);
+			BurstCooldownEndTime = ShotTime + WeaponData.BurstShotCooldown;
 		}
-
-		// Set timer for next shot in burst
-		GetWorld()->GetTimerManager().SetTimer(WeaponFireTimer, this, &ARangedWeapon::ResetShouldFireWeapon, WeaponData.WeaponFireRate, false);
 	}
 }
 
@@ -199,9 +586,11 @@ void ARangedWeapon::ExecuteBurstFire( const TArray<AActor*>& IgnoredActors, FHit
  * @remark Cooldown controlled by WeaponFireRate
  */
 void ARangedWeapon::ExecuteSingleFire( const TArray<AActor*>& IgnoredActors, FHitResult& WeaponFireHitResult, AController* InstigatorController ) {
-	if (bShouldFireWeapon) {
+	const double SimulationTime = GetSimulationTime();
+	if (bShouldFireWeapon && NextFireTime <= SimulationTime) {
 		ExecuteWeaponFire(IgnoredActors, WeaponFireHitResult, InstigatorController);
 		bShouldFireWeapon = false;
+		NextFireTime = SimulationTime + WeaponData.WeaponFireRate;
 	}
 }
 
@@ -215,13 +604,16 @@ void ARangedWeapon::ExecuteSingleFire( const TArray<AActor*>& IgnoredActors, FHi
  * 
  * @note Fires continuously while trigger is active
  * @warning Can rapidly consume ammunition reserves
+ * @remark Fires every shot the weapon clock owes since the last call, so the
+ *         rate of fire is the same at any frame rate
  */
 void ARangedWeapon::ExecuteAutomaticFire( const TArray<AActor*>& IgnoredActors, FHitResult& WeaponFireHitResult, AController* InstigatorController ) {
-	if (bShouldFireWeapon) {
+	const double SimulationTime = GetSimulationTime();
+	UpdateTriggerHold(SimulationTime);
+
+	for (int32 NumShots = 0; NumShots < WeaponCadence::MaxShotsPerAttack && NextFireTime <= SimulationTime; ++NumShots) {
 		ExecuteWeaponFire(IgnoredActors, WeaponFireHitResult, InstigatorController);
-		bShouldFireWeapon = false;
-		// Set timer for next automatic shot
-		GetWorld()->GetTimerManager().SetTimer(WeaponFireTimer,this, &ARangedWeapon::ResetShouldFireWeapon, WeaponData.WeaponFireRate, false);
+		NextFireTime += FMath::Max(WeaponData.WeaponFireRate, WeaponCadence::MinFireInterval);
 	}
 }
 
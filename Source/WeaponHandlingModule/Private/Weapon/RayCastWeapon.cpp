@@ -2,10 +2,13 @@
 
 #include "Weapon/RayCastWeapon.h"
 
+#include "AIController.h"
 #include "Logging.h"
-#include "Engine/SkeletalMeshSocket.h"
 #include "GameFramework/Character.h"
 #include "Kismet/GameplayStatics.h"
+#include "Subsystem/WeaponSubsystem.h"
+#include "Trace/WeaponCsvStats.h"
+#include "Trace/WeaponShotTrace.h"
 
 /**
  * Constructs a raycast weapon with default values.
@@ -41,52 +44,121 @@ void ARayCastWeapon::Tick(float DeltaTime) {
 /**
  * Determines weapon firing method and executes appropriate trace.
  * 
+ * @param Volley Muzzles firing on this trigger event
  * @param IgnoredActors Entities excluded from hit detection
  * @param WeaponFireHitResult Output container for hit data
  * @param InstigatorController Responsible controller reference
  * 
  * @note Uses WeaponData configuration to choose between trace methods
+ * @remark The aim trace is shared by the volley - pellets of a muzzle share its
+ *         barrel trace, so a volley costs one trace plus one per muzzle at most
  * @see WeaponTrace()
  * @see ScreenTrace()
  */
-void ARayCastWeapon::ShootWeapon( const TArray<AActor*>& IgnoredActors, FHitResult& WeaponFireHitResult, AController* InstigatorController ) {
-	Super::ShootWeapon(IgnoredActors, WeaponFireHitResult, InstigatorController);
+void ARayCastWeapon::ShootWeapon( const FMuzzleVolley& Volley, const TArray<AActor*>& IgnoredActors, FHitResult& WeaponFireHitResult, AController* InstigatorController ) {
+	// Unobserved AI firefights are resolved without traces or effects
+	if (TryResolveAbstractShot(Volley.Num() * Volley.PelletsPerMuzzle, WeaponFireHitResult, InstigatorController)) {
+		return;
+	}
 
-	if (WeaponData.bShouldPerformWeaponTraceTest) {
-		WeaponTrace(WeaponFireHitResult, IgnoredActors);
-	} else {
-		// Perform screen trace if not using weapon trace
-		ScreenTrace(WeaponFireHitResult, IgnoredActors);
+	Super::ShootWeapon(Volley, IgnoredActors, WeaponFireHitResult, InstigatorController);
+
+	FHitResult AimHitResult;
+	ScreenTrace(AimHitResult, IgnoredActors);
+
+	UWeaponSubsystem* WeaponSubsystem = GetWorld()->GetSubsystem<UWeaponSubsystem>();
+
+	for (int32 VolleyIndex = 0; VolleyIndex < Volley.Num(); ++VolleyIndex) {
+		const FTransform& MuzzleTransform = Volley.MuzzleTransforms[VolleyIndex];
+		const FVector MuzzleLocation = MuzzleTransform.GetLocation();
+
+		WeaponFireHitResult = AimHitResult;
+		if (WeaponData.bShouldPerformWeaponTraceTest && AimHitResult.bBlockingHit) {
+			WeaponTrace(MuzzleLocation, WeaponFireHitResult, IgnoredActors);
+		}
+
+		const FVector ShotEnd = WeaponFireHitResult.bBlockingHit ? WeaponFireHitResult.ImpactPoint : WeaponFireHitResult.TraceEnd;
+
+		for (int32 Pellet = 0; Pellet < Volley.PelletsPerMuzzle; ++Pellet) {
+			SpawnBulletTrail(MuzzleTransform, WeaponFireHitResult);
+			TRACE_WEAPON_PELLET(this, WeaponFireHitResult);
+			QueueShotCosmetic(MuzzleLocation, ShotEnd, WeaponFireHitResult.bBlockingHit);
+
+			if (WeaponSubsystem && WeaponFireHitResult.bBlockingHit) {
+				WeaponSubsystem->ApplyWeaponDamage(WeaponData.WeaponDamage, InstigatorController, this, WeaponFireHitResult, WeaponData.ImpactParticle);
+			}
+		}
 	}
 }
 
+
 /**
- * Performs precise weapon barrel-to-impact-point trace for accurate bullet simulation.
+ * Rolls an unobserved AI volley against its focus target.
  * 
- * @param WeaponTraceHitResult Output container for trace results
- * @param IgnoredActors Entities excluded from detection
- * @return True if collision occurred between barrel and extended impact point
+ * @param NumShots Shots of the volley, each rolled separately
+ * @param WeaponFireHitResult Receives a hit on the target's root component when the last roll succeeds
+ * @param InstigatorController Responsible controller reference
+ * @return True if the volley was resolved statistically
  * 
- * @note Two-stage process:
- *       1. Initial screen trace to find approximate target
- *       2. Precise weapon trace from barrel to extended impact point
- * @remark Uses weapon socket location for realistic bullet origin
- * @warning Requires valid barrel socket on weapon mesh
+ * @note Only AI shooters with a focus actor qualify - anything else is traced
+ * @remark Cover is read from the shooter's sight perception, not traced
+ * @remark Observation and cover are checked once for the whole volley
  */
-bool ARayCastWeapon::WeaponTrace(FHitResult& WeaponTraceHitResult, const TArray<AActor*>& IgnoredActors) const {
-	if (!ScreenTrace(WeaponTraceHitResult, IgnoredActors)) {
+bool ARayCastWeapon::TryResolveAbstractShot(int32 NumShots, FHitResult& WeaponFireHitResult, AController* InstigatorController) {
+	const AAIController* AIController = Cast<AAIController>(InstigatorController);
+	if (!AIController || !HasAuthority() || !FAbstractCombatResolver::IsEnabled()) {
 		return false;
 	}
-	
-	const USkeletalMeshSocket* BarrelSocket = GetWeaponMesh()->GetSocketByName(WeaponBarrelSocket);
 
-	if (!BarrelSocket) {
-		UE_LOG(LogWeaponHandlingModule, Error, TEXT("Invalid barrel socket"));
+	AActor* Target = AIController->GetFocusActor();
+	UWeaponSubsystem* WeaponSubsystem = GetWorld()->GetSubsystem<UWeaponSubsystem>();
+	if (!Target || !WeaponSubsystem) {
 		return false;
-	} 
+	}
+
+	const FVector ShotOrigin = GetActorLocation();
+	const FVector TargetLocation = Target->GetActorLocation();
+	if (WeaponSubsystem->IsObservedByPlayer(ShotOrigin, TargetLocation, WeaponData.ShotAudibleRange, WeaponData.ShotVisibleRange)) {
+		return false;
+	}
 
+	FAbstractCombatResolver& Resolver = WeaponSubsystem->GetAbstractCombatResolver();
+	const bool bTargetInCover = FAbstractCombatResolver::IsTargetInCover(AIController, Target);
+	const float HitChance = Resolver.GetHitChance(WeaponData.AIAccuracy, FVector::Dist(ShotOrigin, TargetLocation), WeaponData.WeaponRange, bTargetInCover);
+
+	for (int32 Shot = 0; Shot < NumShots; ++Shot) {
+		if (!Resolver.RollHit(HitChance)) {
+			WeaponFireHitResult = FHitResult(ShotOrigin, TargetLocation);
+			TRACE_WEAPON_PELLET(this, WeaponFireHitResult);
+			continue;
+		}
+
+		WeaponFireHitResult = FHitResult(Target, Cast<UPrimitiveComponent>(Target->GetRootComponent()), TargetLocation, (ShotOrigin - TargetLocation).GetSafeNormal());
+		WeaponFireHitResult.TraceStart = ShotOrigin;
+		WeaponFireHitResult.TraceEnd = TargetLocation;
+		TRACE_WEAPON_PELLET(this, WeaponFireHitResult);
+
+		WeaponSubsystem->ApplyWeaponDamage(WeaponData.WeaponDamage, InstigatorController, this, WeaponFireHitResult, nullptr);
+	}
+	return true;
+}
+
+/**
+ * Performs precise weapon barrel-to-impact-point trace for accurate bullet simulation.
+ * 
+ * @param MuzzleLocation Where the shot leaves the weapon
+ * @param WeaponTraceHitResult Screen trace hit in, barrel trace hit out
+ * @param IgnoredActors Entities excluded from detection
+ * @return True if collision occurred between barrel and extended impact point
+ * 
+ * @note Second stage of a two-stage process:
+ *       1. Initial screen trace to find approximate target, once per volley
+ *       2. Precise weapon trace from barrel to extended impact point, once per muzzle
+ * @remark Uses the cached muzzle location for realistic bullet origin
+ */
+bool ARayCastWeapon::WeaponTrace(const FVector& MuzzleLocation, FHitResult& WeaponTraceHitResult, const TArray<AActor*>& IgnoredActors) const {
 	// Calculate bullet path from barrel to extended impact point
-	FVector BarrelLocation = BarrelSocket->GetSocketLocation(GetWeaponMesh());
+	const FVector BarrelLocation = MuzzleLocation;
 	const FVector Direction = (WeaponTraceHitResult.ImpactPoint - BarrelLocation).GetSafeNormal();
 	WeaponTraceHitResult.TraceStart = BarrelLocation;
 	WeaponTraceHitResult.TraceEnd = WeaponTraceHitResult.ImpactPoint + Direction * WeaponData.WeaponRange;
@@ -96,6 +168,7 @@ bool ARayCastWeapon::WeaponTrace(FHitResult& WeaponTraceHitResult, const TArray<
 	CollisionParams.AddIgnoredActors(IgnoredActors);
 	
 	// Perform precise weapon trace
+	CSV_WEAPON_COUNT(Traces, 1);
 	GetWorld()->LineTraceSingleByChannel(WeaponTraceHitResult, BarrelLocation, WeaponTraceHitResult.TraceEnd, ECollisionChannel::ECC_Visibility, CollisionParams);
 
 	return WeaponTraceHitResult.bBlockingHit;
@@ -113,23 +186,40 @@ bool ARayCastWeapon::WeaponTrace(FHitResult& WeaponTraceHitResult, const TArray<
  *         1. Gets viewport center
  *         2. Deprojects to world space
  *         3. Traces along view direction
- * @warning Requires:
- *          - Valid owning character
- *          - Player controller
- *          - Game viewport
+ * @note Weapons without an owning character aim along their first barrel
  */
 bool ARayCastWeapon::ScreenTrace(FHitResult& ScreenTraceHitResult, const TArray<AActor*>& IgnoredActors) const {
-	// Get viewport dimensions
-	FVector2D ViewportSize;
-	GEngine->GameViewport->GetViewportSize(ViewportSize);
-
-	// Calculate screen center for aiming
-	const FVector2D ScreenCenter = ViewportSize / 2;
+	AController* OwningController = GetOwningCharacter() ? GetOwningCharacter()->GetController() : nullptr;
+	if (GetOwningCharacter() && !OwningController) {
+		UE_LOG(LogWeaponHandlingModule, Warning, TEXT("RayCastWeapon: No controller to aim with"));
+		return false;
+	}
 
-	// Convert screen position to world space vectors
 	FVector WorldDirection;
 	FVector WorldLocation;
-	UGameplayStatics::DeprojectScreenToWorld(Cast<APlayerController>(GetOwningCharacter()->GetController()), ScreenCenter,WorldLocation,WorldDirection);
+
+	APlayerController* PlayerController = Cast<APlayerController>(OwningController);
+	if (!OwningController) {
+		// Sentries turn the whole weapon towards their target
+		const FTransform MuzzleTransform = GetMuzzleTransform(0);
+		WorldLocation = MuzzleTransform.GetLocation();
+		WorldDirection = MuzzleTransform.GetRotation().Vector();
+	} else if (PlayerController && PlayerController->IsLocalController() && GEngine->GameViewport) {
+		// Get viewport dimensions
+		FVector2D ViewportSize;
+		GEngine->GameViewport->GetViewportSize(ViewportSize);
+
+		// Calculate screen center for aiming
+		const FVector2D ScreenCenter = ViewportSize / 2;
+
+		// Convert screen position to world space vectors
+		UGameplayStatics::DeprojectScreenToWorld(PlayerController, ScreenCenter,WorldLocation,WorldDirection);
+	} else {
+		// AI and remote players have no viewport here - aim along their view point instead
+		FRotator ViewRotation;
+		OwningController->GetPlayerViewPoint(WorldLocation, ViewRotation);
+		WorldDirection = ViewRotation.Vector();
+	}
 
 	// Calculate trace start and end points
 	const FVector TraceStart = WorldLocation;
@@ -140,6 +230,7 @@ bool ARayCastWeapon::ScreenTrace(FHitResult& ScreenTraceHitResult, const TArray<
 	CollisionParams.AddIgnoredActors(IgnoredActors);
 	
 	// Perform the line trace
+	CSV_WEAPON_COUNT(Traces, 1);
 	GetWorld()->LineTraceSingleByChannel(ScreenTraceHitResult, TraceStart, TraceEnd, ECollisionChannel::ECC_Visibility, CollisionParams);
 
 	// Return hit status
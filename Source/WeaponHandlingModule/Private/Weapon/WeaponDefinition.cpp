@@ -0,0 +1,78 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Weapon/WeaponDefinition.h"
+
+#include "Logging.h"
+#include "Engine/AssetManager.h"
+#include "Hash/CityHash.h"
+#include "UObject/AssetRegistryTagsContext.h"
+#include "Weapon/ProjectileWeapon.h"
+#include "Weapon/RayCastWeapon.h"
+
+const FPrimaryAssetType UWeaponDefinition::PrimaryAssetType(TEXT("WeaponDefinition"));
+
+const FName UWeaponDefinition::SourceHashTag(TEXT("WeaponDefinitionSourceHash"));
+
+
+FPrimaryAssetId UWeaponDefinition::GetPrimaryAssetId() const {
+	return FPrimaryAssetId(PrimaryAssetType, GetFName());
+}
+
+
+void UWeaponDefinition::GetAssetRegistryTags(FAssetRegistryTagsContext Context) const {
+	Super::GetAssetRegistryTags(Context);
+
+	Context.AddTag(FAssetRegistryTag(SourceHashTag, FString::Printf(TEXT("%016llx"), ComputeSourceHash()), FAssetRegistryTag::TT_Hidden));
+}
+
+
+bool UWeaponDefinition::CanBeClusterRoot() const {
+	return true;
+}
+
+
+const UWeaponDefinition* UWeaponDefinition::Load(const FPrimaryAssetId& DefinitionId) {
+	if (!DefinitionId.IsValid() || !UAssetManager::IsInitialized()) {
+		return nullptr;
+	}
+
+	const FSoftObjectPath DefinitionPath = UAssetManager::Get().GetPrimaryAssetPath(DefinitionId);
+	const UWeaponDefinition* Definition = Cast<UWeaponDefinition>(DefinitionPath.TryLoad());
+	if (!Definition) {
+		UE_LOG(LogWeaponHandlingModule, Warning, TEXT("WeaponDefinition: %s does not resolve to a weapon definition"), *DefinitionId.ToString());
+	}
+
+	return Definition;
+}
+
+
+/**
+ * @note Exports full values rather than deltas from the class default, so editing the default changes it too
+ */
+uint64 UWeaponDefinition::ComputeSourceHash() const {
+	FString SourceText;
+	for (TFieldIterator<FProperty> It(StaticClass(), EFieldIteratorFlags::ExcludeSuper); It; ++It) {
+		SourceText += It->GetName();
+		It->ExportText_InContainer(0, SourceText, this, nullptr, nullptr, PPF_None);
+	}
+
+	const FTCHARToUTF8 Utf8SourceText(*SourceText);
+	return CityHash64(reinterpret_cast<const char*>(Utf8SourceText.Get()), Utf8SourceText.Length());
+}
+
+
+TSubclassOf<ARangedWeapon> UWeaponDefinition::GetWeaponClass() const {
+	return GetWeaponClass(Delivery);
+}
+
+
+TSubclassOf<ARangedWeapon> UWeaponDefinition::GetWeaponClass(EWeaponDelivery Delivery) {
+	switch (Delivery) {
+		case EWeaponDelivery::EWD_Projectile:
+			return AProjectileWeapon::StaticClass();
+
+		case EWeaponDelivery::EWD_RayCast:
+		default:
+			return ARayCastWeapon::StaticClass();
+	}
+}
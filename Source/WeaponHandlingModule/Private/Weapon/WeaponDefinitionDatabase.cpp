@@ -0,0 +1,277 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Weapon/WeaponDefinitionDatabase.h"
+
+#include "Logging.h"
+#include "Algo/BinarySearch.h"
+#include "Async/MappedFileHandle.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StaticMesh.h"
+#include "HAL/PlatformFileManager.h"
+#include "Hash/CityHash.h"
+#include "Misc/Paths.h"
+#include "Particles/ParticleSystem.h"
+#include "Projectile/WeaponProjectileActor.h"
+#include "Sound/SoundBase.h"
+#include "Weapon/ProjectileWeapon.h"
+#include "Weapon/WeaponDefinition.h"
+
+static TAutoConsoleVariable<bool> CVarUseCookedWeaponDefinitions(
+	TEXT("weapon.Definitions.UseCookedDatabase"),
+	true,
+	TEXT("Read weapon definitions from the mapped cooked database instead of loading the definition assets."));
+
+namespace WeaponDefinitionDatabase {
+	/** Whether every string and string reference range of a record lies inside its sections */
+	bool IsValidRecord(const FCookedWeaponDefinition& Record, const FWeaponDefinitionDatabaseHeader& Header) {
+		const uint32 StringOffsets[] = {
+			Record.Name, Record.WeaponMesh, Record.MuzzleFlash, Record.BeamTrail, Record.ImpactParticle,
+			Record.WeaponFireSound, Record.ProjectileMesh, Record.ProjectileActorClass, Record.BarrelSocket
+		};
+		for (const uint32 Offset : StringOffsets) {
+			if (Offset >= Header.StringsSize) {
+				return false;
+			}
+		}
+
+		return static_cast<uint64>(Record.FirstAdditionalBarrelSocket) + Record.NumAdditionalBarrelSockets <= static_cast<uint64>(Header.NumStringRefs);
+	}
+}
+
+FWeaponDefinitionDatabase::FWeaponDefinitionDatabase() = default;
+
+FWeaponDefinitionDatabase::~FWeaponDefinitionDatabase() = default;
+
+
+FWeaponDefinitionDatabase& FWeaponDefinitionDatabase::Get() {
+	static FWeaponDefinitionDatabase Database;
+	return Database;
+}
+
+
+FString FWeaponDefinitionDatabase::GetFilename() {
+	return FPaths::ProjectContentDir() / TEXT("WeaponData/WeaponDefinitions.wdef");
+}
+
+
+uint64 FWeaponDefinitionDatabase::HashName(const FString& DefinitionName) {
+	const FTCHARToUTF8 Utf8Name(*DefinitionName.ToLower());
+	return CityHash64(reinterpret_cast<const char*>(Utf8Name.Get()), Utf8Name.Length());
+}
+
+
+/**
+ * Maps the database file and validates its header and contents.
+ *
+ * @note A missing file is not reported - weapons then load their definition assets
+ * @remark Every offset is checked here once, so lookups can read the records unchecked
+ */
+bool FWeaponDefinitionDatabase::Load() {
+	Reset();
+
+	const FString Filename = GetFilename();
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (!PlatformFile.FileExists(*Filename)) {
+		return false;
+	}
+
+	MappedFile.Reset(PlatformFile.OpenMapped(*Filename));
+	if (!MappedFile.IsValid() || MappedFile->GetFileSize() < static_cast<int64>(sizeof(FWeaponDefinitionDatabaseHeader))) {
+		UE_LOG(LogWeaponHandlingModule, Warning, TEXT("WeaponDefinitionDatabase: Could not map %s"), *Filename);
+		Reset();
+		return false;
+	}
+
+	MappedRegion.Reset(MappedFile->MapRegion());
+	if (!MappedRegion.IsValid()) {
+		UE_LOG(LogWeaponHandlingModule, Warning, TEXT("WeaponDefinitionDatabase: Could not map %s"), *Filename);
+		Reset();
+		return false;
+	}
+
+	const FWeaponDefinitionDatabaseHeader* MappedHeader = reinterpret_cast<const FWeaponDefinitionDatabaseHeader*>(MappedRegion->GetMappedPtr());
+	if (MappedHeader->Magic != FWeaponDefinitionDatabaseHeader::ExpectedMagic || MappedHeader->Version != FWeaponDefinitionDatabaseHeader::CurrentVersion
+		|| MappedHeader->RecordSize != sizeof(FCookedWeaponDefinition) || MappedHeader->NumDefinitions < 0 || MappedHeader->NumStringRefs < 0
+		|| MappedHeader->StringsSize == 0 || MappedHeader->GetFileSize() != MappedRegion->GetMappedSize()) {
+		UE_LOG(LogWeaponHandlingModule, Warning, TEXT("WeaponDefinitionDatabase: %s is invalid or out of date, cook it again"), *Filename);
+		Reset();
+		return false;
+	}
+
+	const TConstArrayView<FCookedWeaponDefinition> MappedRecords(reinterpret_cast<const FCookedWeaponDefinition*>(MappedRegion->GetMappedPtr() + sizeof(FWeaponDefinitionDatabaseHeader)), MappedHeader->NumDefinitions);
+	const TConstArrayView<uint32> MappedStringRefs(reinterpret_cast<const uint32*>(MappedRegion->GetMappedPtr() + MappedHeader->GetStringRefsOffset()), MappedHeader->NumStringRefs);
+	const UTF8CHAR* MappedStrings = reinterpret_cast<const UTF8CHAR*>(MappedRegion->GetMappedPtr() + MappedHeader->GetStringsOffset());
+
+	// Every string must end inside the section, and Find() relies on the sort order
+	bool bValidContents = MappedStrings[MappedHeader->StringsSize - 1] == 0;
+	for (int32 Index = 0; bValidContents && Index < MappedRecords.Num(); ++Index) {
+		bValidContents = WeaponDefinitionDatabase::IsValidRecord(MappedRecords[Index], *MappedHeader)
+			&& (Index == 0 || MappedRecords[Index - 1].NameHash <= MappedRecords[Index].NameHash);
+	}
+	for (int32 Index = 0; bValidContents && Index < MappedStringRefs.Num(); ++Index) {
+		bValidContents = MappedStringRefs[Index] < MappedHeader->StringsSize;
+	}
+
+	if (!bValidContents) {
+		UE_LOG(LogWeaponHandlingModule, Warning, TEXT("WeaponDefinitionDatabase: %s is corrupt, cook it again"), *Filename);
+		Reset();
+		return false;
+	}
+
+	Header = MappedHeader;
+	Records = MappedRecords.GetData();
+	StringRefs = MappedStringRefs.GetData();
+	Strings = MappedStrings;
+	RecordStates.Init(ERecordState::Unchecked, Header->NumDefinitions);
+
+	UE_LOG(LogWeaponHandlingModule, Log, TEXT("WeaponDefinitionDatabase: Mapped %s (%d definitions)"), *Filename, Header->NumDefinitions);
+	return true;
+}
+
+
+void FWeaponDefinitionDatabase::Reset() {
+	Header = nullptr;
+	Records = nullptr;
+	StringRefs = nullptr;
+	Strings = nullptr;
+	RecordStates.Reset();
+	MappedRegion.Reset();
+	MappedFile.Reset();
+}
+
+
+/**
+ * Finds the record by name hash, then compares names to rule out collisions.
+ *
+ * @note A record whose asset changed since the cook is skipped, so callers load the asset instead
+ */
+const FCookedWeaponDefinition* FWeaponDefinitionDatabase::Find(const FPrimaryAssetId& DefinitionId) const {
+	if (!Header || !CVarUseCookedWeaponDefinitions.GetValueOnGameThread() || DefinitionId.PrimaryAssetType != UWeaponDefinition::PrimaryAssetType) {
+		return nullptr;
+	}
+
+	const FString DefinitionName = DefinitionId.PrimaryAssetName.ToString();
+	const uint64 NameHash = HashName(DefinitionName);
+
+	const TConstArrayView<FCookedWeaponDefinition> Definitions = GetDefinitions();
+	for (int32 Index = Algo::LowerBoundBy(Definitions, NameHash, &FCookedWeaponDefinition::NameHash); Index < Definitions.Num() && Definitions[Index].NameHash == NameHash; ++Index) {
+		if (FString(GetString(Definitions[Index].Name)).Equals(DefinitionName, ESearchCase::IgnoreCase)) {
+			return IsCurrent(Index, DefinitionId) ? &Definitions[Index] : nullptr;
+		}
+	}
+	return nullptr;
+}
+
+
+/**
+ * Compares the record with the hash tag the asset was cooked with, once per record.
+ *
+ * @note Without a tag, for example when cooked tags are filtered, the record counts as stale
+ * @remark Not cached before the asset manager is up, so an early lookup is retried later
+ */
+bool FWeaponDefinitionDatabase::IsCurrent(int32 RecordIndex, const FPrimaryAssetId& DefinitionId) const {
+	ERecordState& State = RecordStates[RecordIndex];
+	if (State == ERecordState::Unchecked) {
+		if (!UAssetManager::IsInitialized()) {
+			return false;
+		}
+
+		FAssetData DefinitionAsset;
+		FString SourceHash;
+		const bool bHasSourceHash = UAssetManager::Get().GetPrimaryAssetData(DefinitionId, DefinitionAsset)
+			&& DefinitionAsset.GetTagValue(UWeaponDefinition::SourceHashTag, SourceHash);
+
+		if (bHasSourceHash && FCString::Strtoui64(*SourceHash, nullptr, 16) == Records[RecordIndex].SourceHash) {
+			State = ERecordState::Current;
+		} else {
+			UE_LOG(LogWeaponHandlingModule, Warning, TEXT("WeaponDefinitionDatabase: %s changed since the database was cooked, loading the asset"), *DefinitionId.ToString());
+			State = ERecordState::Stale;
+		}
+	}
+	return State == ERecordState::Current;
+}
+
+
+TConstArrayView<FCookedWeaponDefinition> FWeaponDefinitionDatabase::GetDefinitions() const {
+	return Header ? TConstArrayView<FCookedWeaponDefinition>(Records, Header->NumDefinitions) : TConstArrayView<FCookedWeaponDefinition>();
+}
+
+
+FUtf8StringView FWeaponDefinitionDatabase::GetString(uint32 Offset) const {
+	if (!Header || Offset >= Header->StringsSize) {
+		return FUtf8StringView();
+	}
+	return FUtf8StringView(Strings + Offset);
+}
+
+
+FName FWeaponDefinitionDatabase::GetStringRef(uint32 Index) const {
+	if (!Header || Index >= static_cast<uint32>(Header->NumStringRefs)) {
+		return NAME_None;
+	}
+	return FName(FString(GetString(StringRefs[Index])));
+}
+
+
+void FWeaponDefinitionDatabase::ResolveWeaponData(const FCookedWeaponDefinition& Definition, FWeaponData& OutWeaponData) const {
+	OutWeaponData.FiringMode = static_cast<EFiringMode>(Definition.FiringMode);
+	OutWeaponData.WeaponFireRate = Definition.WeaponFireRate;
+	OutWeaponData.MaxBurstShotCount = Definition.MaxBurstShotCount;
+	OutWeaponData.BurstShotCooldown = Definition.BurstShotCooldown;
+	OutWeaponData.WeaponRange = Definition.WeaponRange;
+	OutWeaponData.WeaponDamage = Definition.WeaponDamage;
+	OutWeaponData.bShouldPerformWeaponTraceTest = Definition.bShouldPerformWeaponTraceTest != 0;
+	OutWeaponData.ShotPattern = static_cast<EShotPattern>(Definition.ShotPattern);
+	OutWeaponData.PelletsPerBullet = Definition.PelletsPerBullet;
+	OutWeaponData.MinimumSpreadRange = Definition.MinimumSpreadRange;
+	OutWeaponData.MaximumSpreadRange = Definition.MaximumSpreadRange;
+	OutWeaponData.MuzzleFlash = ResolveAsset<UParticleSystem>(Definition.MuzzleFlash);
+	OutWeaponData.BeamTrail = ResolveAsset<UParticleSystem>(Definition.BeamTrail);
+	OutWeaponData.ImpactParticle = ResolveAsset<UParticleSystem>(Definition.ImpactParticle);
+	OutWeaponData.WeaponFireSound = ResolveAsset<USoundBase>(Definition.WeaponFireSound);
+	OutWeaponData.NoiseLoudness = Definition.NoiseLoudness;
+	OutWeaponData.NoiseRange = Definition.NoiseRange;
+	OutWeaponData.ShotAudibleRange = Definition.ShotAudibleRange;
+	OutWeaponData.ShotVisibleRange = Definition.ShotVisibleRange;
+	OutWeaponData.AIAccuracy = Definition.AIAccuracy;
+	OutWeaponData.CurrentAmmoCount = Definition.CurrentAmmoCount;
+	OutWeaponData.MaxAmmoCount = Definition.MaxAmmoCount;
+	OutWeaponData.CurrentClipCount = Definition.CurrentClipCount;
+	OutWeaponData.MaxClipCount = Definition.MaxClipCount;
+}
+
+
+void FWeaponDefinitionDatabase::ResolveProjectileData(const FCookedWeaponDefinition& Definition, FProjectileData& OutProjectileData) const {
+	OutProjectileData.MuzzleSpeed = Definition.MuzzleSpeed;
+	OutProjectileData.GravityScale = Definition.GravityScale;
+	OutProjectileData.DragCoefficient = Definition.DragCoefficient;
+	OutProjectileData.MaxFlightTime = Definition.MaxFlightTime;
+	OutProjectileData.ProjectileMesh = ResolveAsset<UStaticMesh>(Definition.ProjectileMesh);
+	OutProjectileData.ProjectileMeshScale = FVector(Definition.ProjectileMeshScale[0], Definition.ProjectileMeshScale[1], Definition.ProjectileMeshScale[2]);
+	OutProjectileData.HomingAcceleration = Definition.HomingAcceleration;
+	OutProjectileData.HomingRange = Definition.HomingRange;
+	OutProjectileData.HomingConeAngle = Definition.HomingConeAngle;
+
+	// TSubclassOf would otherwise hold a foreign class and silently read it back as null
+	UClass* ActorClass = ResolveAsset<UClass>(Definition.ProjectileActorClass);
+	if (ActorClass && !ActorClass->IsChildOf(AWeaponProjectileActor::StaticClass())) {
+		UE_LOG(LogWeaponHandlingModule, Warning, TEXT("WeaponDefinitionDatabase: %s is not a projectile actor class"), *ActorClass->GetPathName());
+		ActorClass = nullptr;
+	}
+	OutProjectileData.ProjectileActorClass = ActorClass;
+	OutProjectileData.PrewarmedActorCount = Definition.PrewarmedActorCount;
+}
+
+
+UObject* FWeaponDefinitionDatabase::ResolveObject(uint32 PathOffset) const {
+	if (PathOffset == FCookedWeaponDefinition::NoString) {
+		return nullptr;
+	}
+
+	const FSoftObjectPath AssetPath(FString(GetString(PathOffset)));
+	UObject* Asset = AssetPath.TryLoad();
+	if (!Asset) {
+		UE_LOG(LogWeaponHandlingModule, Warning, TEXT("WeaponDefinitionDatabase: %s does not resolve"), *AssetPath.ToString());
+	}
+	return Asset;
+}
@@ -2,14 +2,38 @@
 
 #include "WeaponHandlingModule.h"
 #include "Logging.h"
+#include "Memory/WeaponObjectCreationTracker.h"
+#include "Weapon/BallisticTable.h"
+#include "Weapon/WeaponDefinitionDatabase.h"
 
 #include "Modules/ModuleManager.h"
+#include "UObject/UObjectGlobals.h"
 
 #define LOCTEXT_NAMESPACE "FWeaponHandlingModule"
 
-void FWeaponHandlingModule::StartupModule() {}
+void FWeaponHandlingModule::StartupModule() {
+	FWeaponObjectCreationTracker::Get().Register();
 
-void FWeaponHandlingModule::ShutdownModule() {}
+	// Editor builds read the definition assets, which may have changed since the last cook
+	if (FPlatformProperties::RequiresCookedData()) {
+		FWeaponDefinitionDatabase::Get().Load();
+	}
+
+	// Reloaded definitions and recompiled weapon classes replace the objects tables are keyed by
+	ObjectsReplacedHandle = FCoreUObjectDelegates::OnObjectsReplaced.AddLambda([](const TMap<UObject*, UObject*>& ReplacementMap) {
+		for (const TPair<UObject*, UObject*>& Replacement : ReplacementMap) {
+			FBallisticTable::Invalidate(Replacement.Key);
+		}
+	});
+}
+
+void FWeaponHandlingModule::ShutdownModule() {
+	FCoreUObjectDelegates::OnObjectsReplaced.Remove(ObjectsReplacedHandle);
+
+	FWeaponObjectCreationTracker::Get().Unregister();
+	FWeaponDefinitionDatabase::Get().Reset();
+	FBallisticTable::ResetCache();
+}
 
 #undef LOCTEXT_NAMESPACE
 
@@ -0,0 +1,61 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class AAIController;
+
+/**
+ * Statistical hit resolution for AI firefights no player can observe.
+ *
+ * Replaces traces and effects with a single roll against a hit chance derived
+ * from weapon accuracy, distance and whether the target is in cover. Cover is
+ * read from the shooter's sight perception, so no extra traces are needed.
+ *
+ * @note Callers decide when a shot is unobserved, see UWeaponSubsystem::IsObservedByPlayer()
+ * @warning Game thread only, server side
+ */
+class WEAPONHANDLINGMODULE_API FAbstractCombatResolver {
+public:
+	FAbstractCombatResolver();
+
+	/** Whether unobserved AI shots should be resolved statistically */
+	static bool IsEnabled();
+
+	/**
+	 * Checks whether a target is hidden from the shooter.
+	 *
+	 * @param Shooter AI controller firing
+	 * @param Target Actor being fired at
+	 * @return True when the shooter's sight sense does not currently see the target
+	 *
+	 * @note Shooters without sight perception treat every target as exposed
+	 */
+	static bool IsTargetInCover(const AAIController* Shooter, const AActor* Target);
+
+	/**
+	 * Computes the chance of one shot hitting.
+	 *
+	 * @param Accuracy Hit chance at point blank against an exposed target
+	 * @param Distance Distance to the target (cm)
+	 * @param WeaponRange Range at which the hit chance reaches zero (cm)
+	 * @param bTargetInCover Whether the target is in cover
+	 * @return Hit chance in [0, 1]
+	 */
+	float GetHitChance(float Accuracy, float Distance, float WeaponRange, bool bTargetInCover) const;
+
+	/**
+	 * Rolls one shot.
+	 *
+	 * @param HitChance Chance from GetHitChance()
+	 * @return True on a hit
+	 */
+	bool RollHit(float HitChance);
+
+	void Reset();
+
+private:
+	/** Cheap LCG - rolls never need to match across machines */
+	FRandomStream Random;
+};
@@ -0,0 +1,96 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GenericTeamAgentInterface.h"
+#include "Memory/WeaponFrameArena.h"
+#include "Spatial/WeaponSpatialGrid.h"
+
+class UAIPerceptionComponent;
+struct FAIStimulus;
+
+/**
+ * Coalesces gunfire into one hearing stimulus per shooter per perception interval.
+ *
+ * Shots are accumulated per shooter and flushed on a fixed interval. Each flush
+ * delivers a single stimulus carrying the shot count, and only to listeners a
+ * spatial grid finds within hearing distance of the peak loudness.
+ *
+ * @note The shot count travels as the stimulus strength, see GetShotCount()
+ * @remark Listeners only hear the teams their hearing config detects by affiliation
+ * @warning Game thread only, server side
+ */
+class WEAPONHANDLINGMODULE_API FGunfireStimulusAggregator {
+public:
+	/** Tag carried by every aggregated gunfire stimulus */
+	static const FName GunfireStimulusTag;
+
+	/**
+	 * Extracts how many shots an aggregated gunfire stimulus represents.
+	 *
+	 * @param Stimulus Stimulus received by a perception component
+	 * @return Number of coalesced shots, 0 if the stimulus is not gunfire
+	 */
+	static int32 GetShotCount(const FAIStimulus& Stimulus);
+
+	/**
+	 * Accumulates a shot for the next flush.
+	 *
+	 * @param Shooter Actor credited as the noise instigator
+	 * @param Location Where the shot was fired
+	 * @param Loudness Hearing range multiplier of this shot
+	 * @param MaxRange Hard audible range, 0 to use only listener hearing ranges
+	 */
+	void ReportShot(AActor* Shooter, const FVector& Location, float Loudness, float MaxRange);
+
+	/**
+	 * Flushes accumulated gunfire once the perception interval has elapsed.
+	 *
+	 * @param World World to deliver stimuli in
+	 */
+	void Tick(UWorld* World);
+
+	/** Drops all accumulated shots and cached listeners */
+	void Reset();
+
+private:
+	struct FPendingGunfire {
+		TWeakObjectPtr<AActor> Shooter;
+		FVector Location = FVector::ZeroVector;
+		float PeakLoudness = 0.0f;
+		float MaxRange = 0.0f;
+		int32 ShotCount = 0;
+	};
+
+	struct FGunfireListener {
+		TWeakObjectPtr<UAIPerceptionComponent> PerceptionComponent;
+		FVector Location = FVector::ZeroVector;
+		float HearingRange = 0.0f;
+		FGenericTeamId TeamIdentifier;
+
+		/** DetectionByAffiliation of the listener's hearing config */
+		uint8 AffiliationFlags = 0;
+	};
+
+	/** Refills Listeners and ListenerGrid from the perception system */
+	void RebuildListenerGrid(UWorld* World);
+
+	/** Delivers one aggregated stimulus to every listener that can hear it */
+	void DeliverGunfire(const FPendingGunfire& Gunfire, TArray<int32, FWeaponFrameAllocator>& CandidateScratch) const;
+
+	TArray<FPendingGunfire> PendingGunfire;
+
+	/** Index into PendingGunfire for each shooter */
+	TMap<TWeakObjectPtr<AActor>, int32> PendingGunfireIndices;
+
+	TArray<FGunfireListener> Listeners;
+
+	FWeaponSpatialGrid ListenerGrid;
+
+	/** Furthest hearing range among current listeners */
+	float MaxListenerHearingRange = 0.0f;
+
+	/** World time of the next flush */
+	double NextFlushTime = 0.0;
+};
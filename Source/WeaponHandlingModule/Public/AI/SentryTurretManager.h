@@ -0,0 +1,68 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Spatial/WeaponSpatialGrid.h"
+
+DECLARE_STATS_GROUP(TEXT("WeaponAI"), STATGROUP_WeaponAI, STATCAT_Advanced);
+
+class USentryTurretComponent;
+struct FHitboxCapsule;
+
+/**
+ * Wakes sleeping sentries when characters come near and budgets their line of fire checks.
+ *
+ * Sentries are kept in a spatial grid by their wake radius. Each frame every
+ * character looks up its own cell, so the cost of the wake pass follows the
+ * number of characters, not the number of sentries. Awake sentries share a
+ * fixed number of line of fire traces per frame, handed out round robin.
+ *
+ * @note Sentries are placed once - moving one requires registering it again
+ * @warning Game thread only, server side
+ */
+class WEAPONHANDLINGMODULE_API FSentryTurretManager {
+public:
+	/**
+	 * Adds a sentry to the wake grid.
+	 *
+	 * @param Sentry Sentry at its final location
+	 */
+	void Register(USentryTurretComponent* Sentry);
+
+	/** Removes a sentry from the wake grid */
+	void Unregister(USentryTurretComponent* Sentry);
+
+	/**
+	 * Wakes sentries near characters and runs this frame's line of fire checks.
+	 *
+	 * @param World World the sentries live in
+	 * @param Characters Character capsules of this frame, see FHitboxHistory::GetNewestCapsules()
+	 */
+	void Tick(UWorld* World, TConstArrayView<FHitboxCapsule> Characters);
+
+	/** Drops all sentries */
+	void Reset();
+
+	FORCEINLINE int32 Num() const { return Sentries.Num(); }
+
+	FORCEINLINE int32 NumAwake() const { return AwakeSentries.Num(); }
+
+private:
+	/** Refills SentryGrid with the wake sphere of every sentry */
+	void RebuildSentryGrid();
+
+	TArray<TWeakObjectPtr<USentryTurretComponent>> Sentries;
+
+	/** Sentries ticking, a subset of Sentries */
+	TArray<TWeakObjectPtr<USentryTurretComponent>> AwakeSentries;
+
+	/** Indices into Sentries by wake bounds */
+	FWeaponSpatialGrid SentryGrid;
+
+	/** Set when sentries were added or removed since the last rebuild */
+	bool bSentryGridDirty = false;
+
+	/** Awake sentry whose line of fire is checked next */
+	int32 NextLineOfFireIndex = 0;
+};
@@ -0,0 +1,85 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WorldCollision.h"
+
+/**
+ * Amortized line-of-sound cache between gunfire and local audio listeners.
+ *
+ * Shooters are bucketed into coarse cells so every weapon firing from the same
+ * area shares one occlusion value per listener. Values are refreshed by a fixed
+ * budget of async traces per frame, making occlusion cost independent of fire rate.
+ *
+ * @note Unknown pairs report unoccluded until their first trace completes
+ * @warning Game thread only
+ */
+class WEAPONHANDLINGMODULE_API FGunfireOcclusionCache {
+public:
+	/**
+	 * Returns the volume multiplier for gunfire heard by the primary local listener.
+	 *
+	 * @param World World the shot happened in
+	 * @param ShooterLocation Location of the firing weapon
+	 * @return 1 for a clear path, down to the occluded volume behind static geometry
+	 *
+	 * @note Never traces - schedules a refresh if the pair is not cached yet
+	 */
+	float GetVolumeMultiplier(const UWorld* World, const FVector& ShooterLocation);
+
+	/**
+	 * Collects finished traces, evicts stale pairs and issues this frame's trace budget.
+	 *
+	 * @param World World owning the cache
+	 * @param DeltaTime Frame time used to smooth volume changes
+	 */
+	void Tick(UWorld* World, float DeltaTime);
+
+	/** Drops every cached pair and in-flight trace */
+	void Reset();
+
+private:
+	/** Shooter cell and listener identifier */
+	using FOcclusionKey = TPair<FIntVector, uint32>;
+
+	struct FOcclusionEntry {
+		/** Most recent shooter location inside the cell, used as trace start */
+		FVector ShooterLocation = FVector::ZeroVector;
+
+		/** Smoothed volume multiplier handed to weapon sounds */
+		float VolumeMultiplier = 1.0f;
+
+		/** Volume multiplier measured by the latest trace */
+		float TargetVolumeMultiplier = 1.0f;
+
+		/** World time this pair was last queried */
+		double LastQueryTime = 0.0;
+
+		/** World time the latest trace was issued */
+		double LastTraceTime = 0.0;
+
+		/** Pending async trace, invalid when idle */
+		FTraceHandle TraceHandle;
+	};
+
+	/** Resolves the primary local listener, returns false on servers and without a local player */
+	static bool GetPrimaryListener(const UWorld* World, uint32& OutListenerId, FVector& OutListenerLocation);
+
+	/** Issues an async trace for a cached pair */
+	void RequestTrace(UWorld* World, const FOcclusionKey& Key, FOcclusionEntry& Entry, const FVector& ListenerLocation);
+
+	TMap<FOcclusionKey, FOcclusionEntry> Entries;
+
+	/** Pairs never traced, served before the round-robin refresh */
+	TArray<FOcclusionKey> NewKeys;
+
+	/** Pairs with a trace in flight */
+	TArray<FOcclusionKey> PendingKeys;
+
+	/** Every cached pair in refresh order */
+	TArray<FOcclusionKey> RefreshOrder;
+
+	/** Round-robin position into RefreshOrder */
+	int32 RefreshCursor = 0;
+};
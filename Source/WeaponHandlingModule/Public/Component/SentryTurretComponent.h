@@ -0,0 +1,117 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "SentryTurretComponent.generated.h"
+
+class ARangedWeapon;
+
+/**
+ * Turns a placed ranged weapon into an AI sentry that sleeps while nobody is near.
+ *
+ * A sleeping sentry does not tick and runs no queries. It is woken by
+ * FSentryTurretManager when a character enters its wake radius, then turns
+ * towards the closest target it has line of fire to and holds the trigger
+ * while on target. It falls asleep again once no character has been in
+ * range for SleepDelay.
+ *
+ * @note Add to an ARangedWeapon placed in the level - the weapon's own tick is turned off
+ * @remark The barrel is assumed to point along the weapon's forward axis
+ * @warning Only runs on the server
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent), Blueprintable)
+class WEAPONHANDLINGMODULE_API USentryTurretComponent : public UActorComponent {
+	GENERATED_BODY()
+
+public:
+	USentryTurretComponent();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	/**
+	 * Filters characters the sentry may engage.
+	 *
+	 * @param Candidate Character within the wake radius
+	 * @return True to wake for and shoot at the candidate
+	 * @note Override to leave friendly characters alone
+	 */
+	UFUNCTION(BlueprintNativeEvent, Category = "Sentry")
+	bool CanTarget(AActor* Candidate) const;
+
+	/**
+	 * Records a character found within the wake radius this frame.
+	 *
+	 * @param Candidate Character within range
+	 * @param Location Center of its capsule
+	 * @param Time World time of the wake pass
+	 * @return True if this woke the sentry up
+	 *
+	 * @note The closest candidate of the frame becomes the next line of fire check's subject
+	 */
+	bool NotifyCandidateInRange(AActor* Candidate, const FVector& Location, double Time);
+
+	/**
+	 * Traces from the barrel to this frame's closest candidate.
+	 *
+	 * @note Called by FSentryTurretManager within its per-frame trace budget
+	 * @remark The result is kept until the next check, the target is still followed in between
+	 */
+	void UpdateLineOfFire();
+
+	/** Radius within which characters wake the sentry (cm) */
+	float GetWakeRadius() const;
+
+	FORCEINLINE bool IsAwake() const { return bAwake; }
+
+	FORCEINLINE ARangedWeapon* GetWeapon() const { return Weapon; }
+
+protected:
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	/** Stops ticking until the next character comes into range */
+	void Sleep();
+
+	/** Turns the weapon towards the target and holds the trigger once on target */
+	void EngageTarget(float DeltaTime);
+
+	/** Wake radius, 0 to use the weapon's range (cm) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Sentry", meta = (AllowPrivateAccess = "true", ClampMin = "0.0"))
+	float WakeRadius = 0.0f;
+
+	/** Yaw and pitch rate of the weapon (degrees/s) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Sentry", meta = (AllowPrivateAccess = "true", ClampMin = "0.0"))
+	float TurnRate = 180.0f;
+
+	/** Largest angle between the barrel and the target at which the sentry fires (degrees) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Sentry", meta = (AllowPrivateAccess = "true", ClampMin = "0.0"))
+	float AimTolerance = 3.0f;
+
+	/** Time without a character in range before the sentry sleeps (seconds) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Sentry", meta = (AllowPrivateAccess = "true", ClampMin = "0.0"))
+	float SleepDelay = 3.0f;
+
+	/** Weapon this sentry aims and fires */
+	UPROPERTY(Transient)
+	TObjectPtr<ARangedWeapon> Weapon;
+
+	/** Character the sentry currently has line of fire to */
+	TWeakObjectPtr<AActor> Target;
+
+	/** Closest character found by the latest wake pass */
+	TWeakObjectPtr<AActor> Candidate;
+
+	FVector CandidateLocation = FVector::ZeroVector;
+
+	/** Frame Candidate was found in, stale candidates are not traced */
+	uint64 CandidateFrame = 0;
+
+	/** World time a character was last within range */
+	double LastCandidateTime = 0.0;
+
+	bool bAwake = false;
+};
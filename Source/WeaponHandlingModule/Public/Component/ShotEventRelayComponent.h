@@ -0,0 +1,76 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Net/ShotCosmeticBatch.h"
+#include "ShotEventRelayComponent.generated.h"
+
+class ARangedWeapon;
+
+/**
+ * Signals a summary of gunfire too far away to be delivered shot by shot.
+ *
+ * @param DistantGunfire One entry per area with gunfire since the last summary
+ */
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnDistantGunfireReceived, const TArray<FDistantGunfire>&, DistantGunfire);
+
+/**
+ * Per-connection channel for shot events.
+ *
+ * Lives on each remote PlayerController so the server can address shot events
+ * to individual connections instead of multicasting them to everyone.
+ *
+ * @note Added automatically by the server, see FindOrAdd()
+ * @see FShotInterestManager for how recipients are chosen
+ */
+UCLASS(ClassGroup=(Custom))
+class WEAPONHANDLINGMODULE_API UShotEventRelayComponent : public UActorComponent {
+	GENERATED_BODY()
+
+public:
+	UShotEventRelayComponent();
+
+	/**
+	 * Returns the relay of a player controller, creating it on the server if needed.
+	 *
+	 * @param PlayerController Controller owning the connection
+	 * @return Relay component, nullptr if it could not be created
+	 */
+	static UShotEventRelayComponent* FindOrAdd(APlayerController* PlayerController);
+
+	/**
+	 * Replays one frame of a weapon's shots on this client.
+	 *
+	 * @param Weapon Weapon that fired, null if not relevant to this client
+	 * @param Batch Packed shots fired this frame
+	 */
+	UFUNCTION(Client, Unreliable)
+	void ClientReceiveShotCosmetics(ARangedWeapon* Weapon, const FShotCosmeticBatch& Batch);
+
+	/**
+	 * Delivers gunfire this client was too far away to receive shot by shot.
+	 *
+	 * @param DistantGunfire One entry per area with gunfire since the last summary
+	 */
+	UFUNCTION(Client, Unreliable)
+	void ClientReceiveDistantGunfire(const TArray<FDistantGunfire>& DistantGunfire);
+
+	/**
+	 * Shows this frame's confirmed hits of the owning player.
+	 *
+	 * @param Hits One entry per target hit this frame
+	 * @see UHitFeedbackSubsystem for how they are drawn
+	 */
+	UFUNCTION(Client, Unreliable)
+	void ClientReceiveHitFeedback(const TArray<FHitFeedback>& Hits);
+
+	/**
+	 * Fires on the client for every distant gunfire summary.
+	 *
+	 * @note Bind to play distant gunfire ambience
+	 */
+	UPROPERTY(BlueprintAssignable, Category = "Weapon|Events")
+	FOnDistantGunfireReceived OnDistantGunfireReceived;
+};
@@ -56,6 +56,36 @@ public:
 	 */
 	UFUNCTION(BlueprintCallable, Category = "Weapon|Actions")
 	void WeaponAttack();
+
+	/**
+	 * Presses the trigger on the server for a remote client.
+	 *
+	 * @note Sent once per press - the server then fires every tick until StopWeaponAttack()
+	 * @remark Does nothing with authority, where WeaponAttack() already fires for real
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Weapon|Actions")
+	void StartWeaponAttack();
+
+	/**
+	 * Releases the trigger pressed by StartWeaponAttack().
+	 *
+	 * @note Re-arms single fire weapons, locally and on the server
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Weapon|Actions")
+	void StopWeaponAttack();
+
+	/**
+	 * Equips a known weapon, dropping the current one.
+	 *
+	 * @param Weapon Weapon to take, skips the overlap search of EquipWeapon()
+	 * @note For scripted and AI owners - runs locally and is not forwarded to the server
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Weapon|Actions")
+	void EquipWeaponInstance(ABaseWeapon* Weapon);
+
+	/** Drops the current weapon where it is */
+	UFUNCTION(BlueprintCallable, Category = "Weapon|Actions")
+	virtual void UnequipWeapon();
 	
 	/**
 	 * Notification system for initialization completion.
@@ -129,7 +159,31 @@ protected:
 	 */
 	virtual void EquipWeapon();
 
-	virtual void UnequipWeapon();
+	/**
+	 * Holds a remote client's trigger with authority, firing once right away.
+	 *
+	 * @note The server fast-forwards resulting projectiles by the client's latency
+	 * @see AProjectileWeapon::ShootWeapon()
+	 */
+	UFUNCTION(Server, Reliable)
+	void ServerStartWeaponAttack();
+
+	/** Releases a remote client's trigger */
+	UFUNCTION(Server, Reliable)
+	void ServerStopWeaponAttack();
+
+	/**
+	 * Equips the weapon a remote client picked, with authority.
+	 *
+	 * @param Weapon Weapon found by the client's search, null to drop the current one
+	 * @note Range checked against WeaponDetectionRange, with some slack for latency
+	 */
+	UFUNCTION(Server, Reliable)
+	void ServerEquipWeaponInstance(ABaseWeapon* Weapon);
+
+	/** Replays a remote client's unequip request with authority */
+	UFUNCTION(Server, Reliable)
+	void ServerUnequipWeapon();
 
 public:
 	/**
@@ -207,7 +261,13 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon|Input", meta=(AllowPrivateAccess = "true"))
 	TObjectPtr<UInputAction> UnequipWeaponAction;
 
+	// Server side: a remote client holds the trigger, fired from TickComponent()
+	bool bRemoteTriggerHeld = false;
+
 	
+public:
+	FORCEINLINE ABaseWeapon* GetActiveWeapon() const { return ActiveWeapon; }
+
 	// Implementation Notes:
 	// - All weapon actions flow through WeaponAttack() for consistent behavior
 	// - Input binding happens during InitializeWeaponHandlingComponent()
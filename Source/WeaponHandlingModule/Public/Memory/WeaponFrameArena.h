@@ -0,0 +1,155 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+DECLARE_STATS_GROUP(TEXT("WeaponMemory"), STATGROUP_WeaponMemory, STATCAT_Advanced);
+
+/**
+ * Linear allocator for transient weapon data that never outlives the frame.
+ *
+ * Allocations bump a pointer through one fixed block. Scopes release what they
+ * allocated with FWeaponFrameArenaMark, and UWeaponSubsystem rewinds whatever is
+ * left at the end of every frame. Requests that do not fit fall back to the heap
+ * and are counted as overflow.
+ *
+ * @note Back containers with FWeaponFrameAllocator rather than calling Allocate() directly
+ * @warning Game thread only - nothing allocated here may be kept past the frame
+ */
+class WEAPONHANDLINGMODULE_API FWeaponFrameArena {
+public:
+	/** Returns the game thread arena */
+	static FWeaponFrameArena& Get();
+
+	~FWeaponFrameArena();
+
+	/**
+	 * Allocates uninitialized memory for the rest of the frame or the enclosing mark.
+	 *
+	 * @param Size Bytes to allocate
+	 * @param Alignment Required alignment, a power of two
+	 */
+	void* Allocate(SIZE_T Size, uint32 Alignment);
+
+	/**
+	 * Releases every allocation and publishes this frame's stats.
+	 *
+	 * @note O(1) unless the frame overflowed to the heap
+	 * @warning No mark may be alive
+	 */
+	void Reset();
+
+	/** Largest number of bytes in use at once since startup */
+	FORCEINLINE SIZE_T GetHighWaterMark() const { return HighWaterMark; }
+
+private:
+	friend class FWeaponFrameArenaMark;
+
+	/** (Re)allocates the block to the configured capacity */
+	void ResizeBlock();
+
+	/** Frees heap fallbacks allocated after the given count */
+	void FreeOverflow(int32 FirstOverflowIndex);
+
+	uint8* BlockBegin = nullptr;
+	uint8* BlockTop = nullptr;
+	uint8* BlockEnd = nullptr;
+
+	/** Heap fallbacks, freed when popped or reset */
+	TArray<void*> OverflowAllocations;
+
+	/** Marks currently alive */
+	int32 NumMarks = 0;
+
+	/** Peak bytes in use this frame */
+	SIZE_T FramePeakBytes = 0;
+
+	/** Bytes served from the heap this frame */
+	SIZE_T FrameOverflowBytes = 0;
+
+	SIZE_T HighWaterMark = 0;
+};
+
+/**
+ * Releases every frame arena allocation made during its lifetime.
+ *
+ * @note Declare before the containers it should release so they are destroyed first
+ */
+class WEAPONHANDLINGMODULE_API FWeaponFrameArenaMark {
+public:
+	FWeaponFrameArenaMark();
+	~FWeaponFrameArenaMark();
+
+	UE_NONCOPYABLE(FWeaponFrameArenaMark);
+
+private:
+	uint8* SavedTop;
+	int32 SavedNumOverflow;
+};
+
+/**
+ * Container allocator drawing from FWeaponFrameArena.
+ *
+ * Growth copies into a fresh allocation and abandons the old one until the
+ * enclosing mark or the end of the frame, so reserve when the size is known.
+ */
+class FWeaponFrameAllocator {
+public:
+	using SizeType = int32;
+
+	enum { NeedsElementType = true };
+	enum { RequireRangeCheck = true };
+
+	template<typename ElementType>
+	class ForElementType {
+	public:
+		ForElementType() = default;
+
+		FORCEINLINE void MoveToEmpty(ForElementType& Other) {
+			checkSlow(this != &Other);
+			Data = Other.Data;
+			Other.Data = nullptr;
+		}
+
+		FORCEINLINE ElementType* GetAllocation() const { return Data; }
+
+		void ResizeAllocation(SizeType PreviousNumElements, SizeType NumElements, SIZE_T NumBytesPerElement) {
+			ElementType* OldData = Data;
+			Data = NumElements > 0 ? static_cast<ElementType*>(FWeaponFrameArena::Get().Allocate(NumElements * NumBytesPerElement, DEFAULT_ALIGNMENT)) : nullptr;
+
+			if (Data && OldData && PreviousNumElements > 0) {
+				FMemory::Memcpy(Data, OldData, FMath::Min(NumElements, PreviousNumElements) * NumBytesPerElement);
+			}
+		}
+
+		FORCEINLINE SizeType CalculateSlackReserve(SizeType NumElements, SIZE_T NumBytesPerElement) const {
+			return DefaultCalculateSlackReserve(NumElements, NumBytesPerElement, false);
+		}
+
+		FORCEINLINE SizeType CalculateSlackShrink(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const {
+			return DefaultCalculateSlackShrink(NumElements, NumAllocatedElements, NumBytesPerElement, false);
+		}
+
+		FORCEINLINE SizeType CalculateSlackGrow(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const {
+			return DefaultCalculateSlackGrow(NumElements, NumAllocatedElements, NumBytesPerElement, false);
+		}
+
+		FORCEINLINE SIZE_T GetAllocatedSize(SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const { return NumAllocatedElements * NumBytesPerElement; }
+
+		FORCEINLINE bool HasAllocation() const { return Data != nullptr; }
+
+		FORCEINLINE SizeType GetInitialCapacity() const { return 0; }
+
+	private:
+		ElementType* Data = nullptr;
+	};
+
+	typedef ForElementType<FScriptContainerElement> ForAnyElementType;
+};
+
+template<>
+struct TAllocatorTraits<FWeaponFrameAllocator> : TAllocatorTraitsBase<FWeaponFrameAllocator> {
+	enum { SupportsMove = true };
+	enum { IsZeroConstruct = true };
+};
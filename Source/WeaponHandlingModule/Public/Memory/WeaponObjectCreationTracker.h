@@ -0,0 +1,59 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/UObjectArray.h"
+
+/**
+ * Counts UObjects created by weapon code, to keep steady fire free of object churn.
+ *
+ * Listens to every UObject creation and counts those made on the game thread
+ * while an FWeaponObjectCreationScope is open. Fire, cosmetic replay, damage and
+ * the per-frame subsystem work open one, so the count covers components, effects
+ * and actors spawned on behalf of weapons.
+ *
+ * @note Published as "UObjects created/s" in the WeaponMemory stats and as ObjectsCreated in the Weapon CSV category
+ * @remark Should read 0 once pools are warm - anything else is per-shot garbage
+ */
+class WEAPONHANDLINGMODULE_API FWeaponObjectCreationTracker : public FUObjectArray::FUObjectCreateListener {
+public:
+	static FWeaponObjectCreationTracker& Get();
+
+	/** Starts listening, called at module startup */
+	void Register();
+
+	void Unregister();
+
+	/** Publishes the per-second count */
+	void Tick();
+
+	virtual void NotifyUObjectCreated(const UObjectBase* Object, int32 Index) override;
+
+	virtual void OnUObjectArrayShutdown() override;
+
+private:
+	friend class FWeaponObjectCreationScope;
+
+	/** Open scopes on the game thread */
+	int32 ScopeDepth = 0;
+
+	/** Weapon objects created in the current one second window */
+	int32 NumCreated = 0;
+
+	double WindowStartTime = 0.0;
+
+	bool bRegistered = false;
+};
+
+/**
+ * Attributes UObjects created while alive to the weapon module.
+ *
+ * @warning Game thread only
+ */
+class FWeaponObjectCreationScope {
+public:
+	FWeaponObjectCreationScope() { ++FWeaponObjectCreationTracker::Get().ScopeDepth; }
+
+	~FWeaponObjectCreationScope() { --FWeaponObjectCreationTracker::Get().ScopeDepth; }
+};
@@ -0,0 +1,55 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Net/ShotCosmeticBatch.h"
+
+class APlayerController;
+
+/**
+ * Collects confirmed player hits from the damage path and sends them once per frame.
+ *
+ * Hits by the same player on the same target within a frame are merged into a
+ * single entry, so spread fire produces one damage number per target instead
+ * of one per pellet.
+ *
+ * @note Only player instigators are tracked
+ * @warning Game thread only, server side
+ */
+class WEAPONHANDLINGMODULE_API FHitFeedbackAggregator {
+public:
+	/**
+	 * Records a hit that dealt damage.
+	 *
+	 * @param Instigator Controller credited with the hit
+	 * @param Target Actor that was damaged
+	 * @param Location Impact point
+	 * @param Damage Damage dealt
+	 */
+	void ReportHit(AController* Instigator, AActor* Target, const FVector& Location, float Damage);
+
+	/**
+	 * Hands this frame's hits to each player's hit feedback.
+	 *
+	 * @note Local players are fed directly, remote ones get one RPC each
+	 */
+	void Flush();
+
+	void Reset();
+
+private:
+	struct FPendingHitFeedback {
+		TWeakObjectPtr<APlayerController> Instigator;
+		TArray<FHitFeedback> Hits;
+
+		/** Sum of impact points per hit, averaged on flush */
+		TArray<FVector> LocationSums;
+	};
+
+	/** One entry per player with hits this frame, reused across frames */
+	TArray<FPendingHitFeedback> PendingHitFeedback;
+
+	/** Entries in PendingHitFeedback in use this frame */
+	int32 NumPending = 0;
+};
@@ -0,0 +1,117 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "ShotCosmeticBatch.generated.h"
+
+DECLARE_STATS_GROUP(TEXT("WeaponNet"), STATGROUP_WeaponNet, STATCAT_Advanced);
+
+/**
+ * Cosmetic result of one shot as seen by remote clients.
+ */
+struct FShotCosmetic {
+	/** Shot end point relative to the batch origin */
+	FVector EndOffset = FVector::ZeroVector;
+
+	/** Variation seed so every client picks the same cosmetic variant */
+	uint8 Seed = 0;
+
+	/** Whether the shot ended on a blocking hit */
+	bool bHit = false;
+};
+
+/**
+ * Every cosmetic shot result of one weapon in one frame, sent as a single RPC.
+ *
+ * Shots are written as a count followed by seeds, hit bits and end points
+ * packed relative to one full-precision origin, so a burst or a spread shot
+ * costs one small bunch instead of one RPC per pellet.
+ *
+ * @note Cosmetic only - never used for hit detection
+ * @see ARangedWeapon::MulticastShotCosmetics()
+ */
+USTRUCT()
+struct WEAPONHANDLINGMODULE_API FShotCosmeticBatch {
+	GENERATED_BODY()
+
+	/** Shots a single batch can carry, larger frames are split */
+	static constexpr int32 MaxShots = 255;
+
+	/** Muzzle location of the first shot in the batch */
+	FVector Origin = FVector::ZeroVector;
+
+	/** Server sequence number of the first shot, wrapped to the weapon's muzzle cycle */
+	uint16 FirstShotSequence = 0;
+
+	TArray<FShotCosmetic> Shots;
+
+	/**
+	 * Appends a shot, taking the origin from the first one.
+	 *
+	 * @return False when the batch is full
+	 */
+	bool Add(const FVector& ShotOrigin, const FVector& ShotEnd, bool bHit, uint8 Seed);
+
+	FORCEINLINE bool IsFull() const { return Shots.Num() >= MaxShots; }
+
+	FORCEINLINE bool IsEmpty() const { return Shots.Num() == 0; }
+
+	FORCEINLINE void Reset() { Shots.Reset(); }
+
+	/**
+	 * Writes or reads the packed batch.
+	 *
+	 * @note End points are quantized to 1 cm relative to Origin
+	 * @remark The sequence is packed, so single muzzle weapons pay a single byte for it
+	 */
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+/**
+ * Gunfire heard from an area outside a viewer's shot event range.
+ */
+USTRUCT(BlueprintType)
+struct FDistantGunfire {
+	GENERATED_BODY()
+
+	/** Location of the latest shot in the area */
+	UPROPERTY(BlueprintReadOnly, Category = "Weapon|Network")
+	FVector_NetQuantize Location = FVector::ZeroVector;
+
+	/** Shots fired in the area during the summary interval, saturating */
+	UPROPERTY(BlueprintReadOnly, Category = "Weapon|Network")
+	uint8 NumShots = 0;
+};
+
+/**
+ * Damage one player dealt to one target during a frame, merged over every hit.
+ */
+USTRUCT(BlueprintType)
+struct FHitFeedback {
+	GENERATED_BODY()
+
+	/** Actor that was hit */
+	UPROPERTY(BlueprintReadOnly, Category = "Weapon|Network")
+	TObjectPtr<AActor> Target = nullptr;
+
+	/** Average impact point of the merged hits, of the first 255 once NumHits saturates */
+	UPROPERTY(BlueprintReadOnly, Category = "Weapon|Network")
+	FVector_NetQuantize Location = FVector::ZeroVector;
+
+	/** Total damage of the merged hits */
+	UPROPERTY(BlueprintReadOnly, Category = "Weapon|Network")
+	float Damage = 0.0f;
+
+	/** Hits merged into this entry, saturating */
+	UPROPERTY(BlueprintReadOnly, Category = "Weapon|Network")
+	uint8 NumHits = 0;
+};
+
+template<>
+struct TStructOpsTypeTraits<FShotCosmeticBatch> : public TStructOpsTypeTraitsBase2<FShotCosmeticBatch> {
+	enum {
+		WithNetSerializer = true
+	};
+};
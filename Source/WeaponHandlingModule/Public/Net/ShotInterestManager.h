@@ -0,0 +1,92 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Spatial/WeaponSpatialGrid.h"
+
+class APlayerController;
+class ARangedWeapon;
+class UShotEventRelayComponent;
+struct FShotCosmeticBatch;
+
+/**
+ * Chooses which connections receive each weapon's shot events.
+ *
+ * Remote viewpoints are bucketed into a spatial grid once per frame. A batch is
+ * sent only to viewers within the weapon's audible range of the muzzle or its
+ * visible range of a tracer. Everyone else gets a periodic distant gunfire
+ * summary per area instead.
+ *
+ * @note Local controllers are tracked for IsObserved() but never sent events
+ * @warning Game thread only, server side
+ */
+class WEAPONHANDLINGMODULE_API FShotInterestManager {
+public:
+	/**
+	 * Sends a weapon's batch to every interested connection.
+	 *
+	 * @param World World the weapon fired in
+	 * @param Weapon Weapon that fired
+	 * @param Batch Shots fired this frame
+	 * @param AudibleRange Range around the muzzle that receives the shots (cm)
+	 * @param VisibleRange Range around each tracer that receives the shots (cm)
+	 * @return Number of connections the batch was sent to
+	 *
+	 * @note The shooter's own connection is skipped, it predicted the shots
+	 */
+	int32 Deliver(UWorld* World, ARangedWeapon* Weapon, const FShotCosmeticBatch& Batch, float AudibleRange, float VisibleRange);
+
+	/**
+	 * Checks whether any player, local or remote, would notice a shot.
+	 *
+	 * @param World World the shot happens in
+	 * @param ShotOrigin Muzzle location
+	 * @param ShotEnd Where the shot is aimed
+	 * @param AudibleRange Range around the muzzle in which the shot is noticed (cm)
+	 * @param VisibleRange Range around the tracer in which the shot is noticed (cm)
+	 */
+	bool IsObserved(UWorld* World, const FVector& ShotOrigin, const FVector& ShotEnd, float AudibleRange, float VisibleRange);
+
+	/**
+	 * Sends the distant gunfire summary once its interval has elapsed.
+	 *
+	 * @param World World to summarize
+	 */
+	void Tick(UWorld* World);
+
+	/** Drops cached viewers and pending gunfire */
+	void Reset();
+
+private:
+	struct FShotViewer {
+		TWeakObjectPtr<APlayerController> PlayerController;
+
+		/** Null for local players, who play shots directly */
+		TWeakObjectPtr<UShotEventRelayComponent> Relay;
+		FVector Location = FVector::ZeroVector;
+	};
+
+	struct FDistantGunfireArea {
+		FVector Location = FVector::ZeroVector;
+		int32 NumShots = 0;
+	};
+
+	/** Refills Viewers and ViewerGrid, at most once per frame */
+	void RebuildViewerGrid(UWorld* World);
+
+	TArray<FShotViewer> Viewers;
+
+	FWeaponSpatialGrid ViewerGrid;
+
+	/** Frame the viewer grid was last built in */
+	uint64 ViewerGridFrame = MAX_uint64;
+
+	/** Gunfire since the last summary, per coarse area */
+	TMap<FIntVector, FDistantGunfireArea> DistantGunfire;
+
+	/** World time of the next summary */
+	double NextSummaryTime = 0.0;
+
+	TArray<int32> CandidateScratch;
+};
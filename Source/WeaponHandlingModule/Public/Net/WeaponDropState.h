@@ -0,0 +1,67 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/NetSerialization.h"
+#include "WeaponDropState.generated.h"
+
+/**
+ * Replicated state of a dropped weapon: how it left its owner, then where it came to rest.
+ *
+ * Changes twice per drop. Clients simulate the fall themselves from the start
+ * state and blend to the rest pose once the server's simulation settles, so no
+ * transform is sent while the weapon is falling.
+ *
+ * @note Cosmetic on clients - only the server's rest pose is authoritative
+ * @see ABaseWeapon::Fall()
+ */
+USTRUCT()
+struct WEAPONHANDLINGMODULE_API FWeaponDropState {
+	GENERATED_BODY()
+
+	/** Advanced by every drop, so clients tell a new drop from the rest update of the last one */
+	uint8 DropId = 0;
+
+	/** Whether the rest pose is set, the start state is not sent anymore once it is */
+	bool bAtRest = false;
+
+	/** Mesh transform and velocity when the weapon left its owner */
+	FVector StartLocation = FVector::ZeroVector;
+	FRotator StartRotation = FRotator::ZeroRotator;
+	FVector StartVelocity = FVector::ZeroVector;
+
+	/** Mesh transform where the server's simulation settled */
+	FVector RestLocation = FVector::ZeroVector;
+	FRotator RestRotation = FRotator::ZeroRotator;
+
+	/**
+	 * Rounds the rest pose to what NetSerialize() sends.
+	 *
+	 * @note The server applies the rounded pose too, so every machine rests the weapon identically
+	 */
+	void QuantizeRestPose();
+
+	/**
+	 * Writes or reads the state of the current phase only.
+	 *
+	 * @note Locations are quantized to 0.1 cm, rotations to 16 bits per axis
+	 */
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+
+	/**
+	 * Compares what NetSerialize() would send.
+	 *
+	 * @note Without it the struct has no replicated properties to diff, so a change is never sent
+	 * @remark Only the fields of the current phase are compared, the other phase is not sent
+	 */
+	bool operator==(const FWeaponDropState& Other) const;
+};
+
+template<>
+struct TStructOpsTypeTraits<FWeaponDropState> : public TStructOpsTypeTraitsBase2<FWeaponDropState> {
+	enum {
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true
+	};
+};
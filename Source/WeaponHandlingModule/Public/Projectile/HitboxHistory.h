@@ -0,0 +1,96 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Memory/WeaponFrameArena.h"
+
+class UPrimitiveComponent;
+
+/**
+ * Character hit capsule captured at one point in time.
+ */
+struct FHitboxCapsule {
+	TWeakObjectPtr<AActor> Actor;
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+	FVector Center = FVector::ZeroVector;
+	FVector UpAxis = FVector::UpVector;
+	float Radius = 0.0f;
+	float HalfHeight = 0.0f;
+
+	FORCEINLINE bool IsValid() const { return Radius > 0.0f; }
+};
+
+/**
+ * Short ring buffer of character capsules used for server-side lag compensation.
+ *
+ * Every tracked character keeps a stable slot so two recorded frames can be
+ * interpolated capsule by capsule when rewinding to a time between them.
+ *
+ * @note Only recorded on the server
+ * @warning Game thread only
+ */
+class WEAPONHANDLINGMODULE_API FHitboxHistory {
+public:
+	FHitboxHistory();
+
+	/**
+	 * Captures the current capsule of every character in the world.
+	 *
+	 * @param World World to capture
+	 */
+	void Record(UWorld* World);
+
+	/**
+	 * Reconstructs character capsules as they were at a past time.
+	 *
+	 * @param Time World time to rewind to, clamped to the recorded window
+	 * @param OutCapsules Receives one capsule per tracked character
+	 *
+	 * @note Output lives in the frame arena - it is rebuilt every catch-up slice and never kept
+	 */
+	void GetCapsulesAtTime(double Time, TArray<FHitboxCapsule, FWeaponFrameAllocator>& OutCapsules) const;
+
+	/**
+	 * Capsules captured by the last Record().
+	 *
+	 * @return One entry per slot, check IsValid() - empty before the first record
+	 * @note Lets other server systems read character positions without iterating the world again
+	 */
+	TConstArrayView<FHitboxCapsule> GetNewestCapsules() const;
+
+	/** Age of the oldest recorded frame (seconds) */
+	double GetHistoryDuration() const;
+
+	/** Drops all recorded frames and slots */
+	void Reset();
+
+private:
+	struct FHitboxFrame {
+		double Time = 0.0;
+
+		/** Capsules indexed by slot, invalid where a slot was empty */
+		TArray<FHitboxCapsule> Capsules;
+	};
+
+	/** Returns the frame recorded Age frames ago, 0 being the newest */
+	const FHitboxFrame& GetFrame(int32 Age) const;
+
+	/** Fixed ring of frames, reused in place */
+	TArray<FHitboxFrame> Frames;
+
+	/** Ring position of the newest frame */
+	int32 NewestFrameIndex = INDEX_NONE;
+
+	/** Number of valid frames in the ring */
+	int32 NumFrames = 0;
+
+	/** Stable slot per tracked actor */
+	TMap<TWeakObjectPtr<AActor>, int32> ActorSlots;
+
+	/** Slots released by destroyed actors */
+	TArray<int32> FreeSlots;
+
+	/** Number of slots ever handed out */
+	int32 NumSlots = 0;
+};
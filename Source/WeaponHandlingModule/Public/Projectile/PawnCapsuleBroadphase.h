@@ -0,0 +1,78 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Projectile/HitboxHistory.h"
+#include "Spatial/WeaponSpatialGrid.h"
+
+/**
+ * Grid of character capsules for analytic projectile-vs-character tests.
+ *
+ * Rebuilt from scratch whenever the capsules move, which lets projectile scene
+ * queries skip pawns entirely. Segment tests run four capsules at a time on
+ * structure-of-arrays data, and only the capsules that pass are resolved exactly.
+ *
+ * @note Capsules are stored in single precision
+ * @warning Build on the game thread - sweeps may run on any thread in between
+ */
+class WEAPONHANDLINGMODULE_API FPawnCapsuleBroadphase {
+public:
+	/**
+	 * Rebuilds from the current capsule of every character in a world.
+	 *
+	 * @param World World to gather characters from
+	 */
+	void Rebuild(UWorld* World);
+
+	/**
+	 * Rebuilds from an explicit set of capsules, such as a rewound frame.
+	 *
+	 * @param InCapsules Capsules to test against, copied
+	 */
+	void Build(TConstArrayView<FHitboxCapsule> InCapsules);
+
+	/**
+	 * Finds the first capsule hit by a segment.
+	 *
+	 * @param Start Segment start
+	 * @param End Segment end
+	 * @param IgnoredActor Actor whose capsule is never hit
+	 * @param OutHit Receives the closest blocking hit
+	 * @return True if any capsule was hit
+	 */
+	bool SweepSegment(const FVector& Start, const FVector& End, const AActor* IgnoredActor, FHitResult& OutHit) const;
+
+	/**
+	 * Collects capsules in every grid cell touched by a sphere.
+	 *
+	 * @param OutCapsules Receives indices into GetCapsules(), appended, possibly repeated
+	 */
+	template<typename AllocatorType>
+	void QuerySphere(const FVector& Center, float Radius, TArray<int32, AllocatorType>& OutCapsules) const {
+		Grid.QuerySphere(Center, Radius, OutCapsules);
+	}
+
+	FORCEINLINE TConstArrayView<FHitboxCapsule> GetCapsules() const { return Capsules; }
+
+	FORCEINLINE int32 Num() const { return Capsules.Num(); }
+
+	void Reset();
+
+private:
+	/** Converts Capsules into the SIMD layout and grid */
+	void BuildAcceleration();
+
+	TArray<FHitboxCapsule> Capsules;
+
+	// Per capsule, structure-of-arrays for four-wide tests
+	TArray<float> BottomX;
+	TArray<float> BottomY;
+	TArray<float> BottomZ;
+	TArray<float> AxisX;
+	TArray<float> AxisY;
+	TArray<float> AxisZ;
+	TArray<float> RadiusSquared;
+
+	FWeaponSpatialGrid Grid;
+};
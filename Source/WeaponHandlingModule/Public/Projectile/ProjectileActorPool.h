@@ -0,0 +1,77 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+class AWeaponProjectileActor;
+
+/**
+ * Per-class pool of dormant projectile actors.
+ *
+ * Acquiring reuses a dormant actor and only spawns when the class has none
+ * left, releasing puts the actor back to sleep. Steady fire therefore neither
+ * constructs actors nor leaves garbage for the collector.
+ *
+ * @note Dormant actors stay in the level and are referenced by it, the pool only tracks them
+ * @remark weapon.Projectile.PoolActors 0 spawns and destroys instead, to compare GC cost
+ * @warning Game thread only
+ */
+class WEAPONHANDLINGMODULE_API FProjectileActorPool {
+public:
+	/**
+	 * Returns a dormant actor of the class, spawning one if none is left.
+	 *
+	 * @param World World to spawn in
+	 * @param ActorClass Projectile class to take from
+	 * @return Dormant actor ready for AWeaponProjectileActor::Launch(), null if spawning failed
+	 */
+	AWeaponProjectileActor* Acquire(UWorld* World, TSubclassOf<AWeaponProjectileActor> ActorClass);
+
+	/**
+	 * Puts an actor back to sleep for reuse.
+	 *
+	 * @note Destroys it instead when the class already has weapon.Projectile.ActorPoolMax dormant actors
+	 */
+	void Release(AWeaponProjectileActor* Actor);
+
+	/**
+	 * Spawns dormant actors until the class has at least Count of them.
+	 *
+	 * @note Call at equip or load, so the first shots do not pay for construction
+	 */
+	void Prewarm(UWorld* World, TSubclassOf<AWeaponProjectileActor> ActorClass, int32 Count);
+
+	/** Publishes the per-second spawn, reuse and destroy counts */
+	void Tick(const UWorld* World);
+
+	/** Marks the start of a garbage collection, see OnPostGarbageCollect() */
+	void OnPreGarbageCollect();
+
+	/** Publishes how long the collection took, to compare pooled and unpooled runs */
+	void OnPostGarbageCollect();
+
+	void Reset();
+
+	/** Dormant actors across every class */
+	int32 NumDormant() const;
+
+private:
+	/** Spawns one dormant actor */
+	AWeaponProjectileActor* SpawnDormant(UWorld* World, UClass* ActorClass);
+
+	/** Dormant actors of each class */
+	TMap<TObjectKey<UClass>, TArray<TWeakObjectPtr<AWeaponProjectileActor>>> DormantActors;
+
+	/** Counts accumulated over the current one second window */
+	struct FPoolTraffic {
+		int32 NumSpawned = 0;
+		int32 NumReused = 0;
+		int32 NumDestroyed = 0;
+		double WindowStartTime = 0.0;
+	};
+	FPoolTraffic Traffic;
+
+	double GarbageCollectStartTime = 0.0;
+};
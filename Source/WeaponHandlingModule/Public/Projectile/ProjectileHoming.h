@@ -0,0 +1,75 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/ObjectKey.h"
+
+class FPawnCapsuleBroadphase;
+struct FProjectileDefinition;
+
+/**
+ * Target selection and steering for guided projectiles.
+ *
+ * Targets come from the character capsules the pawn broadphase already gathers
+ * each frame, so homing adds no actor iteration of its own. Rounds look for a
+ * new target in turn, a fraction of them per frame, and otherwise only follow
+ * their current target. Steering runs as one batch over every homing round,
+ * four rounds at a time.
+ *
+ * @note Targets are referenced by object key, so the integration task never dereferences actors
+ * @see FProjectileSimulation for the in-flight arrays these functions read and write
+ */
+class WEAPONHANDLINGMODULE_API FProjectileHoming {
+public:
+	/** Views of the simulation's in-flight state, indexed like each other */
+	struct FInFlightView {
+		TConstArrayView<FProjectileDefinition> Definitions;
+		TConstArrayView<int32> DefinitionIndices;
+		TConstArrayView<FVector> Positions;
+		TArrayView<FVector> Velocities;
+		TConstArrayView<TWeakObjectPtr<AActor>> IgnoredActors;
+
+		/** Actor each round is homing on, default for none */
+		TArrayView<FObjectKey> Targets;
+
+		/** Where each round's target is this frame */
+		TArrayView<FVector> AimPoints;
+	};
+
+	/**
+	 * Reacquires targets for this frame's share of homing rounds and refreshes every aim point.
+	 *
+	 * @param Broadphase Current character capsules, the shared target list
+	 * @param InFlight In-flight state to update
+	 *
+	 * @note weapon.Projectile.HomingReacquireFrames sets how many frames a full round of reacquisition takes
+	 * @warning Game thread, between integration tasks
+	 */
+	void UpdateTargets(const FPawnCapsuleBroadphase& Broadphase, const FInFlightView& InFlight);
+
+	/**
+	 * Turns every homing round towards its aim point.
+	 *
+	 * @param InFlight In-flight state, only velocities are written
+	 * @param StepTime Length of the step (seconds)
+	 *
+	 * @note Speed is kept, turn rate is bounded by the definition's homing acceleration
+	 */
+	void Steer(const FInFlightView& InFlight, float StepTime);
+
+	void Reset();
+
+private:
+	/** Picks the closest capsule inside a round's seeker cone, default if none */
+	FObjectKey AcquireTarget(const FPawnCapsuleBroadphase& Broadphase, const FProjectileDefinition& Definition, const FVector& Position, const FVector& Velocity, const AActor* IgnoredActor) const;
+
+	/** Capsule of each target actor this frame */
+	TMap<FObjectKey, int32> TargetCapsules;
+
+	/** Rounds steered in the current step, reused */
+	TArray<int32> SteeredIndices;
+
+	/** Advances every frame to rotate which rounds reacquire */
+	uint32 FrameCounter = 0;
+};
@@ -0,0 +1,58 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class FProjectileSimulation;
+class UInstancedStaticMeshComponent;
+
+/**
+ * Draws every in-flight projectile as an instance of its definition's mesh.
+ *
+ * One instanced static mesh component per projectile definition is fed straight
+ * from the simulation's position and velocity arrays each frame, so the render
+ * cost is one proxy per definition regardless of how many rounds are in flight.
+ *
+ * @note Components live on a transient host actor spawned on first use
+ * @warning Game thread only
+ */
+class WEAPONHANDLINGMODULE_API FProjectileInstanceRenderer {
+public:
+	/**
+	 * Rewrites the instance transforms of every definition.
+	 *
+	 * @param World World to draw in
+	 * @param ProjectileSimulation Source of in-flight state
+	 * @param ExtrapolationTime How far real time is ahead of the simulated state (seconds)
+	 *
+	 * @note Skipped on dedicated servers
+	 */
+	void Update(UWorld* World, const FProjectileSimulation& ProjectileSimulation, float ExtrapolationTime);
+
+	/** Destroys the host actor and every component */
+	void Reset();
+
+private:
+	/** Instances of one projectile definition */
+	struct FProjectileInstanceBatch {
+		TWeakObjectPtr<UInstancedStaticMeshComponent> Component;
+
+		/** Reused every frame so steady-state updates do not allocate */
+		TArray<FTransform> Transforms;
+	};
+
+	/** Returns the component for a definition, creating it on first use */
+	UInstancedStaticMeshComponent* FindOrAddComponent(UWorld* World, const FProjectileSimulation& ProjectileSimulation, int32 DefinitionIndex);
+
+	/** Resizes a component's instance count to match its transforms */
+	void SyncInstanceCount(UInstancedStaticMeshComponent* Component, int32 NumInstances);
+
+	TWeakObjectPtr<AActor> HostActor;
+
+	/** Indexed by projectile definition */
+	TArray<FProjectileInstanceBatch> Batches;
+
+	/** Scratch for removing surplus instances */
+	TArray<int32> RemovedInstances;
+};
@@ -0,0 +1,246 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/HitResult.h"
+#include "Tasks/Task.h"
+#include "Projectile/PawnCapsuleBroadphase.h"
+#include "Projectile/ProjectileHoming.h"
+#include "Projectile/ProjectileWindField.h"
+#include "Projectile/StaticOccupancyGrid.h"
+
+class FHitboxHistory;
+class UParticleSystem;
+class UStaticMesh;
+
+/**
+ * Resolved ballistic and damage values shared by all projectiles of one weapon definition.
+ */
+struct FProjectileDefinition {
+	float MuzzleSpeed = 0.0f;
+	float GravityZ = 0.0f;
+	float DragCoefficient = 0.0f;
+	float MaxFlightTime = 0.0f;
+	float Damage = 0.0f;
+	TWeakObjectPtr<UParticleSystem> ImpactParticle;
+
+	/** Instanced in-flight visual, none for invisible projectiles */
+	TWeakObjectPtr<UStaticMesh> Mesh;
+	FVector MeshScale = FVector::OneVector;
+
+	/** Turn rate towards the target (cm/s^2), 0 for unguided rounds */
+	float HomingAcceleration = 0.0f;
+
+	/** Distance within which targets are acquired (cm) */
+	float HomingRange = 0.0f;
+
+	/** Cosine of the seeker cone half angle around the velocity */
+	float HomingConeCos = 1.0f;
+
+	FORCEINLINE bool IsHoming() const { return HomingAcceleration > 0.0f; }
+
+	bool operator==(const FProjectileDefinition& Other) const {
+		return MuzzleSpeed == Other.MuzzleSpeed && GravityZ == Other.GravityZ && DragCoefficient == Other.DragCoefficient
+			&& MaxFlightTime == Other.MaxFlightTime && Damage == Other.Damage && ImpactParticle == Other.ImpactParticle
+			&& Mesh == Other.Mesh && MeshScale == Other.MeshScale
+			&& HomingAcceleration == Other.HomingAcceleration && HomingRange == Other.HomingRange && HomingConeCos == Other.HomingConeCos;
+	}
+};
+
+/**
+ * Everything needed to put a new projectile into flight.
+ */
+struct FProjectileLaunchParams {
+	/** Index returned by FProjectileSimulation::RegisterDefinition() */
+	int32 DefinitionIndex = INDEX_NONE;
+
+	FVector Origin = FVector::ZeroVector;
+	FVector Direction = FVector::ForwardVector;
+
+	/** Weapon credited with the damage */
+	TWeakObjectPtr<AActor> DamageCauser;
+
+	/** Controller credited with the damage */
+	TWeakObjectPtr<AController> InstigatorController;
+
+	/** Actor the projectile never collides with, usually the shooter */
+	TWeakObjectPtr<AActor> IgnoredActor;
+
+	/** Seconds the projectile should be fast-forwarded to match what the shooter saw */
+	float CatchUpTime = 0.0f;
+};
+
+/**
+ * Blocking hit produced by the simulation, resolved by the owner.
+ */
+struct FProjectileImpact {
+	FHitResult HitResult;
+	int32 DefinitionIndex = INDEX_NONE;
+	TWeakObjectPtr<AActor> DamageCauser;
+	TWeakObjectPtr<AController> InstigatorController;
+};
+
+/**
+ * Batched simulation of every in-flight projectile in a world.
+ *
+ * State is kept as parallel arrays so the integrator walks memory linearly.
+ * Projectiles fired by lagging clients first go through a catch-up pass that
+ * fast-forwards them against rewound character capsules before they join the
+ * regular simulation.
+ *
+ * Regular integration runs as a background task between BeginIntegrate() and
+ * FinishIntegrate(). Launches are always queued, so weapons can fire while it runs.
+ *
+ * @note Impacts are reported, not applied - see UWeaponSubsystem for damage
+ * @warning Game thread only, apart from the integration task itself
+ */
+class WEAPONHANDLINGMODULE_API FProjectileSimulation {
+public:
+	/**
+	 * Registers shared projectile values, reusing an identical existing definition.
+	 *
+	 * @return Index to reference the definition when launching
+	 */
+	int32 RegisterDefinition(const FProjectileDefinition& Definition);
+
+	FORCEINLINE const FProjectileDefinition& GetDefinition(int32 DefinitionIndex) const { return Definitions[DefinitionIndex]; }
+
+	/**
+	 * Queues a projectile for simulation.
+	 *
+	 * @param LaunchParams Spawn state and attribution
+	 *
+	 * @note Every projectile joins the simulation at the next catch-up pass
+	 */
+	void Launch(const FProjectileLaunchParams& LaunchParams);
+
+	/**
+	 * Fast-forwards every projectile launched since the last call by its catch-up time, then puts it in flight.
+	 *
+	 * @param World World to query static and dynamic geometry in
+	 * @param HitboxHistory Character capsules to rewind pawn collision against
+	 * @param OutImpacts Receives hits, appended
+	 *
+	 * @note One batched pass: character capsules are rewound once per time slice for all projectiles
+	 */
+	void RunCatchUp(UWorld* World, const FHitboxHistory& HitboxHistory, TArray<FProjectileImpact>& OutImpacts);
+
+	/**
+	 * Advances every projectile in flight.
+	 *
+	 * @param World World to sweep projectile segments in
+	 * @param DeltaTime Frame time increment
+	 * @param OutImpacts Receives hits, appended
+	 *
+	 * @note Characters are hit through their capsules, not the scene query
+	 * @note Segments in baked free space skip the static part of the scene query,
+	 *       other pawns, vehicles and physics bodies are always queried
+	 * @note Homing rounds are steered once per call, before the ballistic substeps
+	 * @note Wind is sampled once per round per call and acts through drag
+	 * @warning Expects the pawn broadphase to be current, see BeginIntegrate()
+	 */
+	void Integrate(UWorld* World, float DeltaTime, TArray<FProjectileImpact>& OutImpacts);
+
+	/**
+	 * Starts advancing every projectile in flight by a number of fixed steps.
+	 *
+	 * @param World World to sweep projectile segments in
+	 * @param StepTime Length of one step (seconds)
+	 * @param NumSteps Steps to run, may be 0
+	 *
+	 * @note Runs on a worker unless weapon.Sim.AsyncProjectiles is off - in-flight
+	 *       state must not be read until FinishIntegrate()
+	 */
+	void BeginIntegrate(UWorld* World, float StepTime, int32 NumSteps);
+
+	/**
+	 * Waits for the steps started by BeginIntegrate().
+	 *
+	 * @param OutImpacts Receives the hits they produced, appended
+	 */
+	void FinishIntegrate(TArray<FProjectileImpact>& OutImpacts);
+
+	/** Blocks until the integration task is done, leaving its impacts queued */
+	void WaitForIntegrate();
+
+	/**
+	 * Maps the baked static occupancy of a world's map, if it has one.
+	 *
+	 * @param World World whose persistent level map to look up
+	 */
+	void LoadStaticOccupancy(const UWorld* World);
+
+	/** Number of projectiles in flight, excluding those awaiting catch-up */
+	FORCEINLINE int32 Num() const { return Positions.Num(); }
+
+	/** Number of registered definitions */
+	FORCEINLINE int32 NumDefinitions() const { return Definitions.Num(); }
+
+	// Read-only views of the in-flight state for bulk consumers, indexed like each other
+	FORCEINLINE const TArray<FVector>& GetPositions() const { return Positions; }
+	FORCEINLINE const TArray<FVector>& GetVelocities() const { return Velocities; }
+	FORCEINLINE const TArray<int32>& GetDefinitionIndices() const { return DefinitionIndices; }
+
+	/** Removes every projectile and definition */
+	void Reset();
+
+private:
+	/** Projectile waiting for the catch-up pass */
+	struct FCatchUpProjectile {
+		FProjectileLaunchParams LaunchParams;
+		FVector Position = FVector::ZeroVector;
+		FVector Velocity = FVector::ZeroVector;
+		float FlightTime = 0.0f;
+		bool bFinished = false;
+	};
+
+	/** Appends a projectile to the in-flight arrays */
+	void AddInFlight(const FVector& Position, const FVector& Velocity, float FlightTime, const FProjectileLaunchParams& LaunchParams);
+
+	/** Removes an in-flight projectile by swapping the last one into its place */
+	void RemoveInFlight(int32 Index);
+
+	/** In-flight state as seen by the homing batch */
+	FProjectileHoming::FInFlightView GetHomingView();
+
+	TArray<FProjectileDefinition> Definitions;
+
+	// In-flight state, one entry per projectile across all arrays
+	TArray<FVector> Positions;
+	TArray<FVector> Velocities;
+	TArray<float> FlightTimes;
+	TArray<int32> DefinitionIndices;
+	TArray<TWeakObjectPtr<AActor>> DamageCausers;
+	TArray<TWeakObjectPtr<AController>> InstigatorControllers;
+	TArray<TWeakObjectPtr<AActor>> IgnoredActors;
+	TArray<FObjectKey> HomingTargets;
+	TArray<FVector> HomingAimPoints;
+
+	/** Target selection and steering of guided rounds */
+	FProjectileHoming Homing;
+
+	/** Wind around the rounds in flight, resampled at a low rate */
+	FProjectileWindField WindField;
+
+	/** Whether any registered definition homes, skips homing work otherwise */
+	bool bHasHomingDefinitions = false;
+
+	/** Projectiles launched since the last catch-up pass */
+	TArray<FCatchUpProjectile> PendingCatchUp;
+
+	/** Background integration started by BeginIntegrate() */
+	UE::Tasks::FTask IntegrateTask;
+
+	/** Hits produced by IntegrateTask, written only by it */
+	TArray<FProjectileImpact> IntegrateImpacts;
+
+	/** Present character capsules, rebuilt every Integrate() */
+	FPawnCapsuleBroadphase PawnBroadphase;
+
+	/** Rewound character capsules of the current catch-up slice */
+	FPawnCapsuleBroadphase CatchUpBroadphase;
+
+	/** Lets Integrate() skip static sweeps through open air */
+	FStaticOccupancyGrid StaticOccupancy;
+};
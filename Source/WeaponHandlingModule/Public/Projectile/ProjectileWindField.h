@@ -0,0 +1,56 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Coarse grid of wind velocities around the projectiles in flight.
+ *
+ * The scene's wind sources are sampled once per grid point at a low rate, and
+ * rounds read the grid by trilinear interpolation, so wind costs eight loads
+ * per projectile step instead of a scene query.
+ *
+ * @note The grid follows the bounds of the rounds in flight, positions outside it read the nearest edge
+ * @warning Update on the game thread, sample from any thread in between
+ */
+class WEAPONHANDLINGMODULE_API FProjectileWindField {
+public:
+	/**
+	 * Resamples the scene's wind around the given positions if the update interval has passed.
+	 *
+	 * @param World World whose wind sources are sampled
+	 * @param Positions Rounds the grid should cover
+	 */
+	void Update(const UWorld* World, TConstArrayView<FVector> Positions);
+
+	/**
+	 * Returns the interpolated wind velocity at a location (cm/s).
+	 */
+	FVector Sample(const FVector& Location) const;
+
+	/** Whether every sample is still, so callers can skip sampling */
+	FORCEINLINE bool IsCalm() const { return bCalm; }
+
+	void Reset();
+
+private:
+	FORCEINLINE int32 GetSampleIndex(int32 X, int32 Y, int32 Z) const {
+		return (Z * Resolution.Y + Y) * Resolution.X + X;
+	}
+
+	/** Wind velocity at each grid point, X fastest */
+	TArray<FVector3f> Samples;
+
+	/** World location of the first grid point */
+	FVector Origin = FVector::ZeroVector;
+
+	FIntVector Resolution = FIntVector::ZeroValue;
+
+	float CellSize = 1.0f;
+
+	/** World time of the last resample */
+	double LastUpdateTime = -UE_BIG_NUMBER;
+
+	bool bCalm = true;
+};
@@ -0,0 +1,129 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+DECLARE_STATS_GROUP(TEXT("WeaponProjectile"), STATGROUP_WeaponProjectile, STATCAT_Advanced);
+
+/**
+ * On-disk layout of a baked occupancy grid.
+ *
+ * The file is the header, then one uint32 per brick, then 8 uint64 words per
+ * stored brick. A brick is BrickSize^3 cells with one bit per cell.
+ */
+struct FStaticOccupancyHeader {
+	static constexpr uint32 ExpectedMagic = 0x43434F57; // 'WOCC'
+	static constexpr uint32 CurrentVersion = 1;
+	static constexpr int32 BrickSize = 8;
+	static constexpr int32 WordsPerBrick = BrickSize * BrickSize * BrickSize / 64;
+
+	/** Brick table value of a brick without any occupied cell */
+	static constexpr uint32 EmptyBrick = 0;
+
+	/** Brick table value of a brick with every cell occupied */
+	static constexpr uint32 FullBrick = 1;
+
+	/** Brick table values from here on index stored bricks, offset by FirstStoredBrick */
+	static constexpr uint32 FirstStoredBrick = 2;
+
+	uint32 Magic = ExpectedMagic;
+	uint32 Version = CurrentVersion;
+
+	/** World location of the minimum corner of cell (0, 0, 0) */
+	double OriginX = 0.0;
+	double OriginY = 0.0;
+	double OriginZ = 0.0;
+
+	/** Edge length of a cell (cm) */
+	float CellSize = 0.0f;
+
+	int32 NumBricksX = 0;
+	int32 NumBricksY = 0;
+	int32 NumBricksZ = 0;
+
+	int32 NumStoredBricks = 0;
+
+	/** Keeps the brick table 8 byte aligned */
+	uint32 Padding = 0;
+
+	FORCEINLINE int32 GetNumBricks() const { return NumBricksX * NumBricksY * NumBricksZ; }
+
+	/** Byte offset of the first stored brick */
+	FORCEINLINE int64 GetBrickDataOffset() const { return Align(sizeof(FStaticOccupancyHeader) + GetNumBricks() * sizeof(uint32), sizeof(uint64)); }
+
+	/** Expected file size */
+	FORCEINLINE int64 GetFileSize() const { return GetBrickDataOffset() + static_cast<int64>(NumStoredBricks) * WordsPerBrick * sizeof(uint64); }
+};
+
+static_assert(sizeof(FStaticOccupancyHeader) % sizeof(uint64) == 0, "Brick data must stay 8 byte aligned");
+
+/**
+ * Baked, memory-mapped occupancy of a map's static collision.
+ *
+ * Lets the projectile integrator tell segments through open air from segments
+ * near static geometry without a scene query. Cells are marked occupied when
+ * any static collision touches them, so a free answer is always safe while an
+ * occupied one only means a sweep is needed. Space outside the baked bounds
+ * counts as occupied.
+ *
+ * @note Baked per map by the WeaponOccupancyBake commandlet, see GetFilename()
+ * @warning Only describes static geometry present at bake time
+ */
+class WEAPONHANDLINGMODULE_API FStaticOccupancyGrid {
+public:
+	FStaticOccupancyGrid();
+	~FStaticOccupancyGrid();
+
+	UE_NONCOPYABLE(FStaticOccupancyGrid);
+
+	/**
+	 * Returns where the grid of a map lives, next to the map package.
+	 *
+	 * @param MapPackageName Long package name of the map, without PIE prefix
+	 */
+	static FString GetFilename(const FString& MapPackageName);
+
+	/**
+	 * Maps the baked grid of a map, if there is one.
+	 *
+	 * @param MapPackageName Long package name of the map, without PIE prefix
+	 * @return True if a valid grid was mapped
+	 */
+	bool Load(const FString& MapPackageName);
+
+	/** Unmaps the grid */
+	void Reset();
+
+	FORCEINLINE bool IsLoaded() const { return Header != nullptr; }
+
+	/**
+	 * Walks the cells a segment crosses.
+	 *
+	 * @param Start Segment start
+	 * @param End Segment end
+	 * @return True if every crossed cell was baked and holds no static collision
+	 *
+	 * @note Always false when nothing is loaded
+	 */
+	bool IsSegmentFree(const FVector& Start, const FVector& End) const;
+
+private:
+	/** Rejects headers that do not describe a file of exactly MappedSize bytes */
+	static bool IsValidHeader(const FStaticOccupancyHeader& InHeader, int64 MappedSize);
+
+	bool IsCellOccupied(const FIntVector& Cell) const;
+
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	// Views into the mapped region
+	const FStaticOccupancyHeader* Header = nullptr;
+	const uint32* BrickTable = nullptr;
+	const uint64* BrickWords = nullptr;
+
+	FIntVector NumCells = FIntVector::ZeroValue;
+};
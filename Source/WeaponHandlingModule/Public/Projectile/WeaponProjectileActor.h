@@ -0,0 +1,91 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "WeaponProjectileActor.generated.h"
+
+class UParticleSystem;
+class UProjectileMovementComponent;
+class USphereComponent;
+struct FProjectileDefinition;
+struct FProjectileLaunchParams;
+
+/**
+ * Projectile round that needs to be a full actor, such as a rocket with lights, audio and trails.
+ *
+ * Instances are pooled per class and reused: launching resets movement,
+ * collision and effect components instead of spawning, and impact or expiry
+ * puts the actor back to sleep instead of destroying it.
+ *
+ * @note Plain rounds should use the batched simulation, see FProjectileSimulation
+ * @remark Effect and audio components set to auto activate are restarted on every launch
+ * @see FProjectileActorPool for acquisition and release
+ */
+UCLASS(Blueprintable)
+class WEAPONHANDLINGMODULE_API AWeaponProjectileActor : public AActor {
+	GENERATED_BODY()
+
+public:
+	AWeaponProjectileActor();
+
+	virtual void PostInitializeComponents() override;
+
+	virtual void Tick(float DeltaTime) override;
+
+	/**
+	 * Puts the round in flight.
+	 *
+	 * @param LaunchParams Spawn state and attribution
+	 * @param Definition Ballistic and damage values of the firing weapon
+	 *
+	 * @note Drag and catch-up time are not applied - projectile movement has no equivalent
+	 */
+	void Launch(const FProjectileLaunchParams& LaunchParams, const FProjectileDefinition& Definition);
+
+	/**
+	 * Stops the round and hides it until the next launch.
+	 *
+	 * @note Called by the pool, both for new and released actors
+	 */
+	void Deactivate();
+
+	FORCEINLINE bool IsInFlight() const { return bInFlight; }
+
+protected:
+	/** Lets subclasses reset their own state when reused */
+	UFUNCTION(BlueprintImplementableEvent, Category = "Weapon | Projectile")
+	void OnLaunched();
+
+	UFUNCTION(BlueprintImplementableEvent, Category = "Weapon | Projectile")
+	void OnDeactivated();
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Weapon | Projectile")
+	TObjectPtr<USphereComponent> CollisionSphere;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Weapon | Projectile")
+	TObjectPtr<UProjectileMovementComponent> ProjectileMovement;
+
+private:
+	UFUNCTION()
+	void HandleProjectileStop(const FHitResult& ImpactResult);
+
+	/** Returns the actor to its pool */
+	void Release();
+
+	/** Effect and audio components restarted on launch, gathered once */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UActorComponent>> EffectComponents;
+
+	TWeakObjectPtr<AActor> DamageCauser;
+	TWeakObjectPtr<AController> InstigatorController;
+	TWeakObjectPtr<AActor> IgnoredActor;
+	TWeakObjectPtr<UParticleSystem> ImpactParticle;
+	float Damage = 0.0f;
+
+	/** World time after which the round expires */
+	double ExpireTime = 0.0;
+
+	bool bInFlight = false;
+};
@@ -0,0 +1,93 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Sparse uniform hash grid mapping world cells to item indices.
+ *
+ * Items are plain indices into an array owned by the caller, which keeps the grid
+ * independent of what it stores and cheap to rebuild every frame.
+ *
+ * @note Queries return candidates from overlapping cells - callers do the exact test
+ * @warning Not thread safe
+ */
+class WEAPONHANDLINGMODULE_API FWeaponSpatialGrid {
+public:
+	explicit FWeaponSpatialGrid(float InCellSize = 1000.0f);
+
+	/**
+	 * Quantizes a location to a cell coordinate.
+	 *
+	 * @param Location World location
+	 * @param CellSize Edge length of a cell (cm)
+	 */
+	static FIntVector GetCell(const FVector& Location, float CellSize);
+
+	/** Quantizes a location using this grid's cell size */
+	FORCEINLINE FIntVector GetCell(const FVector& Location) const { return GetCell(Location, CellSize); }
+
+	/**
+	 * Changes the cell size.
+	 *
+	 * @warning Clears all items
+	 */
+	void SetCellSize(float InCellSize);
+
+	/** Removes all items while keeping cell allocations for the next rebuild */
+	void Reset();
+
+	/**
+	 * Inserts an item at a point.
+	 *
+	 * @param Item Caller-owned index
+	 * @param Location Item location
+	 */
+	void Add(int32 Item, const FVector& Location);
+
+	/**
+	 * Inserts an item into every cell overlapped by a box.
+	 *
+	 * @param Item Caller-owned index
+	 * @param Bounds Item extent
+	 *
+	 * @note Queries may then return the item more than once
+	 */
+	void AddBounds(int32 Item, const FBox& Bounds);
+
+	/**
+	 * Collects items in every cell touched by a sphere.
+	 *
+	 * @param Center Sphere center
+	 * @param Radius Sphere radius (cm)
+	 * @param OutItems Receives candidate items, appended
+	 *
+	 * @note Cells outside the sphere but inside its bounds are included
+	 */
+	template<typename AllocatorType>
+	void QuerySphere(const FVector& Center, float Radius, TArray<int32, AllocatorType>& OutItems) const {
+		const FIntVector MinCell = GetCell(Center - FVector(Radius));
+		const FIntVector MaxCell = GetCell(Center + FVector(Radius));
+
+		for (int32 X = MinCell.X; X <= MaxCell.X; ++X) {
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y) {
+				for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z) {
+					if (const TArray<int32>* CellItems = Cells.Find(FIntVector(X, Y, Z))) {
+						OutItems.Append(*CellItems);
+					}
+				}
+			}
+		}
+	}
+
+	/** Returns the items stored in a single cell, or nullptr if empty */
+	const TArray<int32>* FindCell(const FIntVector& Cell) const;
+
+	FORCEINLINE float GetCellSize() const { return CellSize; }
+
+private:
+	float CellSize;
+
+	TMap<FIntVector, TArray<int32>> Cells;
+};
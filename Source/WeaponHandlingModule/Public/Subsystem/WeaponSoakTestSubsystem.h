@@ -0,0 +1,99 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/PrimaryAssetId.h"
+#include "WeaponSoakTestSubsystem.generated.h"
+
+class ABaseWeapon;
+class ACharacter;
+class UWeaponHandlingComponent;
+
+/**
+ * Headless soak test for long firing sessions.
+ *
+ * Spawns scripted bots that equip, fire, drop and re-equip weapons through
+ * UWeaponHandlingComponent for a set number of hours. Every sample interval it
+ * records UObject counts per class, memory, weapon timers and the pool sizes of
+ * UWeaponSubsystem, and flags every value that grew in each of the last
+ * weapon.Soak.GrowthWindow samples. The process exits with code 1 if anything
+ * was flagged.
+ *
+ * @note Only created with -WeaponSoak on the command line, runs on servers and standalone games
+ * @remark Options: -WeaponSoakWeapon=<WeaponDefinition asset name> (required),
+ *         -WeaponSoakHours=<hours>, -WeaponSoakBots=<count>
+ * @see UWeaponSubsystem::ForEachPoolSize()
+ */
+UCLASS()
+class WEAPONHANDLINGMODULE_API UWeaponSoakTestSubsystem : public UTickableWorldSubsystem {
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	virtual void Deinitialize() override;
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	/** One scripted owner cycling through equip, fire and drop */
+	struct FSoakBot {
+		TWeakObjectPtr<ACharacter> Character;
+		TWeakObjectPtr<UWeaponHandlingComponent> WeaponHandling;
+		TWeakObjectPtr<ABaseWeapon> Weapon;
+		bool bArmed = false;
+		double PhaseEndTime = 0.0;
+		double NextShotTime = 0.0;
+	};
+
+	/** History of one sampled value */
+	struct FSoakMetric {
+		TArray<int64> Samples;
+
+		/** Growth between two samples at or below this is noise */
+		int64 Tolerance = 0;
+
+		bool bFlagged = false;
+	};
+
+	/** Spawns a bot and its weapon, false if the weapon definition does not resolve */
+	bool SpawnBot(int32 BotIndex, int32 NumBots, const FVector& Center);
+
+	/** Advances one bot's equip, fire and drop cycle */
+	void TickBot(FSoakBot& Bot, double CurrentTime);
+
+	/** Records every metric and flags the ones that keep growing */
+	void TakeSample();
+
+	/** Appends a value to a metric, creating it on first use */
+	void RecordMetric(const FString& Name, int64 Value, int64 Tolerance);
+
+	/** Logs the result and exits with it */
+	void FinishRun();
+
+	TArray<FSoakBot> Bots;
+
+	TMap<FString, FSoakMetric> Metrics;
+
+	/** Definition the bots' weapons are spawned from */
+	FPrimaryAssetId WeaponDefinitionId;
+
+	double EndTime = 0.0;
+	double NextSampleTime = 0.0;
+	int32 NumSamples = 0;
+
+	/** Garbage collection was requested, the sample is taken on the following tick */
+	bool bSamplePending = false;
+
+	bool bRunning = false;
+	bool bFailed = false;
+};
@@ -0,0 +1,293 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AI/AbstractCombatResolver.h"
+#include "AI/GunfireStimulusAggregator.h"
+#include "AI/SentryTurretManager.h"
+#include "Audio/GunfireOcclusionCache.h"
+#include "Net/HitFeedbackAggregator.h"
+#include "Net/ShotInterestManager.h"
+#include "Projectile/ProjectileActorPool.h"
+#include "Projectile/HitboxHistory.h"
+#include "Projectile/ProjectileInstanceRenderer.h"
+#include "Projectile/ProjectileSimulation.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WeaponSubsystem.generated.h"
+
+class ARangedWeapon;
+struct FPrimaryAssetId;
+
+/**
+ * Per-world owner of weapon work shared between weapon instances.
+ *
+ * Hosts caches and batched systems that would otherwise be paid once per weapon
+ * or once per shot, and advances them once per frame.
+ *
+ * @note Created automatically for game and PIE worlds
+ * @see FGunfireOcclusionCache for gunfire audio occlusion
+ * @see FGunfireStimulusAggregator for AI hearing of gunfire
+ * @see FProjectileSimulation for in-flight projectiles
+ * @see FProjectileInstanceRenderer for drawing them
+ * @see FProjectileActorPool for rounds that have to be actors
+ * @see FHitFeedbackAggregator for damage numbers and hit markers
+ * @see FSentryTurretManager for waking sentries
+ */
+UCLASS()
+class WEAPONHANDLINGMODULE_API UWeaponSubsystem : public UTickableWorldSubsystem {
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	virtual void Deinitialize() override;
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+	virtual void Tick(float DeltaTime) override;
+
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * Spawns a weapon variant from its definition.
+	 *
+	 * @param DefinitionId Primary asset ID of a UWeaponDefinition
+	 * @param Transform Spawn transform
+	 * @return Spawned weapon, null if the definition does not resolve
+	 *
+	 * @note Spawns a native weapon class - no Blueprint class is loaded per variant
+	 */
+	ARangedWeapon* SpawnWeapon(const FPrimaryAssetId& DefinitionId, const FTransform& Transform);
+
+	/**
+	 * Returns the cached occlusion volume for gunfire at a location.
+	 *
+	 * @param ShooterLocation Location of the firing weapon
+	 * @return Volume multiplier for the primary local listener
+	 *
+	 * @note Constant cost per shot - traces are amortized in Tick()
+	 */
+	float GetGunfireVolumeMultiplier(const FVector& ShooterLocation);
+
+	/**
+	 * Queues a shot to be heard by AI.
+	 *
+	 * @param Shooter Actor credited as the noise instigator
+	 * @param Location Where the shot was fired
+	 * @param Loudness Hearing range multiplier of the shot
+	 * @param MaxRange Hard audible range, 0 to use listener hearing ranges only
+	 *
+	 * @note Shots are merged per shooter and delivered once per perception interval
+	 */
+	void ReportGunfire(AActor* Shooter, const FVector& Location, float Loudness, float MaxRange);
+
+	/**
+	 * Registers values shared by every projectile of a weapon definition.
+	 *
+	 * @return Index to pass in FProjectileLaunchParams::DefinitionIndex
+	 */
+	int32 RegisterProjectileDefinition(const FProjectileDefinition& Definition);
+
+	/**
+	 * Hands a projectile to the batched simulation.
+	 *
+	 * @param LaunchParams Spawn state, attribution and catch-up time
+	 * @note Catch-up only happens on the server
+	 */
+	void LaunchProjectile(const FProjectileLaunchParams& LaunchParams);
+
+	/**
+	 * Puts a pooled projectile actor into flight.
+	 *
+	 * @param ActorClass Projectile actor class to take from the pool
+	 * @param LaunchParams Spawn state and attribution, DefinitionIndex selects the ballistics
+	 * @return Launched actor, null if none could be spawned
+	 *
+	 * @note For rounds carrying their own components - plain rounds belong in LaunchProjectile()
+	 */
+	AWeaponProjectileActor* LaunchProjectileActor(TSubclassOf<AWeaponProjectileActor> ActorClass, const FProjectileLaunchParams& LaunchParams);
+
+	/**
+	 * Returns a projectile actor to its pool after impact or expiry.
+	 */
+	void ReleaseProjectileActor(AWeaponProjectileActor* Actor);
+
+	/**
+	 * Spawns dormant projectile actors ahead of the first shot.
+	 *
+	 * @param ActorClass Projectile actor class
+	 * @param Count Dormant actors the class should have at least
+	 */
+	void PrewarmProjectileActors(TSubclassOf<AWeaponProjectileActor> ActorClass, int32 Count);
+
+	/**
+	 * Central damage path for every weapon hit.
+	 *
+	 * @param DamageAmount Damage to deal
+	 * @param InstigatorController Controller credited with the hit
+	 * @param DamageCauser Weapon credited with the hit
+	 * @param HitResult Hit being resolved
+	 * @param ImpactParticle Effect handed to the damaged actor, or spawned at the impact otherwise
+	 *
+	 * @note Damage is only applied with authority, impact effects only where rendered
+	 * @remark Damage dealt by players is reported to their hit feedback at the end of the frame
+	 */
+	void ApplyWeaponDamage(float DamageAmount, AController* InstigatorController, AActor* DamageCauser, FHitResult& HitResult, UParticleSystem* ImpactParticle);
+
+	/**
+	 * Schedules a weapon's cosmetic shot batch to be sent at the end of this frame.
+	 *
+	 * @param Weapon Weapon whose batch just received its first shot
+	 * @see ARangedWeapon::FlushShotCosmetics()
+	 */
+	void QueueShotCosmeticFlush(ARangedWeapon* Weapon);
+
+	/**
+	 * Sends a weapon's cosmetic batch to the connections that can see or hear it.
+	 *
+	 * @param Weapon Weapon that fired
+	 * @param Batch Shots fired this frame
+	 * @param AudibleRange Range around the muzzle that receives the shots (cm)
+	 * @param VisibleRange Range around each tracer that receives the shots (cm)
+	 * @return Number of connections the batch was sent to
+	 *
+	 * @note Out of range connections hear the shots through the distant gunfire summary
+	 */
+	int32 DeliverShotCosmetics(ARangedWeapon* Weapon, const FShotCosmeticBatch& Batch, float AudibleRange, float VisibleRange);
+
+	/**
+	 * Checks whether any player could see or hear a shot.
+	 *
+	 * @param ShotOrigin Muzzle location
+	 * @param ShotEnd Where the shot is aimed
+	 * @param AudibleRange Range around the muzzle in which the shot is heard (cm)
+	 * @param VisibleRange Range around the tracer in which the shot is seen (cm)
+	 *
+	 * @note Uses the same view point grid as shot event delivery
+	 */
+	bool IsObservedByPlayer(const FVector& ShotOrigin, const FVector& ShotEnd, float AudibleRange, float VisibleRange);
+
+	FORCEINLINE FAbstractCombatResolver& GetAbstractCombatResolver() { return AbstractCombatResolver; }
+
+	FORCEINLINE FSentryTurretManager& GetSentryTurretManager() { return SentryTurretManager; }
+
+	/**
+	 * Time on the fixed-step weapon clock.
+	 *
+	 * @return Seconds simulated so far, a whole number of steps
+	 * @note Use for weapon cooldowns so they do not depend on frame rate
+	 */
+	FORCEINLINE double GetSimulationTime() const { return SimulationTime; }
+
+	/**
+	 * Furthest the fixed-step weapon clock can advance in one frame.
+	 *
+	 * @return weapon.Sim.MaxStepsPerFrame steps of the current step length (seconds)
+	 * @note A gap between two calls longer than this means at least one frame passed without a call
+	 */
+	FORCEINLINE double GetMaxSimulationAdvance() const { return MaxSimulationAdvance; }
+
+	/**
+	 * Accounts identical cosmetic shot RPCs for the WeaponNet stats.
+	 *
+	 * @param NumRPCs Connections the payload was sent to
+	 * @param NumShots Shots carried by each RPC
+	 * @param NumBits Payload size of each RPC, 0 when stats are compiled out
+	 */
+	void RecordShotCosmeticRPCs(int32 NumRPCs, int32 NumShots, int64 NumBits);
+
+	/**
+	 * Accounts a dropped weapon's state change for the WeaponNet stats.
+	 *
+	 * @param NumConnections Connections the change is replicated to
+	 * @param NumBits Size of the replicated state, 0 when stats are compiled out
+	 * @see FWeaponDropState
+	 */
+	void RecordWeaponDropUpdates(int32 NumConnections, int64 NumBits);
+
+	/**
+	 * Reports the size of every container the subsystem keeps across frames.
+	 *
+	 * @param Report Called with a stable name and the current element count of each
+	 * @note Used by the soak test to detect pools that never stop growing
+	 * @remark Waits for the projectile integration task, if one is running
+	 */
+	void ForEachPoolSize(TFunctionRef<void(const TCHAR*, int64)> Report);
+
+protected:
+	virtual bool DoesSupportWorldType(const EWorldType::Type WorldType) const override;
+
+private:
+	/** Resolves projectile hits produced this frame */
+	void HandleProjectileImpacts(TArray<FProjectileImpact>& Impacts);
+
+	/** Completes background projectile integration and resolves its hits */
+	void FinishProjectileIntegration();
+
+	/** Shooter cell to listener audio occlusion */
+	FGunfireOcclusionCache GunfireOcclusionCache;
+
+	/** Per-shooter gunfire to AI hearing coalescing */
+	FGunfireStimulusAggregator GunfireStimulusAggregator;
+
+	/** Recent character capsules for lag-compensated projectile catch-up */
+	FHitboxHistory HitboxHistory;
+
+	/** Every projectile in flight */
+	FProjectileSimulation ProjectileSimulation;
+
+	/** Instanced visuals of ProjectileSimulation */
+	FProjectileInstanceRenderer ProjectileInstanceRenderer;
+
+	/** Dormant actor rounds, per class */
+	FProjectileActorPool ProjectileActorPool;
+
+	/** Impacts gathered during Tick, kept to reuse its allocation */
+	TArray<FProjectileImpact> ProjectileImpacts;
+
+	/** Per-connection filtering of shot events */
+	FShotInterestManager ShotInterestManager;
+
+	/** Statistical hits for AI combat no player observes */
+	FAbstractCombatResolver AbstractCombatResolver;
+
+	/** Per-player, per-target merging of confirmed hits */
+	FHitFeedbackAggregator HitFeedbackAggregator;
+
+	/** Sleeping and awake sentries by wake radius */
+	FSentryTurretManager SentryTurretManager;
+
+	/** Fixed-step weapon clock */
+	double SimulationTime = 0.0;
+
+	/** Frame time not yet simulated, less than one step */
+	float SimulationAccumulator = 0.0f;
+
+	/** See GetMaxSimulationAdvance() */
+	double MaxSimulationAdvance = 0.0;
+
+	/** Keeps the integration task from running into garbage collection */
+	FDelegateHandle PreGarbageCollectHandle;
+
+	FDelegateHandle PostGarbageCollectHandle;
+
+	/** Weapons with cosmetic shots to send this frame */
+	TArray<TWeakObjectPtr<ARangedWeapon>> PendingShotCosmeticWeapons;
+
+	/** Cosmetic shot traffic accumulated over the current one second window */
+	struct FShotCosmeticTraffic {
+		int32 NumShots = 0;
+		int32 NumRPCs = 0;
+		int64 NumBits = 0;
+		double WindowStartTime = 0.0;
+	};
+	FShotCosmeticTraffic ShotCosmeticTraffic;
+
+	/** Dropped weapon state updates over the same window */
+	struct FWeaponDropTraffic {
+		int32 NumUpdates = 0;
+		int64 NumBits = 0;
+	};
+	FWeaponDropTraffic WeaponDropTraffic;
+};
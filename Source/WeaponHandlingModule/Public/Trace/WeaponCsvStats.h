@@ -0,0 +1,64 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+
+class ARangedWeapon;
+
+#define WEAPON_CSV_STATS_ENABLED CSV_PROFILER
+
+#if WEAPON_CSV_STATS_ENABLED
+
+/** Per-frame weapon work: counts and time per pipeline stage */
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(WEAPONHANDLINGMODULE_API, Weapon);
+
+/** Shots and fire time per weapon definition or class, off by default */
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(WEAPONHANDLINGMODULE_API, WeaponClass);
+
+/**
+ * Writes one trigger pull of a weapon into its definition's CSV columns.
+ *
+ * Adds <Definition>/Shots and times the scope into <Definition>/FireTime.
+ * Weapons without a definition use their class name instead. Column names are
+ * built once per name, so a capture costs one map lookup per shot.
+ *
+ * @note Use CSV_WEAPON_CLASS_SCOPE - it compiles out with the CSV profiler
+ * @remark Enable with -csvCategories=WeaponClass or "csvcategory WeaponClass"
+ * @warning Game thread only
+ */
+class WEAPONHANDLINGMODULE_API FWeaponClassCsvScope {
+public:
+	/**
+	 * @param Weapon Weapon firing, its definition or class names the columns
+	 */
+	explicit FWeaponClassCsvScope(const ARangedWeapon* Weapon);
+
+	~FWeaponClassCsvScope();
+
+private:
+	/** Timing column of the weapon's definition or class, None when not capturing */
+	FName FireTimeStatName;
+};
+
+#define CSV_WEAPON_COUNT(StatName, Count) \
+	CSV_CUSTOM_STAT(Weapon, StatName, static_cast<int32>(Count), ECsvCustomStatOp::Accumulate)
+
+#define CSV_WEAPON_SET(StatName, Value) \
+	CSV_CUSTOM_STAT(Weapon, StatName, static_cast<int32>(Value), ECsvCustomStatOp::Set)
+
+#define CSV_WEAPON_SCOPED_TIMING(StatName) \
+	CSV_SCOPED_TIMING_STAT(Weapon, StatName)
+
+#define CSV_WEAPON_CLASS_SCOPE(Weapon) \
+	FWeaponClassCsvScope PREPROCESSOR_JOIN(WeaponClassCsvScope, __LINE__)(Weapon)
+
+#else
+
+#define CSV_WEAPON_COUNT(...)
+#define CSV_WEAPON_SET(...)
+#define CSV_WEAPON_SCOPED_TIMING(...)
+#define CSV_WEAPON_CLASS_SCOPE(...)
+
+#endif
@@ -0,0 +1,73 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ObjectTrace.h"
+#include "Trace/Trace.h"
+
+#define WEAPON_SHOT_TRACE_ENABLED (UE_TRACE_ENABLED && OBJECT_TRACE_ENABLED && !UE_BUILD_SHIPPING)
+
+class AController;
+class ARangedWeapon;
+struct FHitResult;
+
+#if WEAPON_SHOT_TRACE_ENABLED
+
+UE_TRACE_CHANNEL_EXTERN(WeaponShotChannel, WEAPONHANDLINGMODULE_API);
+
+/**
+ * Writes weapon shots into the trace stream for the Rewind Debugger.
+ *
+ * One Shot event is written per trigger pull with the muzzle, aim ray and
+ * cooldown state, followed by one Pellet event per ray or projectile impact.
+ *
+ * @note Use the TRACE_WEAPON_* macros - they skip argument evaluation while the channel is off
+ * @remark Enable with -trace=object,weaponshot or "Trace.Enable WeaponShot"
+ */
+struct WEAPONHANDLINGMODULE_API FWeaponShotTrace {
+	/**
+	 * Records one trigger pull.
+	 *
+	 * @param Weapon Weapon firing
+	 * @param InstigatorController Controller whose view point is the aim ray
+	 * @param MuzzleTransform Barrel socket transform
+	 * @param AimRange Length of the recorded aim ray (cm)
+	 * @param FiringMode EFiringMode the weapon fired in
+	 * @param BurstShotCount Shots fired in the current burst before this one
+	 * @param bBurstCooldown Whether the weapon was recovering from a burst
+	 * @param FireInterval Configured delay between shots (seconds)
+	 * @param NumPellets Pellets this pull emits
+	 */
+	static void OutputShot(const ARangedWeapon* Weapon, const AController* InstigatorController, const FTransform& MuzzleTransform, float AimRange,
+		uint8 FiringMode, uint8 BurstShotCount, bool bBurstCooldown, float FireInterval, int32 NumPellets);
+
+	/**
+	 * Records one pellet ray and its result.
+	 *
+	 * @param Weapon Weapon credited with the pellet
+	 * @param HitResult Trace result, TraceStart and TraceEnd are the ray
+	 */
+	static void OutputPellet(const ARangedWeapon* Weapon, const FHitResult& HitResult);
+};
+
+#define TRACE_WEAPON_SHOT(Weapon, ...) \
+	do { \
+		if (UE_TRACE_CHANNELEXPR_IS_ENABLED(WeaponShotChannel)) { \
+			FWeaponShotTrace::OutputShot(Weapon, __VA_ARGS__); \
+		} \
+	} while (0)
+
+#define TRACE_WEAPON_PELLET(Weapon, HitResult) \
+	do { \
+		if (UE_TRACE_CHANNELEXPR_IS_ENABLED(WeaponShotChannel)) { \
+			FWeaponShotTrace::OutputPellet(Weapon, HitResult); \
+		} \
+	} while (0)
+
+#else
+
+#define TRACE_WEAPON_SHOT(...) do {} while (0)
+#define TRACE_WEAPON_PELLET(...) do {} while (0)
+
+#endif
@@ -0,0 +1,47 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/LocalPlayerSubsystem.h"
+#include "HitFeedbackSubsystem.generated.h"
+
+class SHitFeedbackOverlay;
+struct FHitFeedback;
+
+/**
+ * Per local player owner of the hit feedback overlay.
+ *
+ * Draws floating damage numbers and a hit marker for confirmed hits. The
+ * overlay is a single widget with a fixed pool of elements, so hits never
+ * create widgets or trigger layout.
+ *
+ * @note The overlay is added to the viewport on the first hit
+ * @see FHitFeedbackAggregator for where hits come from
+ */
+UCLASS()
+class WEAPONHANDLINGMODULE_API UHitFeedbackSubsystem : public ULocalPlayerSubsystem {
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	/**
+	 * Shows a frame of confirmed hits.
+	 *
+	 * @param Hits One entry per target, merged into numbers already shown for it
+	 */
+	void AddHits(TConstArrayView<FHitFeedback> Hits);
+
+private:
+	/** Creates the overlay for the current world, replacing one left in a previous world */
+	SHitFeedbackOverlay* FindOrAddOverlay();
+
+	/** Removes the overlay from the viewport it was added to */
+	void RemoveOverlay();
+
+	TSharedPtr<SHitFeedbackOverlay> Overlay;
+
+	/** World whose viewport holds Overlay */
+	TWeakObjectPtr<UWorld> OverlayWorld;
+};
@@ -0,0 +1,76 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/SLeafWidget.h"
+
+class APlayerController;
+struct FHitFeedback;
+
+/**
+ * Full-screen leaf widget drawing damage numbers and a hit marker.
+ *
+ * Every damage number is an element of a fixed pool allocated at construction.
+ * Elements are projected once per tick and painted directly as draw elements,
+ * so there are no child widgets and nothing to lay out.
+ *
+ * @note Numbers for a target still on screen absorb new hits on it instead of stacking
+ */
+class WEAPONHANDLINGMODULE_API SHitFeedbackOverlay : public SLeafWidget {
+public:
+	SLATE_BEGIN_ARGS(SHitFeedbackOverlay) : _PoolSize(32) {}
+		/** Damage numbers shown at once */
+		SLATE_ARGUMENT(int32, PoolSize)
+	SLATE_END_ARGS()
+
+	/**
+	 * @param InArgs Slate arguments
+	 * @param InPlayerController Player whose view numbers are projected into
+	 */
+	void Construct(const FArguments& InArgs, APlayerController* InPlayerController);
+
+	/**
+	 * Starts or refreshes the damage number of each hit target, and flashes the hit marker.
+	 *
+	 * @param Hits One entry per target
+	 */
+	void AddHits(TConstArrayView<FHitFeedback> Hits);
+
+	virtual void Tick(const FGeometry& AllottedGeometry, const double InCurrentTime, const float InDeltaTime) override;
+
+	virtual int32 OnPaint(const FPaintArgs& Args, const FGeometry& AllottedGeometry, const FSlateRect& MyCullingRect, FSlateWindowElementList& OutDrawElements, int32 LayerId, const FWidgetStyle& InWidgetStyle, bool bParentEnabled) const override;
+
+protected:
+	virtual FVector2D ComputeDesiredSize(float LayoutScaleMultiplier) const override;
+
+private:
+	/** One pooled damage number */
+	struct FHitNumber {
+		TWeakObjectPtr<AActor> Target;
+		FVector WorldLocation = FVector::ZeroVector;
+		float Damage = 0.0f;
+		float Age = 0.0f;
+
+		/** Local position from the last tick */
+		FVector2D ScreenPosition = FVector2D::ZeroVector;
+
+		/** Preformatted damage, rewritten only when the damage changes */
+		FString Text;
+
+		bool bActive = false;
+		bool bOnScreen = false;
+	};
+
+	/** Returns the element to show a target's hits in */
+	FHitNumber& FindOrRecycle(const AActor* Target);
+
+	TWeakObjectPtr<APlayerController> PlayerController;
+
+	TArray<FHitNumber> HitNumbers;
+
+	/** Seconds since the last confirmed hit */
+	float HitMarkerAge = TNumericLimits<float>::Max();
+
+	FSlateFontInfo Font;
+};
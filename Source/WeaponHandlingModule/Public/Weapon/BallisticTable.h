@@ -0,0 +1,97 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Precomputed flat-fire trajectory of a projectile definition.
+ *
+ * Stores time-of-flight and bullet drop sampled at uniform range steps so that
+ * AI aiming and drop compensation are a table lookup rather than an iterated
+ * projectile simulation.
+ *
+ * @note Tables are immutable once built and shared between every weapon using
+ *       the same asset and ballistic parameters
+ * @see FindOrBuild() for the shared table cache
+ */
+class WEAPONHANDLINGMODULE_API FBallisticTable {
+public:
+	/** Number of range samples stored per table */
+	static constexpr int32 NumSamples = 128;
+
+	/**
+	 * Returns the shared table for the given ballistic parameters, building it on first request.
+	 *
+	 * @param Source Asset the parameters are read from - a weapon definition or weapon class
+	 * @param MuzzleSpeed Initial projectile speed (cm/s)
+	 * @param GravityZ Effective gravity acceleration along Z (cm/s^2, negative is down)
+	 * @param DragCoefficient Quadratic drag coefficient (1/cm)
+	 * @param MaxFlightTime Lifetime after which the projectile is discarded (seconds)
+	 * @param MaxRange Furthest range the table has to cover (cm)
+	 *
+	 * @note Identical source and parameters resolve to the same table until the cache is cleared
+	 * @warning Game thread only
+	 */
+	static TSharedRef<const FBallisticTable> FindOrBuild(const UObject* Source, float MuzzleSpeed, float GravityZ, float DragCoefficient, float MaxFlightTime, float MaxRange);
+
+	/**
+	 * Drops the cached tables built for an asset.
+	 *
+	 * @note Weapons keep the table they hold - the next FindOrBuild() builds a new one
+	 */
+	static void Invalidate(const UObject* Source);
+
+	/**
+	 * Drops every cached table.
+	 *
+	 * @note Called on world teardown, so tables do not outlive the weapons that used them
+	 */
+	static void ResetCache();
+
+	/**
+	 * Looks up time-of-flight and drop for a horizontal distance.
+	 *
+	 * @param Range Distance to the target (cm)
+	 * @param OutTimeOfFlight Seconds for the projectile to cover Range
+	 * @param OutDrop Distance the projectile falls below the bore line at Range (cm)
+	 * @return False if the projectile cannot reach Range
+	 */
+	bool SampleAtRange(float Range, float& OutTimeOfFlight, float& OutDrop) const;
+
+	/**
+	 * Computes where to aim so a projectile fired from Origin meets a moving target.
+	 *
+	 * @param Origin Muzzle location
+	 * @param TargetLocation Current target location
+	 * @param TargetVelocity Current target velocity (cm/s)
+	 * @param OutAimPoint World location to aim at, including drop compensation
+	 * @param OutTimeOfFlight Predicted seconds until impact
+	 * @return False if no intercept exists inside the table's reachable range
+	 *
+	 * @note Constant time: two closed-form intercept solves using the table's effective speed
+	 */
+	bool SolveLead(const FVector& Origin, const FVector& TargetLocation, const FVector& TargetVelocity, FVector& OutAimPoint, float& OutTimeOfFlight) const;
+
+	/** Furthest range the projectile reaches before stalling or expiring (cm) */
+	FORCEINLINE float GetMaxReachableRange() const { return MaxReachableRange; }
+
+private:
+	FBallisticTable() = default;
+
+	/** Integrates a horizontal shot and fills the range samples */
+	void Build(float InMuzzleSpeed, float InGravityZ, float InDragCoefficient, float InMaxFlightTime, float InMaxRange);
+
+	/** Average speed over the first Range centimetres of flight */
+	float GetEffectiveSpeedAtRange(float Range) const;
+
+	float MuzzleSpeed = 0.0f;
+	float RangeStep = 0.0f;
+	float MaxReachableRange = 0.0f;
+
+	/** Seconds to reach each range sample */
+	TArray<float> TimeOfFlight;
+
+	/** Drop below the bore line at each range sample (cm, positive is down) */
+	TArray<float> Drop;
+};
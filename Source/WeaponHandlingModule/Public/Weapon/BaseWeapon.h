@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Net/WeaponDropState.h"
 #include "BaseWeapon.generated.h"
 
 class UBoxComponent;
@@ -24,6 +25,8 @@ public:
 	// Called every frame
 	virtual void Tick( float DeltaTime ) override;
 
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 protected:
 
 public:
@@ -34,10 +37,20 @@ public:
 * @note Required for proper damage credit assignment
 * @warning Must be called before weapon can be used
 */
-	void SetOwningCharacter(ACharacter* NewOwner);
+	virtual void SetOwningCharacter(ACharacter* NewOwner);
 
+	/**
+	 * Detaches the weapon and lets it drop where it is.
+	 *
+	 * @note With physics the weapon settles once its body sleeps, after a few seconds at most, see SettleAfterFall()
+	 * @remark Picking the weapon up again cancels the pending settle
+	 * @remark Replicates only the start state and the rest pose, see FWeaponDropState
+	 */
 	void Fall();
 
+	/** Whether a dropped weapon is still simulating physics before it settles */
+	bool IsSettlingAfterFall() const;
+
 	/** 
 	 * Adds single actor to collision exclusion list 
 	 * @param IgnoredActor - Entity to exclude from hit detection
@@ -59,6 +72,45 @@ public:
 	virtual void LaunchAttack( FHitResult& WeaponAttackHitResult, AController* InstigatorController );
 
 private:
+	/**
+	 * Detaches the mesh and starts simulating it.
+	 *
+	 * @param Velocity Initial linear velocity of the mesh
+	 */
+	void BeginDropSimulation(const FVector& Velocity);
+
+	/** Stops simulating a dropped weapon and makes it traceable for pick up */
+	void SettleAfterFall();
+
+	/** Stops any local simulation and blends the mesh to the replicated rest pose */
+	void BlendToRestPose();
+
+	/** Flushes a changed DropState to clients and accounts it for the WeaponNet stats */
+	void PublishDropState();
+
+	/** Starts the cosmetic fall of a drop, or blends to its rest pose */
+	UFUNCTION()
+	void OnRep_DropState();
+
+	/** Pending SettleAfterFall() of the last drop */
+	FTimerHandle SettleTimerHandle;
+
+	/** Start state and rest pose of the last drop */
+	UPROPERTY(ReplicatedUsing = OnRep_DropState)
+	FWeaponDropState DropState;
+
+	/** DropId of the last drop simulated or blended locally, INDEX_NONE before the first */
+	int32 LastAppliedDropId = INDEX_NONE;
+
+	/** World time of the last drop, the body is only checked for sleep after a short grace period */
+	double DropTime = 0.0;
+
+	/** Mesh transform the rest blend started from */
+	FTransform RestBlendStart;
+
+	/** Time into the rest blend, negative when not blending */
+	float RestBlendElapsed = -1.0f;
+
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Weapon", meta = (AllowPrivateAccess = "true"))
 	TObjectPtr<ACharacter> OwningCharacter;
 
@@ -90,5 +142,5 @@ public:
 	 */
 	FORCEINLINE TObjectPtr<USkeletalMeshComponent> GetWeaponMesh() const { return WeaponMesh; }
 
-	FORCEINLINE  TArray<AActor*> GetActorsToIgnore() const { return ActorsToIgnore; }
+	FORCEINLINE const TArray<AActor*>& GetActorsToIgnore() const { return ActorsToIgnore; }
 };
\ No newline at end of file
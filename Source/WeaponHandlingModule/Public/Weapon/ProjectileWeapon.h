@@ -6,6 +6,74 @@
 #include "RangedWeapon.h"
 #include "ProjectileWeapon.generated.h"
 
+class AWeaponProjectileActor;
+class FBallisticTable;
+struct FProjectileLaunchParams;
+
+/**
+ * Ballistic definition shared by every projectile a weapon fires.
+ *
+ * @note Changing any value resolves the weapon to a different ballistic table
+ * @see FBallisticTable for the precomputed trajectory data
+ */
+USTRUCT(BlueprintType)
+struct FProjectileData {
+	GENERATED_BODY()
+
+	// Initialize with sensible defaults
+	FProjectileData() : MuzzleSpeed(30000.0f), GravityScale(1.0f), DragCoefficient(0.0f), MaxFlightTime(5.0f), ProjectileMeshScale(FVector::OneVector), HomingAcceleration(0.0f), HomingRange(3000.0f), HomingConeAngle(30.0f), PrewarmedActorCount(8) {}
+
+	/** Projectile speed when leaving the barrel (cm/s) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Projectile | Ballistics", meta = (ClampMin = "0.0"))
+	float MuzzleSpeed;
+
+	/** Multiplier applied to world gravity */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Projectile | Ballistics")
+	float GravityScale;
+
+	/** Quadratic air drag, deceleration is DragCoefficient * Speed^2 (1/cm) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Projectile | Ballistics", meta = (ClampMin = "0.0"))
+	float DragCoefficient;
+
+	/** Time after which an unimpacted projectile is discarded (seconds) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Projectile | Ballistics", meta = (ClampMin = "0.0"))
+	float MaxFlightTime;
+
+	/** Mesh drawn for each projectile in flight, aligned with its velocity */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Projectile | Visuals")
+	TObjectPtr<UStaticMesh> ProjectileMesh;
+
+	/** Scale applied to ProjectileMesh */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Projectile | Visuals")
+	FVector ProjectileMeshScale;
+
+	/** Turn rate of guided rounds towards their target (cm/s^2), 0 for unguided rounds */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Projectile | Homing", meta = (ClampMin = "0.0"))
+	float HomingAcceleration;
+
+	/** Distance within which guided rounds pick up targets (cm) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Projectile | Homing", meta = (ClampMin = "0.0", EditCondition = "HomingAcceleration > 0"))
+	float HomingRange;
+
+	/** Half angle of the seeker cone around the flight direction (degrees) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Projectile | Homing", meta = (ClampMin = "0.0", ClampMax = "180.0", EditCondition = "HomingAcceleration > 0"))
+	float HomingConeAngle;
+
+	/** Fires pooled actors of this class instead of batched rounds, for rounds with their own lights, audio or trails */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Projectile | Actor")
+	TSubclassOf<AWeaponProjectileActor> ProjectileActorClass;
+
+	/** Dormant actors spawned at load and equip so the first shots reuse them */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Projectile | Actor", meta = (ClampMin = "0", EditCondition = "ProjectileActorClass != nullptr"))
+	int32 PrewarmedActorCount;
+};
+
+/**
+ * Ranged weapon emitting physically simulated projectiles.
+ *
+ * @note Ballistics are configured through ProjectileData
+ * @see ComputeLeadAimPoint() for AI aiming against moving targets
+ */
 UCLASS()
 class WEAPONHANDLINGMODULE_API AProjectileWeapon : public ARangedWeapon {
 	GENERATED_BODY()
@@ -18,9 +86,104 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-	virtual void ShootWeapon( const TArray<AActor*>& IgnoredActors, FHitResult& WeaponFireHitResult, AController* InstigatorController ) override;
+	virtual void ShootWeapon( const FMuzzleVolley& Volley, const TArray<AActor*>& IgnoredActors, FHitResult& WeaponFireHitResult, AController* InstigatorController ) override;
+
+	virtual void ApplyWeaponDefinition(const UWeaponDefinition& Definition) override;
+
+	virtual void ApplyCookedWeaponDefinition(const FCookedWeaponDefinition& Definition, const FWeaponDefinitionDatabase& Database) override;
+
+	/**
+	 * Hands the projectile to the actor pool or the batched simulation.
+	 *
+	 * @param LaunchParams Spawn state and attribution
+	 * @see FProjectileData::ProjectileActorClass
+	 */
+	void LaunchProjectile(const FProjectileLaunchParams& LaunchParams);
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	/**
+	 * Resolves the ballistic table matching the current ProjectileData.
+	 *
+	 * @note Cheap when nothing changed - tables are only built for new parameter sets
+	 * @see FBallisticTable::FindOrBuild()
+	 */
+	void RefreshBallisticTable();
+
+	/**
+	 * Registers this weapon's projectile values with the batched simulation.
+	 *
+	 * @note Identical definitions across weapons share one registration
+	 */
+	void RegisterProjectileDefinition();
+
+	/**
+	 * Resolves the point the instigator is aiming at.
+	 *
+	 * @param InstigatorController Controller whose view point is aimed along
+	 * @param OutAimPoint Aimed-at point at weapon range
+	 * @return False without an instigator, muzzles then fire along their own axis
+	 *
+	 * @note Uses the replicated view point so the server aims like the client
+	 * @remark Resolved once per volley, every muzzle converges on it
+	 */
+	bool GetAimPoint(const AController* InstigatorController, FVector& OutAimPoint) const;
+
+	/**
+	 * Returns how far behind the shooter's view the server receives this shot.
+	 *
+	 * @param InstigatorController Controller that fired
+	 * @return One-way latency in seconds, 0 for local and AI shooters
+	 */
+	float GetShooterLatency(const AController* InstigatorController) const;
+
+	/**
+	 * Replays a remote shot as a cosmetic projectile.
+	 *
+	 * @param ShotOrigin Launch location
+	 * @param ShotEnd Aimed-at point along the launch direction
+	 * @param bHit Unused - projectiles resolve their own impacts
+	 * @param Seed Unused - projectile flight is deterministic
+	 */
+	virtual void PlayShotCosmetic(const FVector& ShotOrigin, const FVector& ShotEnd, bool bHit, uint8 Seed) override;
 
 public:
 	// Called every frame
 	virtual void Tick( float DeltaTime ) override;
+
+	/**
+	 * Tops up the actor pool when the weapon is picked up.
+	 */
+	virtual void SetOwningCharacter(ACharacter* NewOwner) override;
+
+	/**
+	 * Computes the aim point that leads a moving target and compensates for drop.
+	 *
+	 * @param TargetLocation Current target location
+	 * @param TargetVelocity Current target velocity (cm/s)
+	 * @param OutAimPoint World location the barrel should point at
+	 * @return False if the target cannot be reached by this weapon's projectiles
+	 *
+	 * @note Constant time - reads the precomputed ballistic table
+	 * @warning Only valid after BeginPlay
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Weapon | Ballistics")
+	bool ComputeLeadAimPoint(const FVector& TargetLocation, const FVector& TargetVelocity, FVector& OutAimPoint) const;
+
+protected:
+	/** Ballistic behavior of fired projectiles */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Weapon | Configuration")
+	FProjectileData ProjectileData;
+
+private:
+	/** Shared trajectory table for ProjectileData, resolved at load */
+	TSharedPtr<const FBallisticTable> BallisticTable;
+
+	/** Registration in the weapon subsystem's projectile simulation */
+	int32 ProjectileDefinitionIndex = INDEX_NONE;
+
+public:
+	FORCEINLINE const FProjectileData& GetProjectileData() const { return ProjectileData; }
 };
\ No newline at end of file
@@ -4,9 +4,13 @@
 
 #include "CoreMinimal.h"
 #include "BaseWeapon.h"
+#include "Net/ShotCosmeticBatch.h"
 #include "RangedWeapon.generated.h"
 
 class UBoxComponent;
+class FWeaponDefinitionDatabase;
+class UWeaponDefinition;
+struct FCookedWeaponDefinition;
 /**
  * Defines tactical firing behaviors that determine weapon rhythm and control requirements.
  * Each mode represents a distinct combat philosophy with unique tradeoffs.
@@ -56,6 +60,43 @@ enum class EShotPattern : uint8 {
 	ESP_Spread UMETA(DisplayName = "Spread"),
 };
 
+/**
+ * Order in which a weapon with several muzzles fires them.
+ */
+UENUM(BlueprintType)
+enum class EMuzzleFiringOrder : uint8 {
+	/**
+	 * One muzzle per shot, cycling through them
+	 * @note Gatling turrets and twin-linked guns
+	 */
+	EMFO_Alternating UMETA(DisplayName = "Alternating"),
+
+	/**
+	 * Every muzzle on each shot
+	 * @note Double-barrel shotguns and broadsides
+	 */
+	EMFO_Simultaneous UMETA(DisplayName = "Simultaneous"),
+};
+
+/**
+ * Muzzles firing on one trigger event.
+ *
+ * Resolved once per trigger event from the cached muzzle bones, so every
+ * barrel and pellet of the event shares one pass through ShootWeapon().
+ */
+struct FMuzzleVolley {
+	/** Indices into the weapon's muzzles, in firing order */
+	TArray<int32, TInlineAllocator<4>> MuzzleIndices;
+
+	/** World transform of each firing muzzle */
+	TArray<FTransform, TInlineAllocator<4>> MuzzleTransforms;
+
+	/** Shots leaving each muzzle */
+	int32 PelletsPerMuzzle = 1;
+
+	FORCEINLINE int32 Num() const { return MuzzleTransforms.Num(); }
+};
+
 /**
  * Complete weapon configuration package.
  * Serves as data-driven blueprint for weapon behavior and capabilities.
@@ -70,7 +111,7 @@ struct FWeaponData {
 	// Initialize with sensible defaults
 	FWeaponData() : FiringMode(EFiringMode::EFM_Single), WeaponFireRate(0.2f), MaxBurstShotCount(3), BurstShotCooldown(0.5f), WeaponRange(10000.0f), WeaponDamage(10.0f),
 	                bShouldPerformWeaponTraceTest(false), ShotPattern(EShotPattern::ESP_Single), PelletsPerBullet(1), MinimumSpreadRange(-150), MaximumSpreadRange(-MinimumSpreadRange),
-	                MuzzleFlash(nullptr), BeamTrail(nullptr), ImpactParticle(nullptr), WeaponFireSound(nullptr), CurrentAmmoCount(500), MaxAmmoCount(500), CurrentClipCount(50), MaxClipCount(50) {}
+	                MuzzleFlash(nullptr), BeamTrail(nullptr), ImpactParticle(nullptr), WeaponFireSound(nullptr), NoiseLoudness(1.0f), NoiseRange(0.0f), ShotAudibleRange(10000.0f), ShotVisibleRange(5000.0f), AIAccuracy(0.35f), CurrentAmmoCount(500), MaxAmmoCount(500), CurrentClipCount(50), MaxClipCount(50) {}
 
 	// ------------------------------
 	// Firing Mechanics
@@ -152,6 +193,38 @@ struct FWeaponData {
 	UPROPERTY(EditAnywhere, Category = "Weapon | Audio Feedback")
 	TObjectPtr<USoundBase> WeaponFireSound;
 
+	// ------------------------------
+	// AI Perception
+	// ------------------------------
+
+	/** Multiplier applied to AI hearing range for this weapon's shots */
+	UPROPERTY(EditAnywhere, Category = "Weapon | AI Perception", meta = (ClampMin = "0.0"))
+	float NoiseLoudness;
+
+	/** Hard limit on how far shots can be heard (cm), 0 for no limit */
+	UPROPERTY(EditAnywhere, Category = "Weapon | AI Perception", meta = (ClampMin = "0.0"))
+	float NoiseRange;
+
+	// ------------------------------
+	// Network
+	// ------------------------------
+
+	/** Players within this distance of the muzzle receive every shot (cm) */
+	UPROPERTY(EditAnywhere, Category = "Weapon | Network", meta = (ClampMin = "0.0"))
+	float ShotAudibleRange;
+
+	/** Players within this distance of a tracer receive every shot (cm) */
+	UPROPERTY(EditAnywhere, Category = "Weapon | Network", meta = (ClampMin = "0.0"))
+	float ShotVisibleRange;
+
+	// ------------------------------
+	// AI Combat
+	// ------------------------------
+
+	/** Point blank hit chance of AI shots resolved statistically while unobserved */
+	UPROPERTY(EditAnywhere, Category = "Weapon | AI Combat", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float AIAccuracy;
+
 	// ------------------------------
 	// Ammunition
 	// ------------------------------
@@ -188,11 +261,44 @@ public:
 	ARangedWeapon();
 
 protected:
+	/**
+	 * Applies WeaponDefinitionId, if set, before the weapon starts.
+	 */
 	virtual void BeginPlay() override;
 
+	/**
+	 * Takes mesh, barrel socket and weapon data from a definition.
+	 *
+	 * @param Definition Variant to become
+	 * @note Overrides apply their own part, then call this
+	 */
+	virtual void ApplyWeaponDefinition(const UWeaponDefinition& Definition);
+
+	/**
+	 * Takes mesh, barrel socket and weapon data from a cooked definition record.
+	 *
+	 * @param Definition Record read in place from the database
+	 * @param Database Database the record lives in, resolves its strings and assets
+	 * @note Same contract as ApplyWeaponDefinition() - overrides apply their own part, then call this
+	 */
+	virtual void ApplyCookedWeaponDefinition(const FCookedWeaponDefinition& Definition, const FWeaponDefinitionDatabase& Database);
+
 public:
 	virtual void Tick(float DeltaTime) override;
 
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/**
+	 * Selects the definition applied at begin play.
+	 *
+	 * @param DefinitionId Primary asset ID of a UWeaponDefinition
+	 * @warning Only effective before begin play, see UWeaponSubsystem::SpawnWeapon()
+	 */
+	FORCEINLINE void SetWeaponDefinitionId(const FPrimaryAssetId& DefinitionId) { WeaponDefinitionId = DefinitionId; }
+
+	/** Definition selected for this weapon, invalid when it uses the values set on its class */
+	FORCEINLINE const FPrimaryAssetId& GetWeaponDefinitionId() const { return WeaponDefinitionId; }
+
 public:
 	/**
 	 * Primary combat interface triggering all firing behaviors
@@ -210,25 +316,54 @@ public:
 	/** 
 	 * Resets single-shot readiness state
 	 * 
-	 * @note Called automatically by fire rate timer
+	 * @note Call when the trigger is released
 	 * @warning Only affects single-fire mode weapons
 	 */
 	void ResetShouldFireSingleShot();
 
+	/**
+	 * Sends every cosmetic shot queued this frame as one unreliable multicast.
+	 *
+	 * @note Called by UWeaponSubsystem at the end of the frame
+	 * @see QueueShotCosmetic()
+	 */
+	void FlushShotCosmetics();
+
+	/**
+	 * Replays a frame of replicated shots on this client
+	 * @param Batch - Packed shots fired by this weapon in one server frame
+	 *
+	 * @note Ignored where the shots were already played locally
+	 * @see UShotEventRelayComponent::ClientReceiveShotCosmetics()
+	 */
+	void ReceiveShotCosmetics(const FShotCosmeticBatch& Batch);
+
+	FORCEINLINE const FWeaponData& GetWeaponData() const { return WeaponData; }
+
+	/**
+	 * Current world transform of a muzzle
+	 * @param MuzzleIndex - 0 for WeaponBarrelSocket, then AdditionalBarrelSockets in order
+	 *
+	 * @note One bone transform read, no socket lookup by name
+	 */
+	FTransform GetMuzzleTransform(int32 MuzzleIndex) const;
+
+	/** Number of muzzles, at least 1 */
+	FORCEINLINE int32 GetNumMuzzles() const { return FMath::Max(Muzzles.Num(), 1); }
+
 
 protected:
 	/**
-	 * Coordinates complete firing sequence with visual/audio feedback
+	 * Fires every muzzle and pellet of one trigger event in a single pass
+	 * @param Volley - Muzzles firing and pellets per muzzle
 	 * @param IgnoredActors - Entities excluded from collision
-	 * @param WeaponFireHitResult - Output for hit analysis
+	 * @param WeaponFireHitResult - Output for hit analysis, the last muzzle's hit
 	 * @param InstigatorController - Responsible controller
 	 * 
-	 * @note Base implementation handles:
-	 *       - Muzzle flash effects
-	 *       - Bullet trail visualization
-	 * @remark Override to implement custom hit detection
+	 * @note Base implementation plays one muzzle flash per firing muzzle
+	 * @remark Override to implement custom hit detection - share aim work across the volley
 	 */
-	virtual void ShootWeapon( const TArray<AActor*>& IgnoredActors, FHitResult& WeaponFireHitResult, AController* InstigatorController );
+	virtual void ShootWeapon( const FMuzzleVolley& Volley, const TArray<AActor*>& IgnoredActors, FHitResult& WeaponFireHitResult, AController* InstigatorController );
 
 	/**
 	 * Routes to appropriate firing pattern implementation
@@ -238,7 +373,8 @@ protected:
 	 * 
 	 * @note Handles:
 	 *       - Single vs spread shot patterns
-	 *       - Weapon firing sound
+	 *       - Muzzle selection by firing order
+	 *       - Weapon firing sound, once per trigger event
 	 * @see WeaponData.ShotPattern for configuration
 	 */
 	void ExecuteWeaponFire( const TArray<AActor*>& IgnoredActors, FHitResult& WeaponFireHitResult, AController* InstigatorController );
@@ -278,29 +414,104 @@ protected:
 
 	/**
 	 * Visualizes projectile path between muzzle and impact point
+	 * @param MuzzleTransform - Where the shot left the weapon
 	 * @param TraceHitResult - Validated impact data for visualization
-	 * @param Mesh - Weapon visual reference for correct positioning
 	 * 
 	 * @note Requires configured BeamTrail particle system
 	 * @remark Handles both hit and miss visualization cases
 	 */
-	void SpawnBulletTrail(const FHitResult& TraceHitResult, const USkeletalMeshComponent* Mesh) const;
+	void SpawnBulletTrail(const FTransform& MuzzleTransform, const FHitResult& TraceHitResult) const;
 
-	/** 
-	 * Resets all firing cooldown states to allow new shots
-	 * 
-	 * @note Called automatically by weapon timers
-	 * @warning Only affects weapons currently in cooldown
+	/**
+	 * Plays the configured muzzle flash at a muzzle
+	 * @param MuzzleIndex - Muzzle to attach to, see GetMuzzleTransform()
+	 *
+	 * @note Logs a warning when no MuzzleFlash is configured
 	 */
-	void ResetShouldFireWeapon();
+	void SpawnMuzzleFlash(int32 MuzzleIndex) const;
 
-	/** 
-	 * Concludes burst sequence recovery period
-	 * 
-	 * @note Managed internally by burst fire logic
-	 * @warning Duration controlled by WeaponData.BurstShotCooldown
+	/**
+	 * Resolves the bone and offset of every muzzle socket
+	 *
+	 * @note Called at begin play - call again after changing the mesh or the muzzle sockets
+	 */
+	void CacheMuzzles();
+
+	/**
+	 * Muzzle closest to a replicated shot origin
+	 * @param ShotOrigin - Where the shot left the weapon
 	 */
-	void ResetBurstShotCooldown();
+	int32 FindMuzzleIndex(const FVector& ShotOrigin) const;
+
+	/**
+	 * Selects the muzzles of the next trigger event
+	 * @param OutVolley - Receives the firing muzzles and their transforms
+	 *
+	 * @note Advances the alternating cycle
+	 */
+	void GatherMuzzleVolley(FMuzzleVolley& OutVolley);
+
+	/**
+	 * Queues a shot's cosmetic result for remote clients
+	 * @param ShotOrigin - Where the shot left the weapon
+	 * @param ShotEnd - Impact point, or trace end on a miss
+	 * @param bHit - Whether the shot ended on a blocking hit
+	 *
+	 * @note Server only - shots are batched per weapon per frame
+	 * @see FlushShotCosmetics()
+	 */
+	void QueueShotCosmetic(const FVector& ShotOrigin, const FVector& ShotEnd, bool bHit);
+
+	/**
+	 * Replays a replicated shot on a remote client
+	 * @param ShotOrigin - Where the shot left the weapon
+	 * @param ShotEnd - Impact point, or trace end on a miss
+	 * @param bHit - Whether the shot ended on a blocking hit
+	 * @param Seed - Shared variation seed for the shot
+	 *
+	 * @note Base implementation plays muzzle flash, trail and impact effect
+	 * @remark Override for weapons whose shots are not instant
+	 */
+	virtual void PlayShotCosmetic(const FVector& ShotOrigin, const FVector& ShotEnd, bool bHit, uint8 Seed);
+
+	/**
+	 * Delivers one frame of cosmetic shots to every client
+	 * @param Batch - Packed shots fired by this weapon this frame
+	 *
+	 * @note Only used when weapon.Net.ShotInterestManagement is disabled
+	 */
+	UFUNCTION(NetMulticast, Unreliable)
+	void MulticastShotCosmetics(const FShotCosmeticBatch& Batch);
+
+	/**
+	 * Per-shot delivery, only used when weapon.Net.BatchShotCosmetics is disabled
+	 * @param ShotEnd - Impact point, or trace end on a miss
+	 * @param bHit - Whether the shot ended on a blocking hit
+	 * @param Seed - Shared variation seed for the shot
+	 *
+	 * @note Kept to measure batching against one RPC per shot
+	 */
+	UFUNCTION(NetMulticast, Unreliable)
+	void MulticastShotCosmetic(FVector_NetQuantize ShotEnd, bool bHit, uint8 Seed);
+
+	/** Whether replicated shots should be replayed on this machine */
+	bool ShouldPlayRemoteShotCosmetics() const;
+
+	/**
+	 * Returns the fixed-step weapon clock all cooldowns are measured on
+	 *
+	 * @note Falls back to world time without a weapon subsystem
+	 * @see UWeaponSubsystem::GetSimulationTime()
+	 */
+	double GetSimulationTime() const;
+
+	/**
+	 * Tracks trigger holds across attack calls
+	 * @param SimulationTime - Current weapon clock
+	 *
+	 * @note A released trigger must not bank shots for the next pull
+	 */
+	void UpdateTriggerHold(double SimulationTime);
 
 public:
 
@@ -310,6 +521,22 @@ protected:
 	UPROPERTY(EditAnywhere, Category = "Weapon | Configuration")
 	FName WeaponBarrelSocket;
 
+	/** Further muzzles after WeaponBarrelSocket, for turrets and multi-barrel guns */
+	UPROPERTY(EditAnywhere, Category = "Weapon | Configuration")
+	TArray<FName> AdditionalBarrelSockets;
+
+	/** How the muzzles take turns, only relevant with AdditionalBarrelSockets */
+	UPROPERTY(EditAnywhere, Category = "Weapon | Configuration", meta = (EditCondition = "AdditionalBarrelSockets.Num() > 0"))
+	EMuzzleFiringOrder MuzzleFiringOrder = EMuzzleFiringOrder::EMFO_Alternating;
+
+	/** Variant this weapon is configured from at begin play, none to use the values set on the class */
+	UPROPERTY(EditAnywhere, Replicated, Category = "Weapon | Configuration", meta = (AllowedTypes = "WeaponDefinition"))
+	FPrimaryAssetId WeaponDefinitionId;
+
+	/** Definition applied at begin play, kept so its GC cluster stays alive for as long as the weapon */
+	UPROPERTY(Transient)
+	TObjectPtr<const UWeaponDefinition> WeaponDefinition;
+
 private:
 	// ------------------------------
 	// Internal State
@@ -331,13 +558,35 @@ private:
 	UPROPERTY()
 	bool bShouldBurstShotCooldown;
 
-	/** Rate-of-fire timer control */
-	UPROPERTY()
-	FTimerHandle WeaponFireTimer;
+	/** Weapon clock time of the next allowed shot */
+	double NextFireTime = 0.0;
 
-	/** Burst recovery timer control */
-	UPROPERTY()
-	FTimerHandle WeaponBurstCooldownTimer;
+	/** Weapon clock time the current burst cooldown ends */
+	double BurstCooldownEndTime = 0.0;
+
+	/** Weapon clock time of the last attack call */
+	double LastTriggerTime = -UE_DOUBLE_BIG_NUMBER;
+
+	/** Cosmetic shots waiting for the end of frame flush */
+	FShotCosmeticBatch PendingShotCosmetics;
+
+	/** Muzzle socket resolved to its bone, so firing never looks sockets up by name */
+	struct FMuzzle {
+		FName SocketName;
+
+		/** Bone the socket is attached to, INDEX_NONE to fall back to the socket name */
+		int32 BoneIndex = INDEX_NONE;
+
+		/** Socket offset from its bone */
+		FTransform LocalTransform;
+	};
+	TArray<FMuzzle, TInlineAllocator<2>> Muzzles;
+
+	/** Muzzle the next alternating shot leaves from */
+	int32 NextMuzzleIndex = 0;
+
+	/** Sequence number the next queued cosmetic shot is sent with, wrapped to the muzzle cycle and reset by every volley */
+	uint16 NextShotCosmeticSequence = 0;
 
 protected:
 	/** Complete behavior configuration */
@@ -346,8 +595,8 @@ protected:
 
 	// Implementation Notes:
 	// 1. Firing flow: WeaponAttack -> [ModeHandler] -> ExecuteWeaponFire -> ShootWeapon
-	// 2. Visual effects are managed in ShootWeapon
-	// 3. All timing operations use the weapon's configured rates
+	// 2. Visual effects are managed in ShootWeapon, once per trigger event for every muzzle
+	// 3. All timing operations use the weapon's configured rates on the fixed-step weapon clock
 	// 4. State flags prevent illegal firing sequences
 	// 5. Ignored actors list prevents self-collisions
 };
\ No newline at end of file
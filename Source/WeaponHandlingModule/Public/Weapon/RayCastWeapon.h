@@ -63,18 +63,19 @@ protected:
 	/**
 	 * Coordinates complete firing sequence for raycast weapons.
 	 * 
+	 * @param Volley Muzzles firing on this trigger event
 	 * @param IgnoredActors Entities excluded from hit detection
 	 * @param WeaponFireHitResult Output container for hit data
 	 * @param InstigatorController Responsible controller reference
 	 * 
 	 * @note Execution flow:
-	 *       1. Determines trace method (screen/weapon)
-	 *       2. Performs collision detection
-	 *       3. Processes hit/miss results
+	 *       1. One aim trace for the whole volley
+	 *       2. One barrel trace per muzzle, if enabled
+	 *       3. Processes hit/miss results of every pellet
 	 * @see WeaponTrace()
 	 * @see ScreenTrace()
 	 */
-	virtual void ShootWeapon( const TArray<AActor*>& IgnoredActors, FHitResult& WeaponFireHitResult, AController* InstigatorController ) override;
+	virtual void ShootWeapon( const FMuzzleVolley& Volley, const TArray<AActor*>& IgnoredActors, FHitResult& WeaponFireHitResult, AController* InstigatorController ) override;
 
 	/**
 	 * Performs viewport-centered targeting trace.
@@ -85,20 +86,34 @@ protected:
 	 * 
 	 * @note Uses camera perspective for initial targeting
 	 * @remark Typical first-pass for weapon tracing
-	 * @warning Requires active player controller
+	 * @remark Unowned weapons such as sentries aim along their first barrel
 	 */
 	bool ScreenTrace(FHitResult& ScreenTraceHitResult, const TArray<AActor*>& IgnoredActors) const;
 
 	/**
 	 * Executes precise barrel-to-target ballistic trace.
 	 * 
-	 * @param WeaponTraceHitResult Output container for trace results
+	 * @param MuzzleLocation Where the shot leaves the weapon
+	 * @param WeaponTraceHitResult Screen trace hit in, barrel trace hit out
 	 * @param IgnoredActors Entities excluded from detection
 	 * @return True if collision occurred along bullet path
 	 * 
-	 * @note Uses weapon socket as origin for realistic trajectories
-	 * @remark Typically follows screen trace for precision adjustment
-	 * @warning Requires properly named barrel socket
+	 * @note Uses the muzzle as origin for realistic trajectories
+	 * @remark Follows the screen trace shared by every muzzle of a volley
 	 */
-	bool WeaponTrace(FHitResult& WeaponTraceHitResult, const TArray<AActor*>& IgnoredActors) const;
+	bool WeaponTrace(const FVector& MuzzleLocation, FHitResult& WeaponTraceHitResult, const TArray<AActor*>& IgnoredActors) const;
+
+	/**
+	 * Resolves an AI volley with dice rolls when no player can observe it.
+	 * 
+	 * @param NumShots Shots of the volley, each rolled separately
+	 * @param WeaponFireHitResult Output container for the last rolled hit
+	 * @param InstigatorController Responsible controller reference
+	 * @return True if the volley was resolved and must not be traced
+	 * 
+	 * @note Skips traces, effects and shot replication entirely
+	 * @remark Falls back to full simulation the moment a player could see or hear the fight
+	 * @see FAbstractCombatResolver
+	 */
+	bool TryResolveAbstractShot(int32 NumShots, FHitResult& WeaponFireHitResult, AController* InstigatorController);
 };
\ No newline at end of file
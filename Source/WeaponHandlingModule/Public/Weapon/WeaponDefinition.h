@@ -0,0 +1,106 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "Weapon/ProjectileWeapon.h"
+#include "WeaponDefinition.generated.h"
+
+class ARangedWeapon;
+class USkeletalMesh;
+
+/**
+ * How a defined weapon delivers its shots, selecting the native class it is spawned as.
+ */
+UENUM(BlueprintType)
+enum class EWeaponDelivery : uint8 {
+	/** Instant traces, spawned as ARayCastWeapon */
+	EWD_RayCast UMETA(DisplayName = "Ray Cast"),
+
+	/** Simulated rounds, spawned as AProjectileWeapon */
+	EWD_Projectile UMETA(DisplayName = "Projectile")
+};
+
+/**
+ * Everything that distinguishes one weapon variant from another, as data.
+ *
+ * Variants are spawned as one of the native weapon classes and configured from
+ * their definition at begin play, so adding a variant adds a small data asset
+ * instead of a Blueprint class.
+ *
+ * @note Referenced by primary asset ID, so a weapon only loads the definition it uses
+ * @see UWeaponSubsystem::SpawnWeapon() to spawn a variant
+ * @see ARangedWeapon::WeaponDefinitionId to place a variant in a map
+ */
+UCLASS(BlueprintType)
+class WEAPONHANDLINGMODULE_API UWeaponDefinition : public UPrimaryDataAsset {
+	GENERATED_BODY()
+
+public:
+	/** Asset manager type of weapon definitions */
+	static const FPrimaryAssetType PrimaryAssetType;
+
+	/** Asset registry tag holding ComputeSourceHash() as hex */
+	static const FName SourceHashTag;
+
+	virtual FPrimaryAssetId GetPrimaryAssetId() const override;
+
+	/** Adds the source hash, so a cooked database record can be checked without loading the asset */
+	virtual void GetAssetRegistryTags(FAssetRegistryTagsContext Context) const override;
+
+	/**
+	 * Groups the definition with its meshes, effects and sounds into one GC cluster on load.
+	 *
+	 * @note Reachability analysis then visits one cluster per variant instead of every asset
+	 *       for every weapon - only effective in cooked builds, where clusters are created
+	 */
+	virtual bool CanBeClusterRoot() const override;
+
+	/**
+	 * Loads a definition by ID.
+	 *
+	 * @param DefinitionId ID of a weapon definition asset
+	 * @return Loaded definition, null if the ID does not resolve
+	 *
+	 * @note Synchronous - definitions are small, their meshes and effects load with them
+	 */
+	static const UWeaponDefinition* Load(const FPrimaryAssetId& DefinitionId);
+
+	/**
+	 * Hashes every property the definition declares.
+	 *
+	 * @return Hash of the exported property text, stable across runs and platforms
+	 * @note Stored in the cooked database record and in the asset registry tag, which must match
+	 */
+	uint64 ComputeSourceHash() const;
+
+	/** Native class the variant is spawned as */
+	TSubclassOf<ARangedWeapon> GetWeaponClass() const;
+
+	/** Native class spawned for a delivery */
+	static TSubclassOf<ARangedWeapon> GetWeaponClass(EWeaponDelivery Delivery);
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	EWeaponDelivery Delivery = EWeaponDelivery::EWD_RayCast;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	TObjectPtr<USkeletalMesh> WeaponMesh;
+
+	/** Socket shots leave from */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	FName BarrelSocket;
+
+	/** Further muzzles for turrets and multi-barrel guns */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	TArray<FName> AdditionalBarrelSockets;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon", meta = (EditCondition = "AdditionalBarrelSockets.Num() > 0"))
+	EMuzzleFiringOrder MuzzleFiringOrder = EMuzzleFiringOrder::EMFO_Alternating;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon")
+	FWeaponData WeaponData;
+
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = "Weapon", meta = (EditCondition = "Delivery == EWeaponDelivery::EWD_Projectile"))
+	FProjectileData ProjectileData;
+};
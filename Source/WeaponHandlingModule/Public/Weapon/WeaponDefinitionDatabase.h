@@ -0,0 +1,241 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Casts.h"
+#include "UObject/PrimaryAssetId.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+struct FProjectileData;
+struct FWeaponData;
+
+/**
+ * One weapon definition as stored in the cooked database.
+ *
+ * Plain values only. Strings and asset paths are byte offsets into the string
+ * section, socket lists are ranges of the string reference section, so the
+ * record is read straight from the mapped file.
+ *
+ * @note Mirrors UWeaponDefinition - bump FWeaponDefinitionDatabaseHeader::CurrentVersion when either changes
+ */
+struct FCookedWeaponDefinition {
+	/** Offset of the empty string, used for unset names and assets */
+	static constexpr uint32 NoString = 0;
+
+	/** Sort key, see FWeaponDefinitionDatabase::HashName() */
+	uint64 NameHash = 0;
+
+	/** UWeaponDefinition::ComputeSourceHash() of the asset as cooked */
+	uint64 SourceHash = 0;
+
+	/** Asset name of the definition */
+	uint32 Name = NoString;
+
+	/** Soft object paths, resolved when a weapon applies the definition */
+	uint32 WeaponMesh = NoString;
+	uint32 MuzzleFlash = NoString;
+	uint32 BeamTrail = NoString;
+	uint32 ImpactParticle = NoString;
+	uint32 WeaponFireSound = NoString;
+	uint32 ProjectileMesh = NoString;
+	uint32 ProjectileActorClass = NoString;
+
+	uint32 BarrelSocket = NoString;
+
+	/** Range of the string reference section */
+	uint32 FirstAdditionalBarrelSocket = 0;
+	uint32 NumAdditionalBarrelSockets = 0;
+
+	uint8 Delivery = 0;
+	uint8 MuzzleFiringOrder = 0;
+	uint8 FiringMode = 0;
+	uint8 ShotPattern = 0;
+	uint8 MaxBurstShotCount = 0;
+	uint8 bShouldPerformWeaponTraceTest = 0;
+	uint8 Padding[2] = {};
+
+	float WeaponFireRate = 0.0f;
+	float BurstShotCooldown = 0.0f;
+	float WeaponRange = 0.0f;
+	float WeaponDamage = 0.0f;
+	int32 PelletsPerBullet = 0;
+	float MinimumSpreadRange = 0.0f;
+	float MaximumSpreadRange = 0.0f;
+	float NoiseLoudness = 0.0f;
+	float NoiseRange = 0.0f;
+	float ShotAudibleRange = 0.0f;
+	float ShotVisibleRange = 0.0f;
+	float AIAccuracy = 0.0f;
+	int32 CurrentAmmoCount = 0;
+	int32 MaxAmmoCount = 0;
+	int32 CurrentClipCount = 0;
+	int32 MaxClipCount = 0;
+
+	float MuzzleSpeed = 0.0f;
+	float GravityScale = 0.0f;
+	float DragCoefficient = 0.0f;
+	float MaxFlightTime = 0.0f;
+	float ProjectileMeshScale[3] = {};
+	float HomingAcceleration = 0.0f;
+	float HomingRange = 0.0f;
+	float HomingConeAngle = 0.0f;
+	int32 PrewarmedActorCount = 0;
+};
+
+static_assert(sizeof(FCookedWeaponDefinition) % sizeof(uint64) == 0, "Records must stay 8 byte aligned");
+
+/**
+ * On-disk layout of the cooked weapon definition database.
+ *
+ * The file is the header, then the records sorted by name hash, then one
+ * uint32 string offset per string reference, then the NUL terminated UTF-8
+ * string section, which starts with the empty string.
+ */
+struct FWeaponDefinitionDatabaseHeader {
+	static constexpr uint32 ExpectedMagic = 0x46454457; // 'WDEF'
+	static constexpr uint32 CurrentVersion = 2;
+
+	uint32 Magic = ExpectedMagic;
+	uint32 Version = CurrentVersion;
+
+	/** Catches layout changes that forgot the version bump */
+	uint32 RecordSize = sizeof(FCookedWeaponDefinition);
+
+	int32 NumDefinitions = 0;
+	int32 NumStringRefs = 0;
+	uint32 StringsSize = 0;
+
+	FORCEINLINE int64 GetStringRefsOffset() const { return sizeof(FWeaponDefinitionDatabaseHeader) + static_cast<int64>(NumDefinitions) * sizeof(FCookedWeaponDefinition); }
+
+	FORCEINLINE int64 GetStringsOffset() const { return GetStringRefsOffset() + static_cast<int64>(NumStringRefs) * sizeof(uint32); }
+
+	/** Expected file size */
+	FORCEINLINE int64 GetFileSize() const { return GetStringsOffset() + StringsSize; }
+};
+
+static_assert(sizeof(FWeaponDefinitionDatabaseHeader) % sizeof(uint64) == 0, "Records must stay 8 byte aligned");
+
+/**
+ * Memory-mapped table of every weapon definition's tuning.
+ *
+ * Weapons read their definition in place instead of loading the definition
+ * asset. Meshes, effects and sounds stay soft paths and are only loaded for the
+ * definitions a weapon actually applies.
+ *
+ * @note Written by the WeaponDefinitionCook commandlet, mapped at module startup in cooked builds
+ * @warning Only describes definitions as they were when cooked - editor builds read the assets
+ */
+class WEAPONHANDLINGMODULE_API FWeaponDefinitionDatabase {
+public:
+	FWeaponDefinitionDatabase();
+	~FWeaponDefinitionDatabase();
+
+	UE_NONCOPYABLE(FWeaponDefinitionDatabase);
+
+	static FWeaponDefinitionDatabase& Get();
+
+	/** Where the database lives, in a folder staged loose so it can be mapped */
+	static FString GetFilename();
+
+	/**
+	 * Sort key of a definition name.
+	 *
+	 * @param DefinitionName Asset name of the definition
+	 * @note Case insensitive, like FName
+	 */
+	static uint64 HashName(const FString& DefinitionName);
+
+	/**
+	 * Maps the database, if there is one.
+	 *
+	 * @return True if a valid database was mapped
+	 */
+	bool Load();
+
+	/** Unmaps the database */
+	void Reset();
+
+	FORCEINLINE bool IsLoaded() const { return Header != nullptr; }
+
+	/**
+	 * Looks a definition up by ID.
+	 *
+	 * @param DefinitionId Primary asset ID of a UWeaponDefinition
+	 * @return Record in the mapped file, null if not loaded, not cooked, changed since the cook
+	 *         or weapon.Definitions.UseCookedDatabase is off
+	 *
+	 * @note Binary search over the mapped records - nothing is parsed or copied
+	 * @remark The first lookup of each record compares its source hash with the asset registry tag
+	 */
+	const FCookedWeaponDefinition* Find(const FPrimaryAssetId& DefinitionId) const;
+
+	/** Every cooked definition, sorted by name hash */
+	TConstArrayView<FCookedWeaponDefinition> GetDefinitions() const;
+
+	/**
+	 * Reads a string of the string section.
+	 *
+	 * @param Offset String offset stored in a record
+	 * @return View into the mapped file, empty for NoString
+	 */
+	FUtf8StringView GetString(uint32 Offset) const;
+
+	/** Reads one entry of a record's socket list */
+	FName GetStringRef(uint32 Index) const;
+
+	/**
+	 * Fills weapon data from a record.
+	 *
+	 * @param Definition Record of this database
+	 * @param OutWeaponData Receives the tuning, effects and sound are loaded here
+	 */
+	void ResolveWeaponData(const FCookedWeaponDefinition& Definition, FWeaponData& OutWeaponData) const;
+
+	/**
+	 * Fills projectile data from a record.
+	 *
+	 * @param Definition Record of this database
+	 * @param OutProjectileData Receives the ballistics, mesh and actor class are loaded here
+	 * @note An actor class that is not a projectile actor is reported and left unset
+	 */
+	void ResolveProjectileData(const FCookedWeaponDefinition& Definition, FProjectileData& OutProjectileData) const;
+
+	/**
+	 * Loads an asset a record refers to.
+	 *
+	 * @param PathOffset Soft object path stored in a record
+	 * @return Loaded asset, null for NoString or if it does not resolve
+	 *
+	 * @note Synchronous, like UWeaponDefinition::Load()
+	 */
+	template<typename AssetType>
+	AssetType* ResolveAsset(uint32 PathOffset) const {
+		return Cast<AssetType>(ResolveObject(PathOffset));
+	}
+
+private:
+	/** Whether the record was cooked from the asset as it is now */
+	bool IsCurrent(int32 RecordIndex, const FPrimaryAssetId& DefinitionId) const;
+
+	UObject* ResolveObject(uint32 PathOffset) const;
+
+	TUniquePtr<IMappedFileHandle> MappedFile;
+	TUniquePtr<IMappedFileRegion> MappedRegion;
+
+	// Views into the mapped region
+	const FWeaponDefinitionDatabaseHeader* Header = nullptr;
+	const FCookedWeaponDefinition* Records = nullptr;
+	const uint32* StringRefs = nullptr;
+	const UTF8CHAR* Strings = nullptr;
+
+	enum class ERecordState : uint8 {
+		Unchecked,
+		Current,
+		Stale
+	};
+
+	/** Source hash check of every record, indexed like the records */
+	mutable TArray<ERecordState> RecordStates;
+};
@@ -11,4 +11,7 @@ public:
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+private:
+	FDelegateHandle ObjectsReplacedHandle;
 };
\ No newline at end of file
@@ -18,7 +18,10 @@ public class WeaponHandlingModule : ModuleRules
 		PrivateDependencyModuleNames.AddRange(
 			new[]
 			{
-				"EnhancedInput"
+				"EnhancedInput",
+				"AIModule",
+				"Slate",
+				"SlateCore"
 			});
 
 		DynamicallyLoadedModuleNames.AddRange(
@@ -0,0 +1,177 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Commandlets/WeaponDefinitionCookCommandlet.h"
+
+#include "Algo/StableSort.h"
+#include "AssetRegistry/IAssetRegistry.h"
+#include "Misc/FileHelper.h"
+#include "Weapon/WeaponDefinition.h"
+#include "Weapon/WeaponDefinitionDatabase.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogWeaponDefinitionCook, Log, All);
+
+namespace WeaponDefinitionCook {
+	/** Deduplicating builder of the string section */
+	struct FStringSection {
+		FStringSection() {
+			// Offset 0 is the empty string, FCookedWeaponDefinition::NoString
+			Data.Add(0);
+			Offsets.Add(FString(), FCookedWeaponDefinition::NoString);
+		}
+
+		uint32 Add(const FString& Value) {
+			if (const uint32* Offset = Offsets.Find(Value)) {
+				return *Offset;
+			}
+
+			const uint32 Offset = Data.Num();
+			const FTCHARToUTF8 Utf8Value(*Value);
+			Data.Append(reinterpret_cast<const uint8*>(Utf8Value.Get()), Utf8Value.Length());
+			Data.Add(0);
+			Offsets.Add(Value, Offset);
+			return Offset;
+		}
+
+		uint32 Add(const FName Value) {
+			return Value.IsNone() ? FCookedWeaponDefinition::NoString : Add(Value.ToString());
+		}
+
+		uint32 AddAsset(const UObject* Asset) {
+			return Asset ? Add(FSoftObjectPath(Asset).ToString()) : FCookedWeaponDefinition::NoString;
+		}
+
+		TArray<uint8> Data;
+
+		/** Offset of every string added so far */
+		TMap<FString, uint32> Offsets;
+	};
+
+	/** Flattens one definition, appending its strings and socket list */
+	FCookedWeaponDefinition CookDefinition(const UWeaponDefinition& Definition, FStringSection& Strings, TArray<uint32>& StringRefs) {
+		const FWeaponData& WeaponData = Definition.WeaponData;
+		const FProjectileData& ProjectileData = Definition.ProjectileData;
+
+		FCookedWeaponDefinition Cooked;
+		Cooked.NameHash = FWeaponDefinitionDatabase::HashName(Definition.GetName());
+		Cooked.SourceHash = Definition.ComputeSourceHash();
+		Cooked.Name = Strings.Add(Definition.GetName());
+
+		Cooked.WeaponMesh = Strings.AddAsset(Definition.WeaponMesh);
+		Cooked.MuzzleFlash = Strings.AddAsset(WeaponData.MuzzleFlash);
+		Cooked.BeamTrail = Strings.AddAsset(WeaponData.BeamTrail);
+		Cooked.ImpactParticle = Strings.AddAsset(WeaponData.ImpactParticle);
+		Cooked.WeaponFireSound = Strings.AddAsset(WeaponData.WeaponFireSound);
+		Cooked.ProjectileMesh = Strings.AddAsset(ProjectileData.ProjectileMesh);
+		Cooked.ProjectileActorClass = Strings.AddAsset(ProjectileData.ProjectileActorClass.Get());
+
+		Cooked.BarrelSocket = Strings.Add(Definition.BarrelSocket);
+		Cooked.FirstAdditionalBarrelSocket = StringRefs.Num();
+		Cooked.NumAdditionalBarrelSockets = Definition.AdditionalBarrelSockets.Num();
+		for (const FName Socket : Definition.AdditionalBarrelSockets) {
+			StringRefs.Add(Strings.Add(Socket));
+		}
+
+		Cooked.Delivery = static_cast<uint8>(Definition.Delivery);
+		Cooked.MuzzleFiringOrder = static_cast<uint8>(Definition.MuzzleFiringOrder);
+		Cooked.FiringMode = static_cast<uint8>(WeaponData.FiringMode);
+		Cooked.ShotPattern = static_cast<uint8>(WeaponData.ShotPattern);
+		Cooked.MaxBurstShotCount = WeaponData.MaxBurstShotCount;
+		Cooked.bShouldPerformWeaponTraceTest = WeaponData.bShouldPerformWeaponTraceTest ? 1 : 0;
+
+		Cooked.WeaponFireRate = WeaponData.WeaponFireRate;
+		Cooked.BurstShotCooldown = WeaponData.BurstShotCooldown;
+		Cooked.WeaponRange = WeaponData.WeaponRange;
+		Cooked.WeaponDamage = WeaponData.WeaponDamage;
+		Cooked.PelletsPerBullet = WeaponData.PelletsPerBullet;
+		Cooked.MinimumSpreadRange = WeaponData.MinimumSpreadRange;
+		Cooked.MaximumSpreadRange = WeaponData.MaximumSpreadRange;
+		Cooked.NoiseLoudness = WeaponData.NoiseLoudness;
+		Cooked.NoiseRange = WeaponData.NoiseRange;
+		Cooked.ShotAudibleRange = WeaponData.ShotAudibleRange;
+		Cooked.ShotVisibleRange = WeaponData.ShotVisibleRange;
+		Cooked.AIAccuracy = WeaponData.AIAccuracy;
+		Cooked.CurrentAmmoCount = WeaponData.CurrentAmmoCount;
+		Cooked.MaxAmmoCount = WeaponData.MaxAmmoCount;
+		Cooked.CurrentClipCount = WeaponData.CurrentClipCount;
+		Cooked.MaxClipCount = WeaponData.MaxClipCount;
+
+		Cooked.MuzzleSpeed = ProjectileData.MuzzleSpeed;
+		Cooked.GravityScale = ProjectileData.GravityScale;
+		Cooked.DragCoefficient = ProjectileData.DragCoefficient;
+		Cooked.MaxFlightTime = ProjectileData.MaxFlightTime;
+		Cooked.ProjectileMeshScale[0] = ProjectileData.ProjectileMeshScale.X;
+		Cooked.ProjectileMeshScale[1] = ProjectileData.ProjectileMeshScale.Y;
+		Cooked.ProjectileMeshScale[2] = ProjectileData.ProjectileMeshScale.Z;
+		Cooked.HomingAcceleration = ProjectileData.HomingAcceleration;
+		Cooked.HomingRange = ProjectileData.HomingRange;
+		Cooked.HomingConeAngle = ProjectileData.HomingConeAngle;
+		Cooked.PrewarmedActorCount = ProjectileData.PrewarmedActorCount;
+
+		return Cooked;
+	}
+}
+
+
+UWeaponDefinitionCookCommandlet::UWeaponDefinitionCookCommandlet() {
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+
+/**
+ * Loads every definition asset once and writes the sorted records.
+ *
+ * @note Definitions are loaded one at a time and collected in between, so the
+ *       commandlet never holds more than one variant's meshes and effects
+ */
+int32 UWeaponDefinitionCookCommandlet::Main(const FString& Params) {
+	IAssetRegistry& AssetRegistry = IAssetRegistry::GetChecked();
+	AssetRegistry.SearchAllAssets(true);
+
+	TArray<FAssetData> DefinitionAssets;
+	AssetRegistry.GetAssetsByClass(UWeaponDefinition::StaticClass()->GetClassPathName(), DefinitionAssets, true);
+
+	WeaponDefinitionCook::FStringSection Strings;
+	TArray<uint32> StringRefs;
+	TArray<FCookedWeaponDefinition> Records;
+	Records.Reserve(DefinitionAssets.Num());
+
+	int32 NumFailed = 0;
+	for (const FAssetData& DefinitionAsset : DefinitionAssets) {
+		const UWeaponDefinition* Definition = Cast<UWeaponDefinition>(DefinitionAsset.GetAsset());
+		if (!Definition) {
+			UE_LOG(LogWeaponDefinitionCook, Error, TEXT("Could not load %s"), *DefinitionAsset.GetObjectPathString());
+			++NumFailed;
+			continue;
+		}
+
+		Records.Add(WeaponDefinitionCook::CookDefinition(*Definition, Strings, StringRefs));
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+
+	// Stable so definitions sharing a hash keep a deterministic order between runs
+	Algo::StableSortBy(Records, &FCookedWeaponDefinition::NameHash);
+
+	FWeaponDefinitionDatabaseHeader Header;
+	Header.NumDefinitions = Records.Num();
+	Header.NumStringRefs = StringRefs.Num();
+	Header.StringsSize = Strings.Data.Num();
+
+	TArray<uint8> FileData;
+	FileData.SetNumZeroed(Header.GetFileSize());
+	FMemory::Memcpy(FileData.GetData(), &Header, sizeof(Header));
+	FMemory::Memcpy(FileData.GetData() + sizeof(Header), Records.GetData(), Records.Num() * sizeof(FCookedWeaponDefinition));
+	FMemory::Memcpy(FileData.GetData() + Header.GetStringRefsOffset(), StringRefs.GetData(), StringRefs.Num() * sizeof(uint32));
+	FMemory::Memcpy(FileData.GetData() + Header.GetStringsOffset(), Strings.Data.GetData(), Strings.Data.Num());
+
+	const FString Filename = FWeaponDefinitionDatabase::GetFilename();
+	if (!FFileHelper::SaveArrayToFile(FileData, *Filename)) {
+		UE_LOG(LogWeaponDefinitionCook, Error, TEXT("Could not write %s"), *Filename);
+		return 1;
+	}
+
+	UE_LOG(LogWeaponDefinitionCook, Display, TEXT("Cooked %s: %d definitions, %d bytes"), *Filename, Records.Num(), FileData.Num());
+	return NumFailed == 0 ? 0 : 1;
+}
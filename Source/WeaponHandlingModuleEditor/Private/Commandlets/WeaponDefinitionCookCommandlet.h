@@ -0,0 +1,25 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "WeaponDefinitionCookCommandlet.generated.h"
+
+/**
+ * Writes every weapon definition into the flat database cooked builds map at startup.
+ *
+ * Usage: -run=WeaponDefinitionCook
+ *
+ * @note Writes FWeaponDefinitionDatabase::GetFilename() - run it before cooking
+ * @warning Definitions edited afterwards are only picked up by the next run
+ */
+UCLASS()
+class UWeaponDefinitionCookCommandlet : public UCommandlet {
+	GENERATED_BODY()
+
+public:
+	UWeaponDefinitionCookCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,225 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Commandlets/WeaponOccupancyBakeCommandlet.h"
+
+#include "EngineUtils.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/LevelStreaming.h"
+#include "Engine/World.h"
+#include "Misc/FileHelper.h"
+#include "Projectile/StaticOccupancyGrid.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogWeaponOccupancyBake, Log, All);
+
+namespace WeaponOccupancyBake {
+	// Cells are grown by this much when tested so geometry on a boundary marks both neighbors (cm)
+	constexpr float CellMargin = 1.0f;
+
+	// Refuse grids that would not fit comfortably in memory
+	constexpr int64 MaxBricks = 16 * 1024 * 1024;
+}
+
+
+UWeaponOccupancyBakeCommandlet::UWeaponOccupancyBakeCommandlet() {
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+
+int32 UWeaponOccupancyBakeCommandlet::Main(const FString& Params) {
+	FString MapList;
+	if (!FParse::Value(*Params, TEXT("Map="), MapList)) {
+		UE_LOG(LogWeaponOccupancyBake, Error, TEXT("Usage: -run=WeaponOccupancyBake -Map=/Game/Maps/A[+/Game/Maps/B] [-CellSize=200]"));
+		return 1;
+	}
+
+	float CellSize = 200.0f;
+	FParse::Value(*Params, TEXT("CellSize="), CellSize);
+	if (CellSize <= 0.0f) {
+		UE_LOG(LogWeaponOccupancyBake, Error, TEXT("CellSize must be positive"));
+		return 1;
+	}
+
+	TArray<FString> MapPackageNames;
+	MapList.ParseIntoArray(MapPackageNames, TEXT("+"));
+
+	int32 NumFailed = 0;
+	for (const FString& MapPackageName : MapPackageNames) {
+		if (!BakeMap(MapPackageName, CellSize)) {
+			++NumFailed;
+		}
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+
+	return NumFailed == 0 ? 0 : 1;
+}
+
+
+/**
+ * Rejects whole bricks with one overlap before testing their cells.
+ *
+ * @note Open air is the common case, so most of the map costs one query per 512 cells
+ */
+bool UWeaponOccupancyBakeCommandlet::BakeMap(const FString& MapPackageName, float CellSize) const {
+	UPackage* Package = LoadPackage(nullptr, *MapPackageName, LOAD_None);
+	UWorld* World = Package ? UWorld::FindWorldInPackage(Package) : nullptr;
+	if (!World) {
+		UE_LOG(LogWeaponOccupancyBake, Error, TEXT("%s is not a map"), *MapPackageName);
+		return false;
+	}
+
+	World->AddToRoot();
+	World->WorldType = EWorldType::Editor;
+
+	const bool bInitializedWorld = !World->bIsWorldInitialized;
+	if (bInitializedWorld) {
+		World->InitWorld(UWorld::InitializationValues()
+			.AllowAudioPlayback(false)
+			.CreatePhysicsScene(true)
+			.RequiresHitProxies(false)
+			.CreateNavigation(false)
+			.CreateAISystem(false)
+			.ShouldSimulatePhysics(false)
+			.SetTransactional(false));
+	}
+
+	ON_SCOPE_EXIT {
+		if (bInitializedWorld) {
+			World->CleanupWorld();
+		}
+		World->RemoveFromRoot();
+	};
+
+	// Cells are streamed in at runtime - a grid of the persistent level alone would free space that is not free
+	if (World->IsPartitionedWorld()) {
+		UE_LOG(LogWeaponOccupancyBake, Error, TEXT("%s uses World Partition, which is not supported - not baked"), *MapPackageName);
+		return false;
+	}
+
+	if (!LoadStreamingLevels(World)) {
+		UE_LOG(LogWeaponOccupancyBake, Error, TEXT("%s has streaming levels that could not be loaded - not baked"), *MapPackageName);
+		return false;
+	}
+	World->UpdateWorldComponents(true, false);
+
+	// Only what the runtime skips needs to be baked
+	FBox StaticBounds(ForceInit);
+	for (TActorIterator<AActor> ActorIt(World); ActorIt; ++ActorIt) {
+		ActorIt->ForEachComponent<UPrimitiveComponent>(false, [&StaticBounds](const UPrimitiveComponent* Primitive) {
+			if (Primitive->IsRegistered() && Primitive->IsCollisionEnabled() && Primitive->GetCollisionObjectType() == ECC_WorldStatic) {
+				StaticBounds += Primitive->Bounds.GetBox();
+			}
+		});
+	}
+
+	if (!StaticBounds.IsValid) {
+		UE_LOG(LogWeaponOccupancyBake, Warning, TEXT("%s has no static collision, nothing baked"), *MapPackageName);
+		return false;
+	}
+
+	constexpr int32 BrickSize = FStaticOccupancyHeader::BrickSize;
+	const float BrickWorldSize = CellSize * BrickSize;
+	StaticBounds = StaticBounds.ExpandBy(CellSize);
+
+	FStaticOccupancyHeader Header;
+	Header.OriginX = StaticBounds.Min.X;
+	Header.OriginY = StaticBounds.Min.Y;
+	Header.OriginZ = StaticBounds.Min.Z;
+	Header.CellSize = CellSize;
+	Header.NumBricksX = FMath::CeilToInt32(StaticBounds.GetSize().X / BrickWorldSize);
+	Header.NumBricksY = FMath::CeilToInt32(StaticBounds.GetSize().Y / BrickWorldSize);
+	Header.NumBricksZ = FMath::CeilToInt32(StaticBounds.GetSize().Z / BrickWorldSize);
+
+	if (static_cast<int64>(Header.NumBricksX) * Header.NumBricksY * Header.NumBricksZ > WeaponOccupancyBake::MaxBricks) {
+		UE_LOG(LogWeaponOccupancyBake, Error, TEXT("%s needs %d x %d x %d bricks, raise CellSize"), *MapPackageName, Header.NumBricksX, Header.NumBricksY, Header.NumBricksZ);
+		return false;
+	}
+
+	const FVector Origin = StaticBounds.Min;
+	const FCollisionObjectQueryParams StaticObjectParams(ECC_WorldStatic);
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(WeaponOccupancyBake), false);
+	const FCollisionShape BrickShape = FCollisionShape::MakeBox(FVector(BrickWorldSize * 0.5f + WeaponOccupancyBake::CellMargin));
+	const FCollisionShape CellShape = FCollisionShape::MakeBox(FVector(CellSize * 0.5f + WeaponOccupancyBake::CellMargin));
+
+	TArray<uint32> BrickTable;
+	BrickTable.SetNumZeroed(Header.GetNumBricks());
+	TArray<uint64> BrickWords;
+
+	for (int32 BrickZ = 0; BrickZ < Header.NumBricksZ; ++BrickZ) {
+		for (int32 BrickY = 0; BrickY < Header.NumBricksY; ++BrickY) {
+			for (int32 BrickX = 0; BrickX < Header.NumBricksX; ++BrickX) {
+				const FVector BrickMin = Origin + FVector(BrickX, BrickY, BrickZ) * BrickWorldSize;
+				const int32 BrickIndex = (BrickZ * Header.NumBricksY + BrickY) * Header.NumBricksX + BrickX;
+
+				if (!World->OverlapAnyTestByObjectType(BrickMin + FVector(BrickWorldSize * 0.5f), FQuat::Identity, StaticObjectParams, BrickShape, QueryParams)) {
+					BrickTable[BrickIndex] = FStaticOccupancyHeader::EmptyBrick;
+					continue;
+				}
+
+				uint64 Words[FStaticOccupancyHeader::WordsPerBrick] = {};
+				int32 NumOccupied = 0;
+
+				for (int32 BitIndex = 0; BitIndex < BrickSize * BrickSize * BrickSize; ++BitIndex) {
+					const FVector CellCenter = BrickMin + (FVector(BitIndex % BrickSize, (BitIndex / BrickSize) % BrickSize, BitIndex / (BrickSize * BrickSize)) + 0.5) * CellSize;
+					if (World->OverlapAnyTestByObjectType(CellCenter, FQuat::Identity, StaticObjectParams, CellShape, QueryParams)) {
+						Words[BitIndex / 64] |= uint64(1) << (BitIndex % 64);
+						++NumOccupied;
+					}
+				}
+
+				if (NumOccupied == 0) {
+					BrickTable[BrickIndex] = FStaticOccupancyHeader::EmptyBrick;
+				} else if (NumOccupied == BrickSize * BrickSize * BrickSize) {
+					BrickTable[BrickIndex] = FStaticOccupancyHeader::FullBrick;
+				} else {
+					BrickTable[BrickIndex] = FStaticOccupancyHeader::FirstStoredBrick + Header.NumStoredBricks++;
+					BrickWords.Append(Words, FStaticOccupancyHeader::WordsPerBrick);
+				}
+			}
+		}
+	}
+
+	TArray<uint8> FileData;
+	FileData.SetNumZeroed(Header.GetFileSize());
+	FMemory::Memcpy(FileData.GetData(), &Header, sizeof(Header));
+	FMemory::Memcpy(FileData.GetData() + sizeof(Header), BrickTable.GetData(), BrickTable.Num() * sizeof(uint32));
+	FMemory::Memcpy(FileData.GetData() + Header.GetBrickDataOffset(), BrickWords.GetData(), BrickWords.Num() * sizeof(uint64));
+
+	const FString Filename = FStaticOccupancyGrid::GetFilename(MapPackageName);
+	if (!FFileHelper::SaveArrayToFile(FileData, *Filename)) {
+		UE_LOG(LogWeaponOccupancyBake, Error, TEXT("Could not write %s"), *Filename);
+		return false;
+	}
+
+	UE_LOG(LogWeaponOccupancyBake, Display, TEXT("Baked %s: %d bricks, %d stored, %d bytes"), *Filename, Header.GetNumBricks(), Header.NumStoredBricks, FileData.Num());
+	return true;
+}
+
+
+/**
+ * Streams in every sublevel, whatever its streaming method.
+ *
+ * @note Static collision in any sublevel may be present at runtime, so all of it is baked
+ */
+bool UWeaponOccupancyBakeCommandlet::LoadStreamingLevels(UWorld* World) const {
+	for (ULevelStreaming* StreamingLevel : World->GetStreamingLevels()) {
+		if (StreamingLevel) {
+			StreamingLevel->SetShouldBeLoaded(true);
+			StreamingLevel->SetShouldBeVisible(true);
+		}
+	}
+	World->FlushLevelStreaming(EFlushLevelStreamingType::Full);
+
+	bool bAllLoaded = true;
+	for (const ULevelStreaming* StreamingLevel : World->GetStreamingLevels()) {
+		if (StreamingLevel && (!StreamingLevel->GetLoadedLevel() || !StreamingLevel->GetLoadedLevel()->bIsVisible)) {
+			UE_LOG(LogWeaponOccupancyBake, Error, TEXT("Could not load %s"), *StreamingLevel->GetWorldAssetPackageName());
+			bAllLoaded = false;
+		}
+	}
+
+	UE_LOG(LogWeaponOccupancyBake, Display, TEXT("Loaded %d streaming levels"), World->GetStreamingLevels().Num());
+	return bAllLoaded;
+}
@@ -0,0 +1,45 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "WeaponOccupancyBakeCommandlet.generated.h"
+
+class UWorld;
+
+/**
+ * Bakes the static collision occupancy grid projectiles use to skip sweeps.
+ *
+ * Usage: -run=WeaponOccupancyBake -Map=/Game/Maps/A[+/Game/Maps/B] [-CellSize=200]
+ *
+ * @note Writes one .wocc file next to each map package, see FStaticOccupancyGrid
+ * @note The persistent level and every streaming level are baked together
+ * @warning World Partition maps are refused - rebake after moving static geometry
+ */
+UCLASS()
+class UWeaponOccupancyBakeCommandlet : public UCommandlet {
+	GENERATED_BODY()
+
+public:
+	UWeaponOccupancyBakeCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/**
+	 * Loads a map, tests every cell against its static collision and writes the grid.
+	 *
+	 * @param MapPackageName Long package name of the map
+	 * @param CellSize Edge length of a cell (cm)
+	 * @return True if the grid was written
+	 */
+	bool BakeMap(const FString& MapPackageName, float CellSize) const;
+
+	/**
+	 * Loads and shows every streaming level of a map.
+	 *
+	 * @return False if any of them did not load, the grid would have holes
+	 */
+	bool LoadStreamingLevels(UWorld* World) const;
+};
@@ -0,0 +1,52 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RewindDebugger/WeaponShotRewindDebuggerExtension.h"
+
+#include "DrawDebugHelpers.h"
+#include "IRewindDebugger.h"
+#include "Trace/WeaponShotProvider.h"
+#include "TraceServices/Model/AnalysisSession.h"
+
+static TAutoConsoleVariable<float> CVarWeaponShotDrawWindow(
+	TEXT("weapon.Debug.RewindShotDrawWindow"),
+	0.25f,
+	TEXT("Seconds of recorded shots drawn before the Rewind Debugger scrub position."));
+
+
+/**
+ * Draws every weapon's shots from the last draw window before the scrub position.
+ */
+void FWeaponShotRewindDebuggerExtension::Update(float DeltaTime, IRewindDebugger* RewindDebugger) {
+	if (RewindDebugger->IsPIESimulating()) {
+		return;
+	}
+
+	const TraceServices::IAnalysisSession* Session = RewindDebugger->GetAnalysisSession();
+	const UWorld* World = RewindDebugger->GetWorldToVisualize();
+	if (!Session || !World) {
+		return;
+	}
+
+	TraceServices::FAnalysisSessionReadScope ReadScope(*Session);
+	const FWeaponShotProvider* Provider = Session->ReadProvider<FWeaponShotProvider>(FWeaponShotProvider::ProviderName);
+	if (!Provider) {
+		return;
+	}
+
+	const double EndTime = RewindDebugger->CurrentTraceTime();
+	const double StartTime = EndTime - CVarWeaponShotDrawWindow.GetValueOnGameThread();
+
+	Provider->EnumerateWeapons([Provider, World, StartTime, EndTime](uint64 WeaponId) {
+		Provider->EnumerateShots(WeaponId, StartTime, EndTime, [World](const FWeaponShotRecord& Shot) {
+			DrawDebugLine(World, Shot.AimStart, Shot.AimEnd, FColor::Blue);
+			DrawDebugCoordinateSystem(World, Shot.MuzzleLocation, Shot.MuzzleRotation, 10.0f);
+		});
+
+		Provider->EnumeratePellets(WeaponId, StartTime, EndTime, [World](const FWeaponPelletRecord& Pellet) {
+			DrawDebugLine(World, Pellet.Start, Pellet.HitLocation, Pellet.bHit ? FColor::Green : FColor::Silver);
+			if (Pellet.bHit) {
+				DrawDebugPoint(World, Pellet.HitLocation, 8.0f, FColor::Red);
+			}
+		});
+	});
+}
@@ -0,0 +1,16 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IRewindDebuggerExtension.h"
+
+/**
+ * Draws recorded aim rays and pellets in the viewport while scrubbing a recording.
+ *
+ * @note Only draws when the game is not running, so live debug drawing is not doubled
+ */
+class FWeaponShotRewindDebuggerExtension : public IRewindDebuggerExtension {
+public:
+	virtual void Update(float DeltaTime, IRewindDebugger* RewindDebugger) override;
+};
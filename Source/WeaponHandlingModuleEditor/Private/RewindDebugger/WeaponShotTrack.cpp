@@ -0,0 +1,170 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "RewindDebugger/WeaponShotTrack.h"
+
+#include "IRewindDebugger.h"
+#include "Trace/WeaponShotProvider.h"
+#include "TraceServices/Model/AnalysisSession.h"
+#include "Widgets/Text/STextBlock.h"
+
+#define LOCTEXT_NAMESPACE "WeaponShotTrack"
+
+namespace WeaponShotTrack {
+	const FName TrackName(TEXT("WeaponShots"));
+
+	const FLinearColor ShotColor(0.2f, 0.5f, 1.0f);
+	const FLinearColor HitColor(0.1f, 0.9f, 0.2f);
+	const FLinearColor MissColor(0.5f, 0.5f, 0.5f);
+
+	/** Provider of the session the Rewind Debugger is showing, read scope must be held */
+	const FWeaponShotProvider* GetProvider(const TraceServices::IAnalysisSession* Session) {
+		return Session ? Session->ReadProvider<FWeaponShotProvider>(FWeaponShotProvider::ProviderName) : nullptr;
+	}
+}
+
+
+FWeaponShotTrack::FWeaponShotTrack(uint64 InObjectId) : ObjectId(InObjectId), EventData(MakeShared<SEventTimelineView::FTimelineEventData>()) {}
+
+
+/**
+ * Rebuilds the timeline events when new trace data arrived.
+ *
+ * @return False - this track has no children to add or remove
+ */
+bool FWeaponShotTrack::UpdateInternal() {
+	const IRewindDebugger* RewindDebugger = IRewindDebugger::Instance();
+	const TraceServices::IAnalysisSession* Session = RewindDebugger->GetAnalysisSession();
+	if (!Session) {
+		return false;
+	}
+
+	const TRange<double> TraceRange = RewindDebugger->GetCurrentTraceRange();
+	const double EndTime = TraceRange.GetUpperBoundValue();
+	if (EndTime == EventDataEndTime) {
+		return false;
+	}
+	EventDataEndTime = EndTime;
+
+	TraceServices::FAnalysisSessionReadScope ReadScope(*Session);
+	const FWeaponShotProvider* Provider = WeaponShotTrack::GetProvider(Session);
+	if (!Provider) {
+		return false;
+	}
+
+	EventData->Points.Reset();
+	EventData->Windows.Reset();
+
+	const double StartTime = TraceRange.GetLowerBoundValue();
+	Provider->EnumerateShots(ObjectId, StartTime, EndTime, [this](const FWeaponShotRecord& Shot) {
+		EventData->Points.Add({ Shot.Time, LOCTEXT("ShotType", "Shot"), FText::Format(LOCTEXT("ShotDescription", "{0} pellet(s)"), Shot.NumPellets), WeaponShotTrack::ShotColor });
+	});
+
+	Provider->EnumeratePellets(ObjectId, StartTime, EndTime, [this](const FWeaponPelletRecord& Pellet) {
+		EventData->Points.Add({
+			Pellet.Time,
+			Pellet.bHit ? LOCTEXT("HitType", "Hit") : LOCTEXT("MissType", "Miss"),
+			FText::FromString(Pellet.HitLocation.ToCompactString()),
+			Pellet.bHit ? WeaponShotTrack::HitColor : WeaponShotTrack::MissColor
+		});
+	});
+
+	return false;
+}
+
+
+TSharedPtr<SWidget> FWeaponShotTrack::GetTimelineViewInternal() {
+	return SNew(SEventTimelineView)
+		.ViewRange_Lambda([]() { return IRewindDebugger::Instance()->GetCurrentViewRange(); })
+		.EventData_Raw(this, &FWeaponShotTrack::GetEventData);
+}
+
+
+TSharedPtr<SWidget> FWeaponShotTrack::GetDetailsViewInternal() {
+	return SNew(STextBlock)
+		.Text_Raw(this, &FWeaponShotTrack::GetDetailsText);
+}
+
+
+/**
+ * Lists muzzle, aim ray and cooldown state of the last shot before the scrub position.
+ */
+FText FWeaponShotTrack::GetDetailsText() const {
+	const IRewindDebugger* RewindDebugger = IRewindDebugger::Instance();
+	const TraceServices::IAnalysisSession* Session = RewindDebugger->GetAnalysisSession();
+	if (!Session) {
+		return FText::GetEmpty();
+	}
+
+	TraceServices::FAnalysisSessionReadScope ReadScope(*Session);
+	const FWeaponShotProvider* Provider = WeaponShotTrack::GetProvider(Session);
+	const FWeaponShotRecord* Shot = Provider ? Provider->FindShotAtTime(ObjectId, RewindDebugger->CurrentTraceTime()) : nullptr;
+	if (!Shot) {
+		return LOCTEXT("NoShot", "No shot before the current time");
+	}
+
+	FFormatNamedArguments Arguments;
+	Arguments.Add(TEXT("Time"), FText::AsNumber(Shot->RecordingTime));
+	Arguments.Add(TEXT("Muzzle"), FText::FromString(Shot->MuzzleLocation.ToCompactString()));
+	Arguments.Add(TEXT("MuzzleRotation"), FText::FromString(Shot->MuzzleRotation.ToCompactString()));
+	Arguments.Add(TEXT("AimStart"), FText::FromString(Shot->AimStart.ToCompactString()));
+	Arguments.Add(TEXT("AimEnd"), FText::FromString(Shot->AimEnd.ToCompactString()));
+	Arguments.Add(TEXT("FiringMode"), Shot->FiringMode);
+	Arguments.Add(TEXT("BurstShotCount"), Shot->BurstShotCount);
+	Arguments.Add(TEXT("BurstCooldown"), Shot->bBurstCooldown ? LOCTEXT("Yes", "yes") : LOCTEXT("No", "no"));
+	Arguments.Add(TEXT("FireInterval"), FText::AsNumber(Shot->FireInterval));
+	Arguments.Add(TEXT("NumPellets"), Shot->NumPellets);
+
+	return FText::Format(LOCTEXT("ShotDetails",
+		"World time: {Time} s\nMuzzle: {Muzzle} {MuzzleRotation}\nAim ray: {AimStart} -> {AimEnd}\n"
+		"Firing mode: {FiringMode}\nBurst shots: {BurstShotCount}\nBurst cooldown: {BurstCooldown}\nFire interval: {FireInterval} s\nPellets: {NumPellets}"),
+		Arguments);
+}
+
+
+FSlateIcon FWeaponShotTrack::GetIconInternal() {
+	return FSlateIcon();
+}
+
+
+FName FWeaponShotTrack::GetNameInternal() const {
+	return WeaponShotTrack::TrackName;
+}
+
+
+FText FWeaponShotTrack::GetDisplayNameInternal() const {
+	return LOCTEXT("TrackDisplayName", "Weapon Shots");
+}
+
+
+FName FWeaponShotTrackCreator::GetTargetTypeNameInternal() const {
+	return TEXT("RangedWeapon");
+}
+
+
+FName FWeaponShotTrackCreator::GetNameInternal() const {
+	return WeaponShotTrack::TrackName;
+}
+
+
+void FWeaponShotTrackCreator::GetTrackTypesInternal(TArray<RewindDebugger::FRewindDebuggerTrackType>& Types) const {
+	Types.Add({ WeaponShotTrack::TrackName, LOCTEXT("TrackDisplayName", "Weapon Shots") });
+}
+
+
+TSharedPtr<RewindDebugger::FRewindDebuggerTrack> FWeaponShotTrackCreator::CreateTrackInternal(uint64 ObjectId) const {
+	return MakeShared<FWeaponShotTrack>(ObjectId);
+}
+
+
+bool FWeaponShotTrackCreator::HasDebugInfoInternal(uint64 ObjectId) const {
+	const TraceServices::IAnalysisSession* Session = IRewindDebugger::Instance()->GetAnalysisSession();
+	if (!Session) {
+		return false;
+	}
+
+	TraceServices::FAnalysisSessionReadScope ReadScope(*Session);
+	const FWeaponShotProvider* Provider = WeaponShotTrack::GetProvider(Session);
+	return Provider && Provider->HasData(ObjectId);
+}
+
+#undef LOCTEXT_NAMESPACE
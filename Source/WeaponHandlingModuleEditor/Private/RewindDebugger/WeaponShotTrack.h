@@ -0,0 +1,52 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "IRewindDebuggerTrackCreator.h"
+#include "RewindDebuggerTrack.h"
+#include "SEventTimelineView.h"
+
+/**
+ * Rewind Debugger track showing every shot and pellet of one weapon.
+ *
+ * Shots appear as events on the timeline, pellets as green hits or grey misses.
+ * The details panel shows the last shot at the scrub position.
+ */
+class FWeaponShotTrack : public RewindDebugger::FRewindDebuggerTrack {
+public:
+	explicit FWeaponShotTrack(uint64 InObjectId);
+
+private:
+	virtual bool UpdateInternal() override;
+	virtual TSharedPtr<SWidget> GetTimelineViewInternal() override;
+	virtual TSharedPtr<SWidget> GetDetailsViewInternal() override;
+	virtual FSlateIcon GetIconInternal() override;
+	virtual FName GetNameInternal() const override;
+	virtual FText GetDisplayNameInternal() const override;
+	virtual uint64 GetObjectIdInternal() const override { return ObjectId; }
+
+	TSharedPtr<SEventTimelineView::FTimelineEventData> GetEventData() const { return EventData; }
+
+	/** Describes the last shot at the current scrub position */
+	FText GetDetailsText() const;
+
+	uint64 ObjectId;
+
+	TSharedPtr<SEventTimelineView::FTimelineEventData> EventData;
+
+	/** Trace range EventData was built for */
+	double EventDataEndTime = -1.0;
+};
+
+/**
+ * Adds an FWeaponShotTrack under every traced ARangedWeapon with recorded shots.
+ */
+class FWeaponShotTrackCreator : public RewindDebugger::IRewindDebuggerTrackCreator {
+private:
+	virtual FName GetTargetTypeNameInternal() const override;
+	virtual FName GetNameInternal() const override;
+	virtual void GetTrackTypesInternal(TArray<RewindDebugger::FRewindDebuggerTrackType>& Types) const override;
+	virtual TSharedPtr<RewindDebugger::FRewindDebuggerTrack> CreateTrackInternal(uint64 ObjectId) const override;
+	virtual bool HasDebugInfoInternal(uint64 ObjectId) const override;
+};
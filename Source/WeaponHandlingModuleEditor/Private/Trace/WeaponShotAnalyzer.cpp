@@ -0,0 +1,81 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Trace/WeaponShotAnalyzer.h"
+
+#include "Trace/WeaponShotProvider.h"
+#include "TraceServices/Model/AnalysisSession.h"
+
+namespace WeaponShotAnalyzer {
+	/** Reads three floats starting at Offset, zero if the array is shorter */
+	FVector ReadVector(const TArrayView<const float>& Values, int32 Offset) {
+		if (Values.Num() < Offset + 3) {
+			return FVector::ZeroVector;
+		}
+		return FVector(Values[Offset], Values[Offset + 1], Values[Offset + 2]);
+	}
+}
+
+
+FWeaponShotAnalyzer::FWeaponShotAnalyzer(TraceServices::IAnalysisSession& InSession, FWeaponShotProvider& InProvider) : Session(InSession), Provider(InProvider) {}
+
+
+void FWeaponShotAnalyzer::OnAnalysisBegin(const FOnAnalysisContext& Context) {
+	FInterfaceBuilder& Builder = Context.InterfaceBuilder;
+	Builder.RouteEvent(RouteId_Shot, "WeaponShot", "Shot");
+	Builder.RouteEvent(RouteId_Pellet, "WeaponShot", "Pellet");
+}
+
+
+bool FWeaponShotAnalyzer::OnEvent(uint16 RouteId, EStyle Style, const FOnEventContext& Context) {
+	TraceServices::FAnalysisSessionEditScope EditScope(Session);
+
+	const FEventData& EventData = Context.EventData;
+	const double Time = Context.EventTime.AsSeconds(EventData.GetValue<uint64>("Cycle"));
+	const uint64 WeaponId = EventData.GetValue<uint64>("WeaponId");
+
+	switch (RouteId) {
+		case RouteId_Shot: {
+			const TArrayView<const float> Muzzle = EventData.GetArrayView<float>("Muzzle");
+			const TArrayView<const float> AimRay = EventData.GetArrayView<float>("AimRay");
+
+			FWeaponShotRecord Shot;
+			Shot.Time = Time;
+			Shot.RecordingTime = EventData.GetValue<double>("RecordingTime");
+			Shot.InstigatorId = EventData.GetValue<uint64>("InstigatorId");
+			Shot.MuzzleLocation = WeaponShotAnalyzer::ReadVector(Muzzle, 0);
+			const FVector MuzzleRotation = WeaponShotAnalyzer::ReadVector(Muzzle, 3);
+			Shot.MuzzleRotation = FRotator(MuzzleRotation.X, MuzzleRotation.Y, MuzzleRotation.Z);
+			Shot.AimStart = WeaponShotAnalyzer::ReadVector(AimRay, 0);
+			Shot.AimEnd = WeaponShotAnalyzer::ReadVector(AimRay, 3);
+			Shot.FireInterval = EventData.GetValue<float>("FireInterval");
+			Shot.NumPellets = EventData.GetValue<uint16>("NumPellets");
+			Shot.FiringMode = EventData.GetValue<uint8>("FiringMode");
+			Shot.BurstShotCount = EventData.GetValue<uint8>("BurstShotCount");
+			Shot.bBurstCooldown = EventData.GetValue<bool>("bBurstCooldown");
+
+			Provider.AppendShot(WeaponId, Shot);
+			break;
+		}
+
+		case RouteId_Pellet: {
+			const TArrayView<const float> Ray = EventData.GetArrayView<float>("Ray");
+
+			FWeaponPelletRecord Pellet;
+			Pellet.Time = Time;
+			Pellet.RecordingTime = EventData.GetValue<double>("RecordingTime");
+			Pellet.HitActorId = EventData.GetValue<uint64>("HitActorId");
+			Pellet.Start = WeaponShotAnalyzer::ReadVector(Ray, 0);
+			Pellet.End = WeaponShotAnalyzer::ReadVector(Ray, 3);
+			Pellet.HitLocation = WeaponShotAnalyzer::ReadVector(EventData.GetArrayView<float>("HitLocation"), 0);
+			Pellet.bHit = EventData.GetValue<bool>("bHit");
+
+			Provider.AppendPellet(WeaponId, Pellet);
+			break;
+		}
+
+		default:
+			break;
+	}
+
+	return true;
+}
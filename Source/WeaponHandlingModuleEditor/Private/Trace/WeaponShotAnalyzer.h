@@ -0,0 +1,34 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Trace/Analyzer.h"
+
+class FWeaponShotProvider;
+
+namespace TraceServices {
+	class IAnalysisSession;
+}
+
+/**
+ * Routes WeaponShot trace events into FWeaponShotProvider.
+ */
+class FWeaponShotAnalyzer : public UE::Trace::IAnalyzer {
+public:
+	FWeaponShotAnalyzer(TraceServices::IAnalysisSession& InSession, FWeaponShotProvider& InProvider);
+
+	virtual void OnAnalysisBegin(const FOnAnalysisContext& Context) override;
+
+	virtual bool OnEvent(uint16 RouteId, EStyle Style, const FOnEventContext& Context) override;
+
+private:
+	enum : uint16 {
+		RouteId_Shot,
+		RouteId_Pellet
+	};
+
+	TraceServices::IAnalysisSession& Session;
+
+	FWeaponShotProvider& Provider;
+};
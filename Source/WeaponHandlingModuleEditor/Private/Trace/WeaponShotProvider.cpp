@@ -0,0 +1,75 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Trace/WeaponShotProvider.h"
+
+#include "Algo/BinarySearch.h"
+
+const FName FWeaponShotProvider::ProviderName(TEXT("WeaponShotProvider"));
+
+namespace WeaponShotProvider {
+	/** Calls Callback for records with Time in [StartTime, EndTime] of a time sorted array */
+	template<typename RecordType>
+	void EnumerateRange(const TArray<RecordType>& Records, double StartTime, double EndTime, TFunctionRef<void(const RecordType&)> Callback) {
+		int32 Index = Algo::LowerBoundBy(Records, StartTime, [](const RecordType& Record) { return Record.Time; });
+		for (; Index < Records.Num() && Records[Index].Time <= EndTime; ++Index) {
+			Callback(Records[Index]);
+		}
+	}
+}
+
+
+FWeaponShotProvider::FWeaponShotProvider(TraceServices::IAnalysisSession& InSession) : Session(InSession) {}
+
+
+void FWeaponShotProvider::AppendShot(uint64 WeaponId, const FWeaponShotRecord& Shot) {
+	Session.WriteAccessCheck();
+	Timelines.FindOrAdd(WeaponId).Shots.Add(Shot);
+}
+
+
+void FWeaponShotProvider::AppendPellet(uint64 WeaponId, const FWeaponPelletRecord& Pellet) {
+	Session.WriteAccessCheck();
+	Timelines.FindOrAdd(WeaponId).Pellets.Add(Pellet);
+}
+
+
+bool FWeaponShotProvider::HasData(uint64 WeaponId) const {
+	Session.ReadAccessCheck();
+	return Timelines.Contains(WeaponId);
+}
+
+
+void FWeaponShotProvider::EnumerateWeapons(TFunctionRef<void(uint64 WeaponId)> Callback) const {
+	Session.ReadAccessCheck();
+	for (const TPair<uint64, FWeaponTimeline>& Timeline : Timelines) {
+		Callback(Timeline.Key);
+	}
+}
+
+
+void FWeaponShotProvider::EnumerateShots(uint64 WeaponId, double StartTime, double EndTime, TFunctionRef<void(const FWeaponShotRecord&)> Callback) const {
+	Session.ReadAccessCheck();
+	if (const FWeaponTimeline* Timeline = Timelines.Find(WeaponId)) {
+		WeaponShotProvider::EnumerateRange(Timeline->Shots, StartTime, EndTime, Callback);
+	}
+}
+
+
+void FWeaponShotProvider::EnumeratePellets(uint64 WeaponId, double StartTime, double EndTime, TFunctionRef<void(const FWeaponPelletRecord&)> Callback) const {
+	Session.ReadAccessCheck();
+	if (const FWeaponTimeline* Timeline = Timelines.Find(WeaponId)) {
+		WeaponShotProvider::EnumerateRange(Timeline->Pellets, StartTime, EndTime, Callback);
+	}
+}
+
+
+const FWeaponShotRecord* FWeaponShotProvider::FindShotAtTime(uint64 WeaponId, double Time) const {
+	Session.ReadAccessCheck();
+	const FWeaponTimeline* Timeline = Timelines.Find(WeaponId);
+	if (!Timeline) {
+		return nullptr;
+	}
+
+	const int32 NextIndex = Algo::UpperBoundBy(Timeline->Shots, Time, [](const FWeaponShotRecord& Shot) { return Shot.Time; });
+	return NextIndex > 0 ? &Timeline->Shots[NextIndex - 1] : nullptr;
+}
@@ -0,0 +1,87 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TraceServices/Model/AnalysisSession.h"
+
+/**
+ * One recorded trigger pull.
+ */
+struct FWeaponShotRecord {
+	/** Trace time (seconds) */
+	double Time = 0.0;
+
+	/** World time when recorded (seconds) */
+	double RecordingTime = 0.0;
+
+	uint64 InstigatorId = 0;
+	FVector MuzzleLocation = FVector::ZeroVector;
+	FRotator MuzzleRotation = FRotator::ZeroRotator;
+	FVector AimStart = FVector::ZeroVector;
+	FVector AimEnd = FVector::ZeroVector;
+	float FireInterval = 0.0f;
+	int32 NumPellets = 0;
+	uint8 FiringMode = 0;
+	uint8 BurstShotCount = 0;
+	bool bBurstCooldown = false;
+};
+
+/**
+ * One recorded pellet ray or projectile impact.
+ */
+struct FWeaponPelletRecord {
+	/** Trace time (seconds) */
+	double Time = 0.0;
+
+	/** World time when recorded (seconds) */
+	double RecordingTime = 0.0;
+
+	uint64 HitActorId = 0;
+	FVector Start = FVector::ZeroVector;
+	FVector End = FVector::ZeroVector;
+	FVector HitLocation = FVector::ZeroVector;
+	bool bHit = false;
+};
+
+/**
+ * Analysis side storage of WeaponShot trace events, per weapon object.
+ *
+ * @note Records arrive in time order, so every range query is a binary search
+ * @warning Read under an FAnalysisSessionReadScope
+ */
+class FWeaponShotProvider : public TraceServices::IProvider {
+public:
+	static const FName ProviderName;
+
+	explicit FWeaponShotProvider(TraceServices::IAnalysisSession& InSession);
+
+	void AppendShot(uint64 WeaponId, const FWeaponShotRecord& Shot);
+
+	void AppendPellet(uint64 WeaponId, const FWeaponPelletRecord& Pellet);
+
+	/** Whether any shot or pellet was recorded for a weapon */
+	bool HasData(uint64 WeaponId) const;
+
+	/** Calls Callback for every weapon with recorded data */
+	void EnumerateWeapons(TFunctionRef<void(uint64 WeaponId)> Callback) const;
+
+	/** Calls Callback for a weapon's shots with Time in [StartTime, EndTime] */
+	void EnumerateShots(uint64 WeaponId, double StartTime, double EndTime, TFunctionRef<void(const FWeaponShotRecord&)> Callback) const;
+
+	/** Calls Callback for a weapon's pellets with Time in [StartTime, EndTime] */
+	void EnumeratePellets(uint64 WeaponId, double StartTime, double EndTime, TFunctionRef<void(const FWeaponPelletRecord&)> Callback) const;
+
+	/** Returns the last shot at or before Time, or nullptr */
+	const FWeaponShotRecord* FindShotAtTime(uint64 WeaponId, double Time) const;
+
+private:
+	struct FWeaponTimeline {
+		TArray<FWeaponShotRecord> Shots;
+		TArray<FWeaponPelletRecord> Pellets;
+	};
+
+	TraceServices::IAnalysisSession& Session;
+
+	TMap<uint64, FWeaponTimeline> Timelines;
+};
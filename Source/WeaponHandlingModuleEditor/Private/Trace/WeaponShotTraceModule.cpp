@@ -0,0 +1,29 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Trace/WeaponShotTraceModule.h"
+
+#include "Trace/WeaponShotAnalyzer.h"
+#include "Trace/WeaponShotProvider.h"
+#include "TraceServices/Model/AnalysisSession.h"
+
+namespace WeaponShotTraceModule {
+	const FName ModuleName(TEXT("WeaponShot"));
+}
+
+
+void FWeaponShotTraceModule::GetModuleInfo(TraceServices::FModuleInfo& OutModuleInfo) {
+	OutModuleInfo.Name = WeaponShotTraceModule::ModuleName;
+	OutModuleInfo.DisplayName = TEXT("Weapon Shots");
+}
+
+
+void FWeaponShotTraceModule::OnAnalysisBegin(TraceServices::IAnalysisSession& Session) {
+	TSharedPtr<FWeaponShotProvider> Provider = MakeShared<FWeaponShotProvider>(Session);
+	Session.AddProvider(FWeaponShotProvider::ProviderName, Provider);
+	Session.AddAnalyzer(new FWeaponShotAnalyzer(Session, *Provider));
+}
+
+
+void FWeaponShotTraceModule::GetLoggers(TArray<const TCHAR*>& OutLoggers) {
+	OutLoggers.Add(TEXT("WeaponShot"));
+}
@@ -0,0 +1,20 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TraceServices/ModuleService.h"
+
+/**
+ * Registers the WeaponShot analyzer and provider with every analysis session.
+ */
+class FWeaponShotTraceModule : public TraceServices::IModule {
+public:
+	virtual void GetModuleInfo(TraceServices::FModuleInfo& OutModuleInfo) override;
+
+	virtual void OnAnalysisBegin(TraceServices::IAnalysisSession& Session) override;
+
+	virtual void GetLoggers(TArray<const TCHAR*>& OutLoggers) override;
+
+	virtual void GenerateReports(const TraceServices::IAnalysisSession& Session, const TCHAR* CmdLine, const TCHAR* OutputDirectory) override {}
+};
@@ -0,0 +1,34 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "WeaponHandlingModuleEditor.h"
+
+#include "Features/IModularFeatures.h"
+#include "IRewindDebuggerExtension.h"
+#include "IRewindDebuggerTrackCreator.h"
+#include "RewindDebugger/WeaponShotRewindDebuggerExtension.h"
+#include "RewindDebugger/WeaponShotTrack.h"
+#include "Trace/WeaponShotTraceModule.h"
+
+#define LOCTEXT_NAMESPACE "FWeaponHandlingModuleEditor"
+
+void FWeaponHandlingModuleEditor::StartupModule() {
+	WeaponShotTraceModule = MakeUnique<FWeaponShotTraceModule>();
+	WeaponShotTrackCreator = MakeUnique<FWeaponShotTrackCreator>();
+	WeaponShotRewindDebuggerExtension = MakeUnique<FWeaponShotRewindDebuggerExtension>();
+
+	IModularFeatures& ModularFeatures = IModularFeatures::Get();
+	ModularFeatures.RegisterModularFeature(TraceServices::ModuleFeatureName, WeaponShotTraceModule.Get());
+	ModularFeatures.RegisterModularFeature(RewindDebugger::IRewindDebuggerTrackCreator::ModularFeatureName, WeaponShotTrackCreator.Get());
+	ModularFeatures.RegisterModularFeature(IRewindDebuggerExtension::ModularFeatureName, WeaponShotRewindDebuggerExtension.Get());
+}
+
+void FWeaponHandlingModuleEditor::ShutdownModule() {
+	IModularFeatures& ModularFeatures = IModularFeatures::Get();
+	ModularFeatures.UnregisterModularFeature(TraceServices::ModuleFeatureName, WeaponShotTraceModule.Get());
+	ModularFeatures.UnregisterModularFeature(RewindDebugger::IRewindDebuggerTrackCreator::ModularFeatureName, WeaponShotTrackCreator.Get());
+	ModularFeatures.UnregisterModularFeature(IRewindDebuggerExtension::ModularFeatureName, WeaponShotRewindDebuggerExtension.Get());
+}
+
+#undef LOCTEXT_NAMESPACE
+
+IMPLEMENT_MODULE(FWeaponHandlingModuleEditor, WeaponHandlingModuleEditor);
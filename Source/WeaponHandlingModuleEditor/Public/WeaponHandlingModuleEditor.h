@@ -0,0 +1,28 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Modules/ModuleManager.h"
+
+class FWeaponShotTraceModule;
+class FWeaponShotTrackCreator;
+class FWeaponShotRewindDebuggerExtension;
+
+class FWeaponHandlingModuleEditor : public IModuleInterface
+{
+public:
+	/** IModuleInterface implementation */
+	virtual void StartupModule() override;
+	virtual void ShutdownModule() override;
+
+private:
+	/** Feeds WeaponShot trace events into analysis sessions */
+	TUniquePtr<FWeaponShotTraceModule> WeaponShotTraceModule;
+
+	/** Rewind Debugger track for ranged weapons */
+	TUniquePtr<FWeaponShotTrackCreator> WeaponShotTrackCreator;
+
+	/** Draws recorded shots in the viewport while scrubbing */
+	TUniquePtr<FWeaponShotRewindDebuggerExtension> WeaponShotRewindDebuggerExtension;
+};
@@ -0,0 +1,29 @@
+﻿// Fill out your copyright notice in the Description page of Project Settings.
+
+using UnrealBuildTool;
+
+public class WeaponHandlingModuleEditor : ModuleRules
+{
+	public WeaponHandlingModuleEditor(ReadOnlyTargetRules Target) : base(Target)
+	{
+		PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;
+
+		PublicDependencyModuleNames.AddRange(new[]
+		{
+			"Core",
+			"CoreUObject",
+			"Engine"
+		});
+
+		PrivateDependencyModuleNames.AddRange(
+			new[]
+			{
+				"Slate",
+				"SlateCore",
+				"TraceAnalysis",
+				"TraceServices",
+				"RewindDebuggerInterface",
+				"WeaponHandlingModule"
+			});
+	}
+}